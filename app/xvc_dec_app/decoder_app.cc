@@ -88,6 +88,12 @@ void DecoderApp::ReadArguments(int argc, const char *argv[]) {
       std::stringstream(argv[++i]) >> cli_.simd_mask;
     } else if (arg == "-threads") {
       std::stringstream(argv[++i]) >> cli_.threads;
+    } else if (arg == "-parallel-segments") {
+      std::stringstream(argv[++i]) >> cli_.parallel_segments;
+    } else if (arg == "-real-time") {
+      std::stringstream(argv[++i]) >> cli_.real_time;
+    } else if (arg == "-low-delay") {
+      std::stringstream(argv[++i]) >> cli_.low_delay;
     } else if (arg == "-loop") {
       std::stringstream(argv[++i]) >> cli_.loop;
     } else if (arg == "-verbose") {
@@ -166,6 +172,15 @@ void DecoderApp::CreateAndConfigureApi() {
   if (cli_.threads != -1) {
     params_->threads = cli_.threads;
   }
+  if (cli_.parallel_segments != -1) {
+    params_->parallel_segments = cli_.parallel_segments;
+  }
+  if (cli_.real_time != -1) {
+    params_->real_time = cli_.real_time;
+  }
+  if (cli_.low_delay != -1) {
+    params_->low_delay = cli_.low_delay;
+  }
   if (xvc_api_->parameters_check(params_) != XVC_DEC_OK) {
     std::cerr << "Error. Invalid parameters. Please check the values of the"
       " command line parameters." << std::endl;
@@ -328,6 +343,12 @@ void DecoderApp::PrintUsage() {
   GetLog() << "      3: 4:4:4" << std::endl;
   GetLog() << "  -output-bitdepth <int>" << std::endl;
   GetLog() << "  -max-framerate <int>" << std::endl;
+  GetLog() << "  -parallel-segments <int>" << std::endl;
+  GetLog() << "      Decode closed gop segments concurrently" << std::endl;
+  GetLog() << "  -real-time <0/1>" << std::endl;
+  GetLog() << "      Drop temporal layers if decoding falls behind" << std::endl;
+  GetLog() << "  -low-delay <0/1>" << std::endl;
+  GetLog() << "      Output pictures as soon as poc order allows" << std::endl;
   GetLog() << "  -loop <int>" << std::endl;
   GetLog() << "  -verbose <0/1>" << std::endl;
 }
@@ -73,6 +73,9 @@ private:
     int max_framerate = -1;
     int simd_mask = -1;
     int threads = -1;
+    int parallel_segments = -1;
+    int real_time = -1;
+    int low_delay = -1;
     int loop = -1;
     int verbose = 0;
   } cli_;
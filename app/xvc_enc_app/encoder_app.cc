@@ -121,6 +121,12 @@ void EncoderApp::ReadArguments(int argc, const char *argv[]) {
       std::stringstream(argv[++i]) >> cli_.simd_mask;
     } else if (arg == "-explicit-encoder-settings") {
       cli_.explicit_encoder_settings = argv[++i];
+    } else if (arg == "-parallel-segments") {
+      std::stringstream(argv[++i]) >> cli_.parallel_segments;
+    } else if (arg == "-low-delay") {
+      std::stringstream(argv[++i]) >> cli_.low_delay;
+    } else if (arg == "-intra-refresh") {
+      std::stringstream(argv[++i]) >> cli_.intra_refresh_period;
     } else if (arg == "-verbose") {
       std::stringstream(argv[++i]) >> cli_.verbose;
     } else {
@@ -294,6 +300,15 @@ void EncoderApp::CreateAndConfigureApi() {
   if (!cli_.explicit_encoder_settings.empty()) {
     params_->explicit_encoder_settings = &cli_.explicit_encoder_settings[0];
   }
+  if (cli_.parallel_segments != -1) {
+    params_->parallel_segments = cli_.parallel_segments;
+  }
+  if (cli_.low_delay != -1) {
+    params_->low_delay = cli_.low_delay;
+  }
+  if (cli_.intra_refresh_period != -1) {
+    params_->intra_refresh_period = cli_.intra_refresh_period;
+  }
   xvc_enc_return_code ret = xvc_api_->parameters_check(params_);
   if (ret != XVC_ENC_OK) {
     std::cout << xvc_api_->xvc_enc_get_error_text(ret) << std::endl;
@@ -501,6 +516,14 @@ void EncoderApp::PrintUsage() {
   std::cout << "  -tune <int>" << std::endl;
   std::cout << "      0: Visual quality (default)" << std::endl;
   std::cout << "      1: PSNR" << std::endl;
+  std::cout << "  -parallel-segments <int>" << std::endl;
+  std::cout << "      Encode closed gop segments concurrently" << std::endl;
+  std::cout << "  -low-delay <0/1>" << std::endl;
+  std::cout << "      Encode without picture reordering" << std::endl;
+  std::cout << "  -intra-refresh <int>" << std::endl;
+  std::cout << "      Refresh period, together with -max-keypic-distance 0"
+    << std::endl;
+  std::cout << "      it replaces periodic intra access pictures" << std::endl;
   std::cout << "  -verbose <0/1>" << std::endl;
 }
 
@@ -92,6 +92,9 @@ private:
     int tune_mode = -1;
     int simd_mask = -1;
     std::string explicit_encoder_settings;
+    int parallel_segments = -1;
+    int low_delay = -1;
+    int intra_refresh_period = -1;
     int verbose = 0;
   } cli_;
 
@@ -23,7 +23,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 const uint8_t Cabac::kRenormTable_[32] = {
   6, 5, 4, 4, 3, 3, 3, 3,
@@ -350,11 +350,10 @@ void CabacContexts::ResetStates(const Qp &qp, PicturePredictionType pic_type) {
 ContextModel& CabacContexts::GetSkipFlagCtx(const CodingUnit &cu) {
   int offset = 0;
   if (!Restrictions::Get().disable_cabac_skip_flag_ctx) {
-    const CodingUnit *tmp;
-    if ((tmp = cu.GetCodingUnitLeft()) != nullptr && tmp->GetSkipFlag()) {
+    if (cu.GetNeighborInfoLeft().skip_flag) {
       offset++;
     }
-    if ((tmp = cu.GetCodingUnitAbove()) != nullptr && tmp->GetSkipFlag()) {
+    if (cu.GetNeighborInfoAbove().skip_flag) {
       offset++;
     }
   }
@@ -362,17 +361,15 @@ ContextModel& CabacContexts::GetSkipFlagCtx(const CodingUnit &cu) {
 }
 
 ContextModel& CabacContexts::GetSplitBinaryCtx(const CodingUnit &cu) {
-  const CodingUnit *left = cu.GetCodingUnitLeft();
-  const CodingUnit *above = cu.GetCodingUnitAbove();
+  const CuNeighborInfo left = cu.GetNeighborInfoLeft();
+  const CuNeighborInfo above = cu.GetNeighborInfoAbove();
   int depth = (cu.GetDepth() << 1) + cu.GetBinaryDepth();
   int offset = 0;
-  if (left) {
-    offset +=
-      ((left->GetDepth() << 1) + left->GetBinaryDepth()) > depth ? 1 : 0;
+  if (left.IsAvailable()) {
+    offset += left.split_depth > depth ? 1 : 0;
   }
-  if (above) {
-    offset +=
-      ((above->GetDepth() << 1) + above->GetBinaryDepth()) > depth ? 1 : 0;
+  if (above.IsAvailable()) {
+    offset += above.split_depth > depth ? 1 : 0;
   }
   return cu_split_binary[offset];
 }
@@ -380,31 +377,31 @@ ContextModel& CabacContexts::GetSplitBinaryCtx(const CodingUnit &cu) {
 ContextModel& CabacContexts::GetSplitFlagCtx(const CodingUnit &cu,
                                              int pic_max_depth) {
   int offset = 0;
-  const CodingUnit *left = cu.GetCodingUnitLeft();
-  const CodingUnit *above = cu.GetCodingUnitAbove();
+  const CuNeighborInfo left = cu.GetNeighborInfoLeft();
+  const CuNeighborInfo above = cu.GetNeighborInfoAbove();
   if (!Restrictions::Get().disable_cabac_split_flag_ctx) {
-    if (left) {
-      offset += left->GetDepth() > cu.GetDepth();
+    if (left.IsAvailable()) {
+      offset += left.quad_depth > cu.GetDepth();
     }
-    if (above) {
-      offset += above->GetDepth() > cu.GetDepth();
+    if (above.IsAvailable()) {
+      offset += above.quad_depth > cu.GetDepth();
     }
   }
   if (!Restrictions::Get().disable_ext_cabac_alt_split_flag_ctx) {
     int min_depth = pic_max_depth;
     int max_depth = 0;
     auto update_min_max =
-      [&min_depth, &max_depth, pic_max_depth](const CodingUnit *tmp) {
-      if (tmp) {
-        min_depth = std::min(min_depth, tmp->GetDepth());
-        max_depth = std::max(max_depth, tmp->GetDepth());
+      [&min_depth, &max_depth, pic_max_depth](const CuNeighborInfo &info) {
+      if (info.IsAvailable()) {
+        min_depth = std::min(min_depth, static_cast<int>(info.quad_depth));
+        max_depth = std::max(max_depth, static_cast<int>(info.quad_depth));
       } else {
         min_depth = 0;
         max_depth = pic_max_depth;
       }
     };
-    update_min_max(cu.GetCodingUnitLeft());
-    update_min_max(cu.GetCodingUnitAbove());
+    update_min_max(left);
+    update_min_max(above);
     min_depth = std::max(0, min_depth - 1);
     max_depth = std::min(pic_max_depth, max_depth + 1);
     if (cu.GetDepth() < min_depth) {
@@ -489,6 +486,57 @@ CabacContexts::GetCoeffSigCtx(YuvComponent comp, int pattern_sig_ctx,
   return ctx_base[start_offset + comp_offset + cnt];
 }
 
+void CabacContexts::GetCoeffSigCtxSubblock(YuvComponent comp,
+                                           int pattern_sig_ctx,
+                                           ScanOrder scan_order,
+                                           int subblock_pos_x,
+                                           int subblock_pos_y,
+                                           int width_log2, int height_log2,
+                                           const uint8_t *scan_table,
+                                           ContextModel **ctx_table) {
+  static const uint8_t kCtxIndexMap[16] = {
+    0, 1, 4, 5, 2, 3, 4, 5, 6, 6, 8, 8, 7, 7, 8, 8
+  };
+  // Context increment indexed by pattern_sig_ctx and position in subblock
+  static const uint8_t kCtxCnt[4][16] = {
+    { 2, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 2, 2, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0, 2, 1, 0, 0 },
+    { 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+  };
+  static_assert(constants::kSubblockShift == 2, "Assumes 4x4 subblocks");
+  const int subblock_size = 16;
+  ContextModel *ctx_base =
+    util::IsLuma(comp) ? &coeff_sig_luma[0] : &coeff_sig_chroma[0];
+  if (Restrictions::Get().disable_cabac_coeff_sig_ctx) {
+    for (int i = 0; i < subblock_size; i++) {
+      ctx_table[i] = &ctx_base[0];
+    }
+    return;
+  }
+  if (width_log2 == 2 && height_log2 == 2) {
+    for (int i = 0; i < subblock_size; i++) {
+      ctx_table[i] = &ctx_base[kCtxIndexMap[scan_table[i]]];
+    }
+    return;
+  }
+  int start_offset = util::IsLuma(comp) ? 21 : 12;
+  if (width_log2 == 3 && height_log2 == 3) {
+    start_offset = scan_order == ScanOrder::kDiagonal ? 9 : 15;
+  }
+  const bool first_subblock = subblock_pos_x == 0 && subblock_pos_y == 0;
+  int comp_offset = util::IsLuma(comp) && !first_subblock ? 3 : 0;
+  ContextModel *ctx_subblock = ctx_base + start_offset + comp_offset;
+  const uint8_t *ctx_cnt = kCtxCnt[pattern_sig_ctx];
+  for (int i = 0; i < subblock_size; i++) {
+    ctx_table[i] = ctx_subblock + ctx_cnt[scan_table[i]];
+  }
+  if (first_subblock) {
+    // Dc coefficient has its own context
+    ctx_table[0] = &ctx_base[0];
+  }
+}
+
 ContextModel& CabacContexts::GetCoeffGreaterThan1Ctx(YuvComponent comp,
                                                      int ctx_set, int c1) {
   ContextModel *ctx_base =
@@ -550,4 +598,4 @@ CabacContexts::GetCoeffLastPosCtx(YuvComponent comp, int width, int height,
   }
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -27,7 +27,7 @@
 #include "xvc_common_lib/transform.h"
 #include "xvc_common_lib/quantize.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class Cabac {
 public:
@@ -99,6 +99,13 @@ public:
   ContextModel& GetCoeffSigCtx(YuvComponent comp, int pattern_sig_ctx,
                                ScanOrder scan_order, int posx, int posy,
                                int width_log2, int height_log2);
+  // Same as GetCoeffSigCtx for all coefficients of a 4x4 subblock,
+  // output is indexed by coefficient scan index within the subblock
+  void GetCoeffSigCtxSubblock(YuvComponent comp, int pattern_sig_ctx,
+                              ScanOrder scan_order, int subblock_pos_x,
+                              int subblock_pos_y, int width_log2,
+                              int height_log2, const uint8_t *scan_table,
+                              ContextModel **ctx_table);
   ContextModel& GetCoeffGreaterThan1Ctx(YuvComponent comp, int ctx_set,
                                         int c1);
   ContextModel& GetCoeffGreaterThan2Ctx(YuvComponent comp, int ctx_set);
@@ -135,6 +142,6 @@ public:
   std::array<ContextModel, kNumCoeffLastPosCtxChroma> coeff_last_pos_y_chroma;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_CABAC_H_
@@ -22,7 +22,7 @@
 
 #include "xvc_common_lib/utils_md5.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 void Checksum::HashPicture(const YuvPicture &pic, Method method, Mode mode) {
   switch (method) {
@@ -135,4 +135,4 @@ void Checksum::CalculateMd5(const YuvPicture &pic, Mode mode) {
   }
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
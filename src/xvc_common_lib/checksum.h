@@ -25,7 +25,7 @@
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_common_lib/restrictions.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class Checksum {
 public:
@@ -58,6 +58,6 @@ private:
   std::vector<uint8_t> hash_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_CHECKSUM_H_
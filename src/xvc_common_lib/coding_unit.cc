@@ -27,28 +27,32 @@
 #include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 CodingUnit::CodingUnit(PictureData *pic_data, CoeffCtuBuffer *ctu_coeff,
                        CuTree cu_tree, int depth, int pic_x, int pic_y,
                        int width, int height)
   : pic_data_(pic_data),
-  ctu_coeff_(ctu_coeff),
-  cu_tree_(cu_tree),
   pos_x_(pic_x),
   pos_y_(pic_y),
-  width_(width),
-  height_(height),
-  depth_(depth),
+  width_(static_cast<int16_t>(width)),
+  height_(static_cast<int16_t>(height)),
+  depth_(static_cast<int8_t>(depth)),
+  cu_tree_(cu_tree),
   split_state_(SplitType::kNone),
   pred_mode_(PredictionMode::kIntra),
   cbf_({ { false, false, false } }),
-  sub_cu_list_({ { nullptr, nullptr, nullptr, nullptr } }),
-  qp_(pic_data->GetPicQp()),
   root_cbf_(false),
-  intra_mode_luma_(IntraMode::kInvalid),
-  intra_mode_chroma_(IntraChromaMode::kInvalid),
-  inter_() {
+  intra_mode_luma_(static_cast<uint8_t>(IntraMode::kInvalid)),
+  intra_mode_chroma_(static_cast<uint8_t>(IntraChromaMode::kInvalid)),
+  inter_(),
+  coeff_extent_width_({ { constants::kMaxBlockSize, constants::kMaxBlockSize,
+                        constants::kMaxBlockSize } }),
+  coeff_extent_height_({ { constants::kMaxBlockSize, constants::kMaxBlockSize,
+                         constants::kMaxBlockSize } }),
+  sub_cu_list_({ { nullptr, nullptr, nullptr, nullptr } }),
+  ctu_coeff_(ctu_coeff),
+  qp_(pic_data->GetPicQp()) {
 }
 
 CodingUnit& CodingUnit::operator=(const CodingUnit &cu) {
@@ -62,11 +66,14 @@ CodingUnit& CodingUnit::operator=(const CodingUnit &cu) {
          cu.split_state_ == SplitType::kNone);
   pred_mode_ = cu.pred_mode_;
   cbf_ = cu.cbf_;
+  coeff_extent_width_ = cu.coeff_extent_width_;
+  coeff_extent_height_ = cu.coeff_extent_height_;
   qp_ = cu.qp_;
   root_cbf_ = cu.root_cbf_;
   intra_mode_luma_ = cu.intra_mode_luma_;
   intra_mode_chroma_ = cu.intra_mode_chroma_;
   inter_ = cu.inter_;
+  UpdateNeighborInfo();
   return *this;
 }
 
@@ -83,11 +90,14 @@ void CodingUnit::CopyPositionAndSizeFrom(const CodingUnit &cu) {
 void CodingUnit::CopyPredictionDataFrom(const CodingUnit &cu) {
   pred_mode_ = cu.pred_mode_;
   cbf_ = cu.cbf_;
+  coeff_extent_width_ = cu.coeff_extent_width_;
+  coeff_extent_height_ = cu.coeff_extent_height_;
   qp_ = cu.qp_;
   root_cbf_ = cu.root_cbf_;
   intra_mode_luma_ = cu.intra_mode_luma_;
   intra_mode_chroma_ = cu.intra_mode_chroma_;
   inter_ = cu.inter_;
+  UpdateNeighborInfo();
 }
 
 int CodingUnit::GetBinaryDepth() const {
@@ -153,81 +163,102 @@ bool CodingUnit::IsFullyWithinPicture() const {
     pos_y_ + height_ <= pic_data_->GetPictureHeight(YuvComponent::kY);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitAbove() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoAbove() const {
   int posx = pos_x_;
   int posy = pos_y_;
   if (posy == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
-  return pic_data_->GetCuAt(cu_tree_, posx, posy - constants::kMinBlockSize);
+  return pic_data_->GetNeighborInfoAt(cu_tree_, posx,
+                                      posy - constants::kMinBlockSize);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitAboveIfSameCtu() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoAboveIfSameCtu() const {
   int posx = pos_x_;
   int posy = pos_y_;
   if ((posy % constants::kCtuSize) == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
-  return pic_data_->GetCuAt(cu_tree_, posx, posy - constants::kMinBlockSize);
+  return pic_data_->GetNeighborInfoAt(cu_tree_, posx,
+                                      posy - constants::kMinBlockSize);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitAboveLeft() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoAboveLeft() const {
   int posx = pos_x_;
   int posy = pos_y_;
   if (posx == 0 || posy == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize,
-                            posy - constants::kMinBlockSize);
+  return pic_data_->GetNeighborInfoAt(cu_tree_,
+                                      posx - constants::kMinBlockSize,
+                                      posy - constants::kMinBlockSize);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitAboveCorner() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoAboveCorner() const {
   int right = pos_x_ + width_;
   int posy = pos_y_;
   if (posy == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
-  return pic_data_->GetCuAt(cu_tree_, right - constants::kMinBlockSize,
-                            posy - constants::kMinBlockSize);
+  return pic_data_->GetNeighborInfoAt(cu_tree_,
+                                      right - constants::kMinBlockSize,
+                                      posy - constants::kMinBlockSize);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitAboveRight() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoAboveRight() const {
   int right = pos_x_ + width_;
   int posy = pos_y_;
   if (posy == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
   // Padding in table will guard for y going out-of-bounds
-  return pic_data_->GetCuAt(cu_tree_, right, posy - constants::kMinBlockSize);
+  return pic_data_->GetNeighborInfoAt(cu_tree_, right,
+                                      posy - constants::kMinBlockSize);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitLeft() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoLeft() const {
   int posx = pos_x_;
   int posy = pos_y_;
   if (posx == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize, posy);
+  return pic_data_->GetNeighborInfoAt(cu_tree_,
+                                      posx - constants::kMinBlockSize, posy);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitLeftCorner() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoLeftCorner() const {
   int posx = pos_x_;
   int bottom = pos_y_ + height_;
   if (posx == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize,
-                            bottom - constants::kMinBlockSize);
+  return pic_data_->GetNeighborInfoAt(cu_tree_,
+                                      posx - constants::kMinBlockSize,
+                                      bottom - constants::kMinBlockSize);
 }
 
-const CodingUnit* CodingUnit::GetCodingUnitLeftBelow() const {
+CuNeighborInfo CodingUnit::GetNeighborInfoLeftBelow() const {
   int posx = pos_x_;
   int bottom = pos_y_ + height_;
   if (posx == 0) {
-    return nullptr;
+    return CuNeighborInfo();
   }
   // Padding in table will guard for y going out-of-bounds
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize, bottom);
+  return pic_data_->GetNeighborInfoAt(cu_tree_,
+                                      posx - constants::kMinBlockSize, bottom);
+}
+
+CuNeighborInfo CodingUnit::GetNeighborInfo() const {
+  CuNeighborInfo info;
+  info.quad_depth = static_cast<uint8_t>(depth_);
+  info.split_depth = static_cast<uint8_t>((depth_ << 1) + GetBinaryDepth());
+  info.pred_mode = pred_mode_;
+  info.skip_flag = inter_.skip_flag;
+  info.intra_mode_luma = intra_mode_luma_;
+  info.inter_dir = inter_.inter_dir;
+  info.ref_idx = inter_.ref_idx;
+  info.mv = inter_.mv;
+  return info;
 }
 
 int CodingUnit::GetCuSizeAboveRight(YuvComponent comp) const {
@@ -267,16 +298,16 @@ int CodingUnit::GetCuSizeBelowLeft(YuvComponent comp) const {
 IntraMode CodingUnit::GetIntraMode(YuvComponent comp) const {
   if (util::IsLuma(comp)) {
     assert(cu_tree_ == CuTree::Primary);
-    return intra_mode_luma_;
+    return static_cast<IntraMode>(intra_mode_luma_);
   }
-  if (intra_mode_chroma_ == IntraChromaMode::kDmChroma) {
+  if (GetIntraChromaMode() == IntraChromaMode::kDmChroma) {
     if (cu_tree_ == CuTree::Primary) {
-      return intra_mode_luma_;
+      return static_cast<IntraMode>(intra_mode_luma_);
     }
     const CodingUnit *luma_cu = pic_data_->GetLumaCu(this);
-    return luma_cu->intra_mode_luma_;
+    return static_cast<IntraMode>(luma_cu->intra_mode_luma_);
   }
-  assert(static_cast<int>(intra_mode_chroma_) < IntraMode::kTotalNumber);
+  assert(intra_mode_chroma_ < IntraMode::kTotalNumber);
   return static_cast<IntraMode>(intra_mode_chroma_);
 }
 
@@ -400,6 +431,7 @@ void CodingUnit::LoadStateFrom(const TransformState &src_state,
 
 void CodingUnit::LoadStateFrom(const InterState &state) {
   inter_ = state;
+  UpdateNeighborInfo();
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -30,7 +30,7 @@
 #include "xvc_common_lib/reference_picture_lists.h"
 #include "xvc_common_lib/yuv_pic.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class Qp;
 
@@ -50,11 +50,11 @@ public:
     InterDir inter_dir = InterDir::kL0;
     bool skip_flag = false;
     bool merge_flag = false;
-    int merge_idx = -1;
-    std::array<MotionVector, 2> mv;
-    std::array<MotionVector, 2> mvd;
+    int8_t merge_idx = -1;
     std::array<int8_t, 2> ref_idx;
     std::array<int8_t, 2> mvp_idx;
+    std::array<MotionVector, 2> mv;
+    std::array<MotionVector, 2> mvd;
   };
   CodingUnit() {}
   CodingUnit(PictureData *pic_data, CoeffCtuBuffer *ctu_coeff,
@@ -127,14 +127,16 @@ public:
 
   // Neighborhood
   bool IsFullyWithinPicture() const;
-  const CodingUnit *GetCodingUnitAbove() const;
-  const CodingUnit *GetCodingUnitAboveIfSameCtu() const;
-  const CodingUnit *GetCodingUnitAboveLeft() const;
-  const CodingUnit *GetCodingUnitAboveCorner() const;
-  const CodingUnit *GetCodingUnitAboveRight() const;
-  const CodingUnit *GetCodingUnitLeft() const;
-  const CodingUnit *GetCodingUnitLeftCorner() const;
-  const CodingUnit *GetCodingUnitLeftBelow() const;
+  CuNeighborInfo GetNeighborInfoAbove() const;
+  CuNeighborInfo GetNeighborInfoAboveIfSameCtu() const;
+  CuNeighborInfo GetNeighborInfoAboveLeft() const;
+  CuNeighborInfo GetNeighborInfoAboveCorner() const;
+  CuNeighborInfo GetNeighborInfoAboveRight() const;
+  CuNeighborInfo GetNeighborInfoLeft() const;
+  CuNeighborInfo GetNeighborInfoLeftCorner() const;
+  CuNeighborInfo GetNeighborInfoLeftBelow() const;
+  // Data of this coding unit as seen by its neighbors
+  CuNeighborInfo GetNeighborInfo() const;
   int GetCuSizeAboveRight(YuvComponent comp) const;
   int GetCuSizeBelowLeft(YuvComponent comp) const;
 
@@ -149,6 +151,17 @@ public:
   DataBuffer<const Coeff> GetCoeff(YuvComponent comp) const {
     return ctu_coeff_->GetBuffer(comp, GetPosX(comp), GetPosY(comp));
   }
+  // Size of the top-left region holding all non-zero coefficients
+  int GetCoeffExtentWidth(YuvComponent comp) const {
+    return coeff_extent_width_[comp];
+  }
+  int GetCoeffExtentHeight(YuvComponent comp) const {
+    return coeff_extent_height_[comp];
+  }
+  void SetCoeffExtent(YuvComponent comp, int width, int height) {
+    coeff_extent_width_[comp] = static_cast<uint8_t>(width);
+    coeff_extent_height_[comp] = static_cast<uint8_t>(height);
+  }
   bool GetHasAnyCbf() const {
     return cbf_[YuvComponent::kY] || cbf_[YuvComponent::kU] ||
       cbf_[YuvComponent::kV];
@@ -156,27 +169,43 @@ public:
 
   // Prediction
   PredictionMode GetPredMode() const { return pred_mode_; }
-  void SetPredMode(PredictionMode pred_mode) { pred_mode_ = pred_mode; }
+  void SetPredMode(PredictionMode pred_mode) {
+    pred_mode_ = pred_mode;
+    UpdateNeighborInfo();
+  }
   bool IsIntra() const { return GetPredMode() == PredictionMode::kIntra; }
   bool IsInter() const { return GetPredMode() == PredictionMode::kInter; }
 
   // Intra
   IntraMode GetIntraMode(YuvComponent comp) const;
-  IntraChromaMode GetIntraChromaMode() const { return intra_mode_chroma_; }
-  void SetIntraModeLuma(IntraMode intra_mode) { intra_mode_luma_ = intra_mode; }
+  IntraChromaMode GetIntraChromaMode() const {
+    return static_cast<IntraChromaMode>(intra_mode_chroma_);
+  }
+  void SetIntraModeLuma(IntraMode intra_mode) {
+    intra_mode_luma_ = static_cast<uint8_t>(intra_mode);
+    UpdateNeighborInfo();
+  }
   void SetIntraModeChroma(IntraChromaMode intra_mode) {
-    intra_mode_chroma_ = intra_mode;
+    intra_mode_chroma_ = static_cast<uint8_t>(intra_mode);
   }
 
   // Inter
   InterDir GetInterDir() const { return inter_.inter_dir; }
-  void SetInterDir(InterDir inter_dir) { inter_.inter_dir = inter_dir; }
+  void SetInterDir(InterDir inter_dir) {
+    inter_.inter_dir = inter_dir;
+    UpdateNeighborInfo();
+  }
   bool GetSkipFlag() const { return inter_.skip_flag; }
-  void SetSkipFlag(bool skip) { inter_.skip_flag = skip; }
+  void SetSkipFlag(bool skip) {
+    inter_.skip_flag = skip;
+    UpdateNeighborInfo();
+  }
   bool GetMergeFlag() const { return inter_.merge_flag; }
   void SetMergeFlag(bool merge) { inter_.merge_flag = merge; }
   int GetMergeIdx() const { return inter_.merge_idx; }
-  void SetMergeIdx(int merge_idx) { inter_.merge_idx = merge_idx; }
+  void SetMergeIdx(int merge_idx) {
+    inter_.merge_idx = static_cast<int8_t>(merge_idx);
+  }
   bool HasMv(RefPicList ref_list) const {
     return GetInterDir() == InterDir::kBi ||
       (ref_list == RefPicList::kL0 && GetInterDir() == InterDir::kL0) ||
@@ -187,12 +216,14 @@ public:
   }
   void SetRefIdx(int ref_idx, RefPicList list) {
     inter_.ref_idx[static_cast<int>(list)] = static_cast<uint8_t>(ref_idx);
+    UpdateNeighborInfo();
   }
   const MotionVector& GetMv(RefPicList list) const {
     return inter_.mv[static_cast<int>(list)];
   }
   void SetMv(const MotionVector &mv, RefPicList list) {
     inter_.mv[static_cast<int>(list)] = mv;
+    UpdateNeighborInfo();
   }
   const MotionVector& GetMvDelta(RefPicList list) const {
     return inter_.mvd[static_cast<int>(list)];
@@ -218,27 +249,39 @@ public:
   void LoadStateFrom(const InterState &state);
 
 private:
+  // Keeps the neighbor info grid in sync when a coding unit that is already
+  // marked in picture changes its prediction data
+  void UpdateNeighborInfo() {
+    if (pic_data_->GetCuAt(cu_tree_, pos_x_, pos_y_) == this) {
+      pic_data_->UpdateNeighborInfo(*this);
+    }
+  }
+
+  // Data used by neighbor lookups and prediction (geometry, modes and motion)
+  // is kept together at the start of the object, in total two cache lines
   PictureData *pic_data_ = nullptr;
-  CoeffCtuBuffer *ctu_coeff_ = nullptr;   // Coefficient storage for this CU
-  CuTree cu_tree_;
   int pos_x_;
   int pos_y_;
-  int width_;
-  int height_;
-  int depth_;
+  int16_t width_;
+  int16_t height_;
+  int8_t depth_;
+  CuTree cu_tree_;
   SplitType split_state_;
   PredictionMode pred_mode_;
   std::array<bool, constants::kMaxYuvComponents> cbf_;
-  std::array<CodingUnit*, constants::kQuadSplit> sub_cu_list_;
-  const Qp *qp_;
   bool root_cbf_;
-  // Intra
-  IntraMode intra_mode_luma_;
-  IntraChromaMode intra_mode_chroma_;
+  // Intra, stored as IntraMode and IntraChromaMode
+  uint8_t intra_mode_luma_;
+  uint8_t intra_mode_chroma_;
   // Inter
   InterState inter_;
+  std::array<uint8_t, constants::kMaxYuvComponents> coeff_extent_width_;
+  std::array<uint8_t, constants::kMaxYuvComponents> coeff_extent_height_;
+  std::array<CodingUnit*, constants::kQuadSplit> sub_cu_list_;
+  CoeffCtuBuffer *ctu_coeff_ = nullptr;   // Coefficient storage for this CU
+  const Qp *qp_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_CODING_UNIT_H_
@@ -18,6 +18,6 @@
 
 #include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
-}  // namespace xvc
+}  // namespace XVC_NAMESPACE
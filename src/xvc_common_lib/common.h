@@ -26,7 +26,19 @@
 #define XVC_HIGH_BITDEPTH 1
 #endif
 
-namespace xvc {
+// The 8bit decoder variant of a high bitdepth build uses 8bit samples
+#if XVC_8BIT_VARIANT
+#undef XVC_HIGH_BITDEPTH
+#define XVC_HIGH_BITDEPTH 0
+#endif
+
+// Code built more than once in the same library is placed in a separate
+// namespace for each build
+#ifndef XVC_NAMESPACE
+#define XVC_NAMESPACE xvc
+#endif
+
+namespace XVC_NAMESPACE {
 
 #if !XVC_HIGH_BITDEPTH
 typedef uint8_t Sample;
@@ -63,7 +75,7 @@ enum YuvComponent {
   kV = 2,
 };
 
-enum class CuTree {
+enum class CuTree : uint8_t {
   Primary = 0,
   Secondary = 1,
 };
@@ -75,6 +87,9 @@ const uint32_t kXvcCodecIdentifier = 7894627;
 const uint32_t kXvcMajorVersion = 1;
 const uint32_t kXvcMinorVersion = 0;
 
+// Memory
+const int kCacheLineSize = 64;
+
 // Picture
 const int kMaxYuvComponents = 3;
 const int kMaxNumCuTrees = 2;
@@ -150,6 +165,6 @@ const int16_t kInt16Min = INT16_MIN;
 
 }   // namespace constants
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_COMMON_H_
@@ -22,7 +22,7 @@
 
 #include "xvc_common_lib/restrictions.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 void ContextModel::Init(int qp, int init_value) {
   int slope = (init_value >> 4) * 5 - 45;
@@ -87,4 +87,4 @@ const uint32_t ContextModel::kEntropyBits_[ContextModel::kNumTotalStates_] = {
 };
 
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
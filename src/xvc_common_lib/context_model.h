@@ -21,7 +21,7 @@
 
 #include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class ContextModel {
 public:
@@ -52,6 +52,6 @@ private:
   uint8_t state_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_CONTEXT_MODEL_H_
@@ -19,9 +19,14 @@
 #ifndef XVC_COMMON_LIB_CU_TYPES_H_
 #define XVC_COMMON_LIB_CU_TYPES_H_
 
-namespace xvc {
+#include <array>
+#include <cstdint>
 
-enum class SplitType {
+#include "xvc_common_lib/common.h"
+
+namespace XVC_NAMESPACE {
+
+enum class SplitType : uint8_t {
   kNone,
   kQuad,
   kHorizontal,
@@ -34,7 +39,7 @@ enum class SplitRestriction {
   kNoVertical,
 };
 
-enum class PredictionMode {
+enum class PredictionMode : uint8_t {
   kIntra = 0,
   kInter = 1,
 };
@@ -71,7 +76,7 @@ enum class IntraChromaMode : int {
   kInvalid = 99,
 };
 
-enum class InterDir {
+enum class InterDir : uint8_t {
   kL0 = 0,
   kL1 = 1,
   kBi = 2,
@@ -90,6 +95,28 @@ struct MotionVector {
   int y = 0;
 };
 
-}   // namespace xvc
+// Coding unit data of a minimum size block that neighboring coding units need
+// for context, most probable mode and motion vector predictor derivation,
+// kept in a compact picture grid to avoid dereferencing the coding unit
+struct CuNeighborInfo {
+  static const uint8_t kUnavailable = 0xff;
+  bool IsAvailable() const { return quad_depth != kUnavailable; }
+  bool IsIntra() const {
+    return IsAvailable() && pred_mode == PredictionMode::kIntra;
+  }
+  bool IsInter() const {
+    return IsAvailable() && pred_mode == PredictionMode::kInter;
+  }
+  uint8_t quad_depth = kUnavailable;
+  uint8_t split_depth = kUnavailable;   // 2 * quad_depth + binary_depth
+  PredictionMode pred_mode = PredictionMode::kIntra;
+  bool skip_flag = false;
+  uint8_t intra_mode_luma = static_cast<uint8_t>(IntraMode::kInvalid);
+  InterDir inter_dir = InterDir::kL0;
+  std::array<int8_t, 2> ref_idx = { { -1, -1 } };
+  std::array<MotionVector, 2> mv;
+};
+
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_CU_TYPES_H_
@@ -25,7 +25,7 @@
 #include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 static const std::array<uint8_t, 54> kTcTable = {
   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
@@ -419,4 +419,4 @@ void DeblockingFilter::FilterChroma(Sample* src, ptrdiff_t step_size,
   }
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
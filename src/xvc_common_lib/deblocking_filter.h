@@ -23,7 +23,7 @@
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_common_lib/yuv_pic.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 enum class Direction {
   kVertical,
@@ -72,6 +72,6 @@ private:
   int tc_offset_ = 0;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_DEBLOCKING_FILTER_H_
@@ -25,7 +25,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/simd_cpu.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 const std::array<std::array<int16_t, InterPrediction::kNumTapsLuma>, 4>
 InterPrediction::kLumaFilter = { {
@@ -58,15 +58,16 @@ InterPrediction::GetMvPredictors(const CodingUnit &cu, RefPicList ref_list,
                                  int ref_idx) {
   InterPredictorList list;
   if (Restrictions::Get().disable_inter_mvp) {
-    const CodingUnit *tmp = cu.GetCodingUnitLeft();
-    if (tmp && tmp->IsInter()) {
-      list[0] = tmp->GetMv(ref_list);
-      list[1] = tmp->GetMv(ref_list);
+    const int list_idx = static_cast<int>(ref_list);
+    CuNeighborInfo tmp = cu.GetNeighborInfoLeft();
+    if (tmp.IsInter()) {
+      list[0] = tmp.mv[list_idx];
+      list[1] = tmp.mv[list_idx];
     } else {
-      tmp = cu.GetCodingUnitAbove();
-      if (tmp && tmp->IsInter()) {
-        list[0] = tmp->GetMv(ref_list);
-        list[1] = tmp->GetMv(ref_list);
+      tmp = cu.GetNeighborInfoAbove();
+      if (tmp.IsInter()) {
+        list[0] = tmp.mv[list_idx];
+        list[1] = tmp.mv[list_idx];
       } else {
         list[0] = MotionVector(0, 0);
         list[1] = MotionVector(0, 0);
@@ -77,47 +78,44 @@ InterPrediction::GetMvPredictors(const CodingUnit &cu, RefPicList ref_list,
   PicNum ref_poc = cu.GetRefPicLists()->GetRefPoc(ref_list, ref_idx);
   int i = 0;
 
-  const CodingUnit *tmp = cu.GetCodingUnitLeftBelow();
-  if (!tmp || !tmp->IsInter()) {
-    tmp = cu.GetCodingUnitLeftCorner();
-  }
-  bool smvp_added = tmp && tmp->IsInter();
+  const CuNeighborInfo left_below = cu.GetNeighborInfoLeftBelow();
+  const CuNeighborInfo left_corner = cu.GetNeighborInfoLeftCorner();
+  const CuNeighborInfo above_right = cu.GetNeighborInfoAboveRight();
+  const CuNeighborInfo above_corner = cu.GetNeighborInfoAboveCorner();
+  const CuNeighborInfo above_left = cu.GetNeighborInfoAboveLeft();
+  bool smvp_added = left_below.IsInter() || left_corner.IsInter();
 
   // Left
-  if (GetMvpCand(cu.GetCodingUnitLeftBelow(),
-                 ref_list, ref_idx, ref_poc, &list[i])) {
+  if (GetMvpCand(cu, left_below, ref_list, ref_idx, ref_poc, &list[i])) {
     i++;
-  } else if (GetMvpCand(cu.GetCodingUnitLeftCorner(),
-                        ref_list, ref_idx, ref_poc, &list[i])) {
+  } else if (GetMvpCand(cu, left_corner, ref_list, ref_idx, ref_poc,
+                        &list[i])) {
     i++;
-  } else if (GetScaledMvpCand(cu.GetCodingUnitLeftBelow(),
-                              ref_list, ref_idx, &list[i])) {
+  } else if (GetScaledMvpCand(cu, left_below, ref_list, ref_idx, &list[i])) {
     i++;
-  } else if (GetScaledMvpCand(cu.GetCodingUnitLeftCorner(),
-                              ref_list, ref_idx, &list[i])) {
+  } else if (GetScaledMvpCand(cu, left_corner, ref_list, ref_idx,
+                              &list[i])) {
     i++;
   }
 
   // Above
-  if (GetMvpCand(cu.GetCodingUnitAboveRight(),
-                 ref_list, ref_idx, ref_poc, &list[i])) {
+  if (GetMvpCand(cu, above_right, ref_list, ref_idx, ref_poc, &list[i])) {
     i++;
-  } else if (GetMvpCand(cu.GetCodingUnitAboveCorner(),
-                        ref_list, ref_idx, ref_poc, &list[i])) {
+  } else if (GetMvpCand(cu, above_corner, ref_list, ref_idx, ref_poc,
+                        &list[i])) {
     i++;
-  } else if (GetMvpCand(cu.GetCodingUnitAboveLeft(),
-                        ref_list, ref_idx, ref_poc, &list[i])) {
+  } else if (GetMvpCand(cu, above_left, ref_list, ref_idx, ref_poc,
+                        &list[i])) {
     i++;
   }
   if (!smvp_added) {
-    if (GetScaledMvpCand(cu.GetCodingUnitAboveRight(),
-                         ref_list, ref_idx, &list[i])) {
+    if (GetScaledMvpCand(cu, above_right, ref_list, ref_idx, &list[i])) {
       i++;
-    } else if (GetScaledMvpCand(cu.GetCodingUnitAboveCorner(),
-                                ref_list, ref_idx, &list[i])) {
+    } else if (GetScaledMvpCand(cu, above_corner, ref_list, ref_idx,
+                                &list[i])) {
       i++;
-    } else if (GetScaledMvpCand(cu.GetCodingUnitAboveLeft(),
-                                ref_list, ref_idx, &list[i])) {
+    } else if (GetScaledMvpCand(cu, above_left, ref_list, ref_idx,
+                                &list[i])) {
       i++;
     }
   }
@@ -142,17 +140,17 @@ InterPrediction::GetMvPredictors(const CodingUnit &cu, RefPicList ref_list,
   return list;
 }
 
-static bool HasDifferentMotion(const CodingUnit &cu1, const CodingUnit &cu2) {
-  if (cu1.GetInterDir() != cu2.GetInterDir()) {
+static bool HasDifferentMotion(const CuNeighborInfo &cu1,
+                               const CuNeighborInfo &cu2) {
+  if (cu1.inter_dir != cu2.inter_dir) {
     return true;
   }
   for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
     RefPicList ref_list = RefPicList(i);
-    if (!cu1.HasMv(ref_list)) {
+    if (!ReferencePictureLists::IsRefPicListUsed(ref_list, cu1.inter_dir)) {
       continue;
     }
-    if (cu1.GetRefIdx(ref_list) != cu2.GetRefIdx(ref_list) ||
-        cu1.GetMv(ref_list) != cu2.GetMv(ref_list)) {
+    if (cu1.ref_idx[i] != cu2.ref_idx[i] || cu1.mv[i] != cu2.mv[i]) {
       return true;
     }
   }
@@ -167,48 +165,48 @@ InterPrediction::GetMergeCandidates(const CodingUnit &cu, int merge_cand_idx) {
   InterMergeCandidateList list;
   int num = 0;
 
-  const CodingUnit *left = cu.GetCodingUnitLeftCorner();
-  bool has_a1 = left && left->IsInter();
+  const CuNeighborInfo left = cu.GetNeighborInfoLeftCorner();
+  bool has_a1 = left.IsInter();
   if (has_a1) {
-    list[num] = GetMergeCandidateFromCu(*left);
+    list[num] = GetMergeCandidate(left);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *above = cu.GetCodingUnitAboveCorner();
-  bool has_b1 = above && above->IsInter();
-  if (has_b1 && (!has_a1 || HasDifferentMotion(*left, *above))) {
-    list[num] = GetMergeCandidateFromCu(*above);
+  const CuNeighborInfo above = cu.GetNeighborInfoAboveCorner();
+  bool has_b1 = above.IsInter();
+  if (has_b1 && (!has_a1 || HasDifferentMotion(left, above))) {
+    list[num] = GetMergeCandidate(above);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *above_right = cu.GetCodingUnitAboveRight();
-  bool has_b0 = above_right && above_right->IsInter();
-  if (has_b0 && (!has_b1 || HasDifferentMotion(*above, *above_right))) {
-    list[num] = GetMergeCandidateFromCu(*above_right);
+  const CuNeighborInfo above_right = cu.GetNeighborInfoAboveRight();
+  bool has_b0 = above_right.IsInter();
+  if (has_b0 && (!has_b1 || HasDifferentMotion(above, above_right))) {
+    list[num] = GetMergeCandidate(above_right);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *left_below = cu.GetCodingUnitLeftBelow();
-  bool has_a0 = left_below && left_below->IsInter();
-  if (has_a0 && (!has_a1 || HasDifferentMotion(*left, *left_below))) {
-    list[num] = GetMergeCandidateFromCu(*left_below);
+  const CuNeighborInfo left_below = cu.GetNeighborInfoLeftBelow();
+  bool has_a0 = left_below.IsInter();
+  if (has_a0 && (!has_a1 || HasDifferentMotion(left, left_below))) {
+    list[num] = GetMergeCandidate(left_below);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *above_left = cu.GetCodingUnitAboveLeft();
-  bool has_b2 = above_left && above_left->IsInter();
+  const CuNeighborInfo above_left = cu.GetNeighborInfoAboveLeft();
+  bool has_b2 = above_left.IsInter();
   if (has_b2 && num < 4
-      && (!has_a1 || HasDifferentMotion(*left, *above_left))
-      && (!has_b1 || HasDifferentMotion(*above, *above_left))) {
-    list[num] = GetMergeCandidateFromCu(*above_left);
+      && (!has_a1 || HasDifferentMotion(left, above_left))
+      && (!has_b1 || HasDifferentMotion(above, above_left))) {
+    list[num] = GetMergeCandidate(above_left);
     if (num++ == merge_cand_idx) {
       return list;
     }
@@ -427,47 +425,57 @@ void InterPrediction::ScaleMv(PicNum poc_current1, PicNum poc_ref1,
     (scale_factor * mv->y < 0)) >> 8, -32768, 32767);
 }
 
-bool InterPrediction::GetMvpCand(const CodingUnit *cu, RefPicList ref_list,
-                                 int ref_idx, PicNum ref_poc,
-                                 MotionVector *mv_out) {
-  if (!cu || !cu->IsInter()) {
+bool InterPrediction::GetMvpCand(const CodingUnit &cu,
+                                 const CuNeighborInfo &neighbor,
+                                 RefPicList ref_list, int ref_idx,
+                                 PicNum ref_poc, MotionVector *mv_out) {
+  if (!neighbor.IsInter()) {
     return false;
   }
-  if (cu->HasMv(ref_list) && cu->GetRefIdx(ref_list) == ref_idx) {
-    *mv_out = cu->GetMv(ref_list);
+  const int list_idx = static_cast<int>(ref_list);
+  if (ReferencePictureLists::IsRefPicListUsed(ref_list, neighbor.inter_dir) &&
+      neighbor.ref_idx[list_idx] == ref_idx) {
+    *mv_out = neighbor.mv[list_idx];
     return true;
   }
   RefPicList other_list = ReferencePictureLists::Inverse(ref_list);
-  if (cu->HasMv(other_list) && cu->GetRefPoc(other_list) == ref_poc) {
-    *mv_out = cu->GetMv(other_list);
+  const int other_idx = static_cast<int>(other_list);
+  if (ReferencePictureLists::IsRefPicListUsed(other_list,
+                                              neighbor.inter_dir) &&
+      cu.GetRefPicLists()->GetRefPoc(other_list,
+                                     neighbor.ref_idx[other_idx]) == ref_poc) {
+    *mv_out = neighbor.mv[other_idx];
     return true;
   }
   return false;
 }
 
-bool InterPrediction::GetScaledMvpCand(const CodingUnit *cu,
+bool InterPrediction::GetScaledMvpCand(const CodingUnit &cu,
+                                       const CuNeighborInfo &neighbor,
                                        RefPicList cu_ref_list, int ref_idx,
                                        MotionVector *out) {
-  if (!cu || !cu->IsInter()) {
+  if (!neighbor.IsInter()) {
     return false;
   }
   for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
     RefPicList ref_list = (i == 0) ?
       cu_ref_list : ReferencePictureLists::Inverse(cu_ref_list);
-    int cu_ref_idx = cu->GetRefIdx(ref_list);
-    if (!cu->HasMv(ref_list)) {
+    const int list_idx = static_cast<int>(ref_list);
+    int cu_ref_idx = neighbor.ref_idx[list_idx];
+    if (!ReferencePictureLists::IsRefPicListUsed(ref_list,
+                                                 neighbor.inter_dir)) {
       continue;
     }
     if ((i == 0 && cu_ref_idx == ref_idx) ||
         Restrictions::Get().disable_inter_scaling_mvp) {
-      *out = cu->GetMv(ref_list);
+      *out = neighbor.mv[list_idx];
       return true;
     }
-    auto *ref_pic_list = cu->GetRefPicLists();
-    PicNum poc_current = cu->GetPoc();
+    auto *ref_pic_list = cu.GetRefPicLists();
+    PicNum poc_current = cu.GetPoc();
     PicNum poc_ref_1 = ref_pic_list->GetRefPoc(cu_ref_list, ref_idx);
     PicNum poc_ref_2 = ref_pic_list->GetRefPoc(ref_list, cu_ref_idx);
-    *out = cu->GetMv(ref_list);
+    *out = neighbor.mv[list_idx];
     ScaleMv(poc_current, poc_ref_1, poc_current, poc_ref_2, out);
     return true;
   }
@@ -487,21 +495,23 @@ InterPrediction::GetTemporalMvPredictor(const CodingUnit &cu,
   RefPicList tmvp_mv_ref_list = ref_pic_list->HasOnlyBackReferences() ?
     ref_list : ReferencePictureLists::Inverse(tmvp_cu_ref_list);
 
+  const MotionField &col_field =
+    ref_pic_list->GetMotionField(tmvp_cu_ref_list, tmvp_cu_ref_idx);
   auto get_temporal_mv =
-    [this, &cu_poc, &cu_ref_poc](const CodingUnit *col_cu,
-                                 RefPicList col_ref_list,
-                                 MotionVector *col_mv) {
-    if (!col_cu->IsInter()) {
+    [this, &cu_poc, &cu_ref_poc, &col_field](int x, int y,
+                                             RefPicList col_ref_list,
+                                             MotionVector *col_mv) {
+    const MotionField::Motion &col_motion = col_field.GetMotionAt(x, y);
+    if (!col_motion.IsInter()) {
       return false;
     }
-    if (!col_cu->HasMv(col_ref_list)) {
+    if (!col_motion.HasMv(col_ref_list)) {
       col_ref_list = ReferencePictureLists::Inverse(col_ref_list);
     }
-    int col_ref_idx = col_cu->GetRefIdx(col_ref_list);
-    PicNum col_poc = col_cu->GetPoc();
-    PicNum col_ref_poc =
-      col_cu->GetRefPicLists()->GetRefPoc(col_ref_list, col_ref_idx);
-    *col_mv = col_cu->GetMv(col_ref_list);
+    int col_ref_idx = col_motion.GetRefIdx(col_ref_list);
+    PicNum col_poc = col_field.GetPoc();
+    PicNum col_ref_poc = col_field.GetRefPoc(col_ref_list, col_ref_idx);
+    *col_mv = col_motion.GetMv(col_ref_list);
     ScaleMv(cu_poc, cu_ref_poc, col_poc, col_ref_poc, col_mv);
     return true;
   };
@@ -515,11 +525,8 @@ InterPrediction::GetTemporalMvPredictor(const CodingUnit &cu,
       col_x = ((col_x >> 4) << 4);
       col_y = ((col_y >> 4) << 4);
     }
-    // Including picture out of bounds check
-    const CodingUnit *col_cu =
-      ref_pic_list->GetCodingUnitAt(tmvp_cu_ref_list, tmvp_cu_ref_idx,
-                                    cu.GetCuTree(), col_x, col_y);
-    if (col_cu && get_temporal_mv(col_cu, tmvp_mv_ref_list, mv_out)) {
+    // Outside of picture is stored as intra in the motion field
+    if (get_temporal_mv(col_x, col_y, tmvp_mv_ref_list, mv_out)) {
       return true;
     }
   }
@@ -531,10 +538,7 @@ InterPrediction::GetTemporalMvPredictor(const CodingUnit &cu,
     col_x = ((col_x >> 4) << 4);
     col_y = ((col_y >> 4) << 4);
   }
-  const CodingUnit *col_cu =
-    ref_pic_list->GetCodingUnitAt(tmvp_cu_ref_list, tmvp_cu_ref_idx,
-                                  cu.GetCuTree(), col_x, col_y);
-  if (get_temporal_mv(col_cu, tmvp_mv_ref_list, mv_out)) {
+  if (get_temporal_mv(col_x, col_y, tmvp_mv_ref_list, mv_out)) {
     return true;
   }
   return false;
@@ -781,6 +785,24 @@ static void FilterVerShortShort(int width, int height, int bitdepth,
   }
 }
 
+void InterPrediction::InterpolateLumaArea(int width, int height,
+                                          int frac_x, int frac_y,
+                                          const Sample *ref,
+                                          ptrdiff_t ref_stride,
+                                          Sample *dst, ptrdiff_t dst_stride) {
+  // Filter buffer is sized for the largest block
+  const int kBlockSize = constants::kMaxBlockSize;
+  for (int y = 0; y < height; y += kBlockSize) {
+    const int block_height = std::min(kBlockSize, height - y);
+    for (int x = 0; x < width; x += kBlockSize) {
+      const int block_width = std::min(kBlockSize, width - x);
+      FilterLuma(block_width, block_height, frac_x, frac_y,
+                 ref + y * ref_stride + x, ref_stride,
+                 dst + y * dst_stride + x, dst_stride);
+    }
+  }
+}
+
 void InterPrediction::FilterLuma(int width, int height, int frac_x, int frac_y,
                                  const Sample *ref, ptrdiff_t ref_stride,
                                  Sample *pred, ptrdiff_t pred_stride) {
@@ -922,15 +944,16 @@ static void AddAvg(int width, int height, int offset,
                      min_val, max_val);
 }
 
-MergeCandidate InterPrediction::GetMergeCandidateFromCu(const CodingUnit &cu) {
+MergeCandidate
+InterPrediction::GetMergeCandidate(const CuNeighborInfo &neighbor) {
   const int kL0 = static_cast<int>(RefPicList::kL0);
   const int kL1 = static_cast<int>(RefPicList::kL1);
   MergeCandidate cand;
-  cand.inter_dir = cu.GetInterDir();
-  cand.mv[kL0] = cu.GetMv(RefPicList::kL0);
-  cand.mv[kL1] = cu.GetMv(RefPicList::kL1);
-  cand.ref_idx[kL0] = cu.GetRefIdx(RefPicList::kL0);
-  cand.ref_idx[kL1] = cu.GetRefIdx(RefPicList::kL1);
+  cand.inter_dir = neighbor.inter_dir;
+  cand.mv[kL0] = neighbor.mv[kL0];
+  cand.mv[kL1] = neighbor.mv[kL1];
+  cand.ref_idx[kL0] = neighbor.ref_idx[kL0];
+  cand.ref_idx[kL1] = neighbor.ref_idx[kL1];
   return cand;
 }
 
@@ -953,4 +976,4 @@ InterPrediction::SimdFunc::SimdFunc() {
   filter_v_short_short[1] = &FilterVerShortShort<kNumTapsChroma>;
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -25,7 +25,7 @@
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/sample_buffer.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 typedef std::array<MotionVector,
   constants::kNumInterMvPredictors> InterPredictorList;
@@ -69,6 +69,11 @@ public:
   void DetermineMinMaxMv(const CodingUnit &cu, const YuvPicture &ref_pic,
                          int center_x, int center_y, int search_range,
                          MotionVector *mv_min, MotionVector *mv_max) const;
+  // Interpolates a luma area of any size with the same result as motion
+  // compensation of each block inside of it
+  void InterpolateLumaArea(int width, int height, int frac_x, int frac_y,
+                           const Sample *ref, ptrdiff_t ref_stride,
+                           Sample *dst, ptrdiff_t dst_stride);
   template<typename SrcT, bool Clip>
   static int GetFilterShift(int bitdepth);
   template<typename SrcT, bool Clip>
@@ -88,10 +93,12 @@ private:
   static void ScaleMv(PicNum poc_current1, PicNum poc_ref1, PicNum poc_current2,
                       PicNum poc_ref2, MotionVector *out);
 
-  bool GetMvpCand(const CodingUnit *cu, RefPicList ref_list, int ref_idx,
-                  PicNum ref_poc, MotionVector *mv_out);
-  bool GetScaledMvpCand(const CodingUnit *cu, RefPicList cu_ref_list,
-                        int ref_idx, MotionVector *mv_out);
+  bool GetMvpCand(const CodingUnit &cu, const CuNeighborInfo &neighbor,
+                  RefPicList ref_list, int ref_idx, PicNum ref_poc,
+                  MotionVector *mv_out);
+  bool GetScaledMvpCand(const CodingUnit &cu, const CuNeighborInfo &neighbor,
+                        RefPicList cu_ref_list, int ref_idx,
+                        MotionVector *mv_out);
   bool GetTemporalMvPredictor(const CodingUnit &cu, RefPicList ref_list,
                               int ref_idx, MotionVector *mv_out);
   void MotionCompensationBi(const CodingUnit &cu, YuvComponent comp,
@@ -117,7 +124,7 @@ private:
                 const int16_t *src_l0, ptrdiff_t src_l0_stride,
                 const int16_t *src_l1, ptrdiff_t src_l1_stride,
                 Sample *pred, ptrdiff_t pred_stride);
-  MergeCandidate GetMergeCandidateFromCu(const CodingUnit &cu);
+  MergeCandidate GetMergeCandidate(const CuNeighborInfo &neighbor);
 
   const InterPrediction::SimdFunc &simd_;
   std::array<int16_t, kBufSize> filter_buffer_;
@@ -205,6 +212,6 @@ inline int InterPrediction::GetFilterOffset<Sample, true>(int shift) {
   return 1 << (shift - 1);
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_INTER_PREDICTION_H_
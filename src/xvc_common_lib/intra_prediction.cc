@@ -25,7 +25,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 const int8_t IntraPrediction::kAngleTable_[17] = {
   -32, -26, -21, -17, -13, -9, -5, -2, 0, 2, 5, 9, 13, 17, 21, 26, 32
@@ -98,20 +98,20 @@ IntraPrediction::ComputeReferenceState(const CodingUnit &cu, YuvComponent comp,
 
 IntraPredictorLuma
 IntraPrediction::GetPredictorLuma(const CodingUnit &cu) const {
-  const CodingUnit *cu_left = cu.GetCodingUnitLeft();
+  const CuNeighborInfo cu_left = cu.GetNeighborInfoLeft();
   IntraMode left = IntraMode::kDc;
-  if (cu_left && cu_left->IsIntra()) {
-    left = cu_left->GetIntraMode(YuvComponent::kY);
+  if (cu_left.IsIntra()) {
+    left = static_cast<IntraMode>(cu_left.intra_mode_luma);
   }
-  const CodingUnit *cu_above;
+  CuNeighborInfo cu_above;
   if (Restrictions::Get().disable_ext_intra_unrestricted_predictor) {
-    cu_above = cu.GetCodingUnitAboveIfSameCtu();
+    cu_above = cu.GetNeighborInfoAboveIfSameCtu();
   } else {
-    cu_above = cu.GetCodingUnitAbove();
+    cu_above = cu.GetNeighborInfoAbove();
   }
   IntraMode above = IntraMode::kDc;
-  if (cu_above && cu_above->IsIntra()) {
-    above = cu_above->GetIntraMode(YuvComponent::kY);
+  if (cu_above.IsIntra()) {
+    above = static_cast<IntraMode>(cu_above.intra_mode_luma);
   }
   IntraPredictorLuma mpm;
   if (Restrictions::Get().disable_intra_mpm_prediction) {
@@ -544,4 +544,4 @@ void IntraPrediction::FilterRefSamples(int width, int height,
   dst_ref[stride + height + width - 1] = src_ref[stride + height + width - 1];
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
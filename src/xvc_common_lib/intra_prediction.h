@@ -24,7 +24,7 @@
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class IntraPredictorLuma :
   public std::array<IntraMode, constants::kNumIntraMpm> {
@@ -94,6 +94,6 @@ private:
   int bitdepth_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_INTRA_PREDICTION_H_
@@ -0,0 +1,76 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_common_lib/motion_field.h"
+
+#include <algorithm>
+
+#include "xvc_common_lib/coding_unit.h"
+
+namespace XVC_NAMESPACE {
+
+MotionField::MotionField(int width, int height) {
+  // Same dimensions as the coding unit lookup table of the picture
+  int num_x = (width + constants::kMaxBlockSize - 1) / constants::kMinBlockSize;
+  int num_y =
+    (height + constants::kMaxBlockSize - 1) / constants::kMinBlockSize;
+  stride_ = num_x + 1;
+  motion_.resize(stride_ * (num_y + 1));
+}
+
+void MotionField::Init(PicNum poc, const ReferencePictureLists &ref_lists) {
+  poc_ = poc;
+  for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+    const RefPicList ref_list = static_cast<RefPicList>(i);
+    ref_poc_[i].resize(ref_lists.GetNumRefPics(ref_list));
+    for (int j = 0; j < static_cast<int>(ref_poc_[i].size()); j++) {
+      ref_poc_[i][j] = ref_lists.GetRefPoc(ref_list, j);
+    }
+  }
+  Motion intra;
+  intra.mv_x = { { 0, 0 } };
+  intra.mv_y = { { 0, 0 } };
+  intra.ref_idx = { { -1, -1 } };
+  std::fill(motion_.begin(), motion_.end(), intra);
+}
+
+void MotionField::SetMotion(const CodingUnit &cu) {
+  if (!cu.IsInter()) {
+    return;
+  }
+  Motion motion;
+  for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+    const RefPicList ref_list = static_cast<RefPicList>(i);
+    const bool has_mv = cu.HasMv(ref_list);
+    // Motion vectors are limited to 16 bits also when scaled
+    motion.mv_x[i] = static_cast<int16_t>(has_mv ? cu.GetMv(ref_list).x : 0);
+    motion.mv_y[i] = static_cast<int16_t>(has_mv ? cu.GetMv(ref_list).y : 0);
+    motion.ref_idx[i] =
+      static_cast<int8_t>(has_mv ? cu.GetRefIdx(ref_list) : -1);
+  }
+  const int index_x = cu.GetPosX(YuvComponent::kY) / constants::kMinBlockSize;
+  const int index_y = cu.GetPosY(YuvComponent::kY) / constants::kMinBlockSize;
+  const int num_x = cu.GetWidth(YuvComponent::kY) / constants::kMinBlockSize;
+  const int num_y = cu.GetHeight(YuvComponent::kY) / constants::kMinBlockSize;
+  for (int y = 0; y < num_y; y++) {
+    Motion *ptr = &motion_[(index_y + y) * stride_ + index_x];
+    std::fill(ptr, ptr + num_x, motion);
+  }
+}
+
+}   // namespace XVC_NAMESPACE
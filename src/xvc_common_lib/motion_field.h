@@ -0,0 +1,77 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_COMMON_LIB_MOTION_FIELD_H_
+#define XVC_COMMON_LIB_MOTION_FIELD_H_
+
+#include <array>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/cu_types.h"
+#include "xvc_common_lib/reference_picture_lists.h"
+
+namespace XVC_NAMESPACE {
+
+class CodingUnit;
+
+// Compact copy of the motion data of a picture at minimum block size
+// granularity. Kept for temporal mv prediction by later pictures after the
+// coding units of the picture have been released.
+class MotionField {
+public:
+  struct Motion {
+    bool IsInter() const { return ref_idx[0] >= 0 || ref_idx[1] >= 0; }
+    bool HasMv(RefPicList list) const {
+      return ref_idx[static_cast<int>(list)] >= 0;
+    }
+    int GetRefIdx(RefPicList list) const {
+      return ref_idx[static_cast<int>(list)];
+    }
+    MotionVector GetMv(RefPicList list) const {
+      return MotionVector(mv_x[static_cast<int>(list)],
+                          mv_y[static_cast<int>(list)]);
+    }
+    std::array<int16_t, 2> mv_x;
+    std::array<int16_t, 2> mv_y;
+    std::array<int8_t, 2> ref_idx;
+  };
+
+  MotionField(int width, int height);
+  void Init(PicNum poc, const ReferencePictureLists &ref_pic_lists);
+  void SetMotion(const CodingUnit &cu);
+  const Motion& GetMotionAt(int posx, int posy) const {
+    ptrdiff_t idx = (posy / constants::kMinBlockSize) * stride_ +
+      (posx / constants::kMinBlockSize);
+    return motion_[idx];
+  }
+  PicNum GetPoc() const { return poc_; }
+  PicNum GetRefPoc(RefPicList list, int ref_idx) const {
+    return ref_poc_[static_cast<int>(list)][ref_idx];
+  }
+
+private:
+  ptrdiff_t stride_;
+  std::vector<Motion> motion_;
+  PicNum poc_ = static_cast<PicNum>(-1);
+  std::array<std::vector<PicNum>, 2> ref_poc_;
+};
+
+}   // namespace XVC_NAMESPACE
+
+#endif  // XVC_COMMON_LIB_MOTION_FIELD_H_
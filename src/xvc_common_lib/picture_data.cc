@@ -21,17 +21,80 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <type_traits>
+#include <utility>
 
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
+
+CuBatch::CuBatch(size_t size)
+  : bytes_(new uint8_t[size * sizeof(CodingUnit) + constants::kCacheLineSize]),
+  size_(size) {
+  static_assert(std::is_trivially_destructible<CodingUnit>::value,
+                "coding units are never destructed");
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(bytes_.get());
+  const uintptr_t mask = constants::kCacheLineSize - 1;
+  cus_ = reinterpret_cast<CodingUnit*>((addr + mask) & ~mask);
+}
+
+CodingUnit* CuBatch::GetCu(size_t idx) {
+  assert(idx < size_);
+  return cus_ + idx;
+}
+
+CuStorage::CuStorage(int pic_width, int pic_height, size_t alloc_size)
+  : width(pic_width),
+  height(pic_height) {
+  int num_cu_pic_x = (width + constants::kMaxBlockSize - 1) /
+    constants::kMinBlockSize;
+  int num_cu_pic_y = (height + constants::kMaxBlockSize - 1) /
+    constants::kMinBlockSize;
+  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
+    cu_pic_table[tree_idx].resize((num_cu_pic_x + 1) * (num_cu_pic_y + 1));
+    neighbor_info_table[tree_idx].resize(cu_pic_table[tree_idx].size());
+  }
+  // Initial CU buffer allocation, includes majority of allocated CUs
+  cu_alloc_buffers.emplace_back(alloc_size);
+}
+
+CuStorage::~CuStorage() {
+}
+
+std::unique_ptr<CuStorage> CuStoragePool::Acquire(int width, int height,
+                                                  size_t alloc_size) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Storage for a previous picture format is not used anymore
+  free_storage_.erase(
+    std::remove_if(free_storage_.begin(), free_storage_.end(),
+                   [width, height](const std::unique_ptr<CuStorage> &storage) {
+    return storage->width != width || storage->height != height;
+  }), free_storage_.end());
+  if (!free_storage_.empty()) {
+    std::unique_ptr<CuStorage> storage = std::move(free_storage_.back());
+    free_storage_.pop_back();
+    return storage;
+  }
+  lock.unlock();
+  return std::unique_ptr<CuStorage>(new CuStorage(width, height, alloc_size));
+}
+
+void CuStoragePool::Release(std::unique_ptr<CuStorage> storage) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_storage_.push_back(std::move(storage));
+}
 
 PictureData::PictureData(ChromaFormat chroma_format, int width, int height,
-                         int bitdepth)
-  : ctu_coeff_(new CoeffCtuBuffer(util::GetChromaShiftX(chroma_format),
+                         int bitdepth,
+                         std::shared_ptr<CuStoragePool> cu_storage_pool)
+  : cu_pic_table_({ { nullptr, nullptr } }),
+  neighbor_info_table_({ { nullptr, nullptr } }),
+  cu_storage_pool_(std::move(cu_storage_pool)),
+  motion_field_(width, height),
+  ctu_coeff_(new CoeffCtuBuffer(util::GetChromaShiftX(chroma_format),
                                   util::GetChromaShiftY(chroma_format))),
   pic_width_(width),
   pic_height_(height),
@@ -48,16 +111,8 @@ PictureData::PictureData(ChromaFormat chroma_format, int width, int height,
   cu_alloc_batch_size_(std::max(1, ctu_num_x_ * ctu_num_y_) * 4) {
   int num_cu_pic_x = (pic_width_ + constants::kMaxBlockSize - 1) /
     constants::kMinBlockSize;
-  int num_cu_pic_y = (pic_height_ + constants::kMaxBlockSize - 1) /
-    constants::kMinBlockSize;
   cu_pic_stride_ = num_cu_pic_x + 1;
-  // Initial CU buffer allocation, includes majority of allocated CUs
-  cu_alloc_buffers_.emplace_back(cu_alloc_batch_size_ * 4);
-  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
-    cu_pic_table_[tree_idx].resize(cu_pic_stride_ * (num_cu_pic_y + 1));
-    std::fill(cu_pic_table_[tree_idx].begin(),
-              cu_pic_table_[tree_idx].end(), nullptr);
-  }
+  AcquireCuStorage();
 }
 
 PictureData::~PictureData() {
@@ -105,14 +160,20 @@ void PictureData::Init(const SegmentHeader &segment, const Qp &pic_qp,
   // Initialize CU allocator / object pool
   // Buffer pointers are reset to first entry without any deconstruction
   // this requires that no object are reused across pictures
+  if (!cu_storage_) {
+    AcquireCuStorage();
+  }
   cu_alloc_free_list_.clear();
   cu_alloc_list_index_ = 0;
   cu_alloc_item_index_ = 0;
 
   // CTU initialization
   for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
-    std::fill(cu_pic_table_[tree_idx].begin(),
-              cu_pic_table_[tree_idx].end(), nullptr);
+    std::fill(cu_storage_->cu_pic_table[tree_idx].begin(),
+              cu_storage_->cu_pic_table[tree_idx].end(), nullptr);
+    std::fill(cu_storage_->neighbor_info_table[tree_idx].begin(),
+              cu_storage_->neighbor_info_table[tree_idx].end(),
+              CuNeighborInfo());
     // Clear all CTU objects and re-assign again below for every picture
     ctu_rs_list_[tree_idx].clear();
   }
@@ -156,17 +217,18 @@ CodingUnit *PictureData::CreateCu(CuTree cu_tree, int depth, int posx,
     cu = cu_alloc_free_list_.back();
     cu_alloc_free_list_.pop_back();
   } else {
-    assert(!cu_alloc_buffers_.empty());
+    std::vector<CuBatch> &cu_alloc_buffers = cu_storage_->cu_alloc_buffers;
+    assert(!cu_alloc_buffers.empty());
     if (cu_alloc_item_index_ ==
-        cu_alloc_buffers_[cu_alloc_list_index_].size()) {
+        cu_alloc_buffers[cu_alloc_list_index_].GetSize()) {
       cu_alloc_list_index_++;
       cu_alloc_item_index_ = 0;
     }
-    if (cu_alloc_list_index_ == cu_alloc_buffers_.size()) {
+    if (cu_alloc_list_index_ == cu_alloc_buffers.size()) {
       // Allocate an extra buffer (typically needed for intra pictures)
-      cu_alloc_buffers_.emplace_back(cu_alloc_batch_size_);
+      cu_alloc_buffers.emplace_back(cu_alloc_batch_size_);
     }
-    cu = &cu_alloc_buffers_[cu_alloc_list_index_][cu_alloc_item_index_];
+    cu = cu_alloc_buffers[cu_alloc_list_index_].GetCu(cu_alloc_item_index_);
     cu_alloc_item_index_++;
   }
   // Reinitialize memory to a known state
@@ -174,6 +236,26 @@ CodingUnit *PictureData::CreateCu(CuTree cu_tree, int depth, int posx,
                              posx, posy, width, height);
 }
 
+void PictureData::ReleaseCodingUnits() {
+  motion_field_.Init(poc_, ref_pic_lists_);
+  if (!IsIntraPic()) {
+    for (CodingUnit *ctu : ctu_rs_list_[static_cast<int>(CuTree::Primary)]) {
+      StoreMotionField(ctu);
+    }
+  }
+  if (!cu_storage_pool_) {
+    // Storage is kept for the next picture
+    return;
+  }
+  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
+    ctu_rs_list_[tree_idx].clear();
+    cu_pic_table_[tree_idx] = nullptr;
+    neighbor_info_table_[tree_idx] = nullptr;
+  }
+  cu_alloc_free_list_.clear();
+  cu_storage_pool_->Release(std::move(cu_storage_));
+}
+
 void PictureData::ReleaseCu(CodingUnit *cu) {
   for (CodingUnit *sub_cu : cu->GetSubCu()) {
     if (sub_cu) {
@@ -197,10 +279,33 @@ void PictureData::MarkUsedInPic(CodingUnit *cu) {
   const int index_y = cu->GetPosY(YuvComponent::kY) / constants::kMinBlockSize;
   const int num_x = cu->GetWidth(YuvComponent::kY) / constants::kMinBlockSize;
   const int num_y = cu->GetHeight(YuvComponent::kY) / constants::kMinBlockSize;
+  const CuNeighborInfo info = cu->GetNeighborInfo();
   for (int y = 0; y < num_y; y++) {
-    CodingUnit **ptr =
-      &cu_pic_table_[cu_tree][(index_y + y) * cu_pic_stride_ + index_x];
+    const ptrdiff_t offset = (index_y + y) * cu_pic_stride_ + index_x;
+    CodingUnit **ptr = &cu_pic_table_[cu_tree][offset];
     std::fill(ptr, ptr + num_x, cu);
+    CuNeighborInfo *info_ptr = &neighbor_info_table_[cu_tree][offset];
+    std::fill(info_ptr, info_ptr + num_x, info);
+  }
+}
+
+void PictureData::UpdateNeighborInfo(const CodingUnit &cu) {
+  const int cu_tree = static_cast<int>(cu.GetCuTree());
+  const int index_x = cu.GetPosX(YuvComponent::kY) / constants::kMinBlockSize;
+  const int index_y = cu.GetPosY(YuvComponent::kY) / constants::kMinBlockSize;
+  const int num_x = cu.GetWidth(YuvComponent::kY) / constants::kMinBlockSize;
+  const int num_y = cu.GetHeight(YuvComponent::kY) / constants::kMinBlockSize;
+  const CuNeighborInfo info = cu.GetNeighborInfo();
+  for (int y = 0; y < num_y; y++) {
+    const ptrdiff_t offset = (index_y + y) * cu_pic_stride_ + index_x;
+    CodingUnit **ptr = &cu_pic_table_[cu_tree][offset];
+    CuNeighborInfo *info_ptr = &neighbor_info_table_[cu_tree][offset];
+    for (int x = 0; x < num_x; x++) {
+      // Parts already covered by other coding units are left untouched
+      if (ptr[x] == &cu) {
+        info_ptr[x] = info;
+      }
+    }
   }
 }
 
@@ -211,9 +316,11 @@ void PictureData::ClearMarkCuInPic(CodingUnit *cu) {
   const int num_x = cu->GetWidth(YuvComponent::kY) / constants::kMinBlockSize;
   const int num_y = cu->GetHeight(YuvComponent::kY) / constants::kMinBlockSize;
   for (int y = 0; y < num_y; y++) {
-    CodingUnit **ptr =
-      &cu_pic_table_[cu_tree][(index_y + y) * cu_pic_stride_ + index_x];
+    const ptrdiff_t offset = (index_y + y) * cu_pic_stride_ + index_x;
+    CodingUnit **ptr = &cu_pic_table_[cu_tree][offset];
     std::fill(ptr, ptr + num_x, nullptr);
+    CuNeighborInfo *info_ptr = &neighbor_info_table_[cu_tree][offset];
+    std::fill(info_ptr, info_ptr + num_x, CuNeighborInfo());
   }
 }
 
@@ -259,6 +366,21 @@ RefPicList PictureData::DetermineTmvpRefList(int *tmvp_ref_idx) {
   return (tid_l1 >= tid_l0) ? RefPicList::kL1 : RefPicList::kL0;
 }
 
+void PictureData::AcquireCuStorage() {
+  const size_t alloc_size = cu_alloc_batch_size_ * 4;
+  if (cu_storage_pool_) {
+    cu_storage_ = cu_storage_pool_->Acquire(pic_width_, pic_height_,
+                                            alloc_size);
+  } else {
+    cu_storage_.reset(new CuStorage(pic_width_, pic_height_, alloc_size));
+  }
+  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
+    cu_pic_table_[tree_idx] = &cu_storage_->cu_pic_table[tree_idx][0];
+    neighbor_info_table_[tree_idx] =
+      &cu_storage_->neighbor_info_table[tree_idx][0];
+  }
+}
+
 void PictureData::AllocateAllCtu(CuTree cu_tree) {
   const int depth = 0;
   int tree_idx = static_cast<int>(cu_tree);
@@ -273,4 +395,17 @@ void PictureData::AllocateAllCtu(CuTree cu_tree) {
   }
 }
 
-}   // namespace xvc
+void PictureData::StoreMotionField(const CodingUnit *cu) {
+  if (!cu) {
+    return;
+  }
+  if (cu->GetSplit() != SplitType::kNone) {
+    for (int i = 0; i < constants::kQuadSplit; i++) {
+      StoreMotionField(cu->GetSubCu(i));
+    }
+    return;
+  }
+  motion_field_.SetMotion(*cu);
+}
+
+}   // namespace XVC_NAMESPACE
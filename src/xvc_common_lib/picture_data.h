@@ -19,22 +19,69 @@
 #ifndef XVC_COMMON_LIB_PICTURE_DATA_H_
 #define XVC_COMMON_LIB_PICTURE_DATA_H_
 
+// Some C++11 headers are not allowed by cpplint
+#include <array>
 #include <memory>
+#include <mutex>                // NOLINT
 #include <vector>
 
+#include "xvc_common_lib/motion_field.h"
 #include "xvc_common_lib/picture_types.h"
 #include "xvc_common_lib/reference_picture_lists.h"
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class CodingUnit;
 
+// Fixed size batch of coding unit objects, the first object starts at a cache
+// line boundary. Objects are constructed when handed out by PictureData.
+class CuBatch {
+public:
+  explicit CuBatch(size_t size);
+  size_t GetSize() const { return size_; }
+  CodingUnit* GetCu(size_t idx);
+
+private:
+  std::unique_ptr<uint8_t[]> bytes_;
+  CodingUnit *cus_;
+  size_t size_;
+};
+
+// Coding unit objects and lookup tables that are only needed while a picture
+// is being coded
+struct CuStorage {
+  CuStorage(int width, int height, size_t alloc_size);
+  ~CuStorage();
+  int width;
+  int height;
+  std::array<std::vector<CodingUnit*>,
+    constants::kMaxNumCuTrees> cu_pic_table;
+  // Same layout as cu_pic_table
+  std::array<std::vector<CuNeighborInfo>,
+    constants::kMaxNumCuTrees> neighbor_info_table;
+  // Chunks of allocated memory, the batches are never resized
+  std::vector<CuBatch> cu_alloc_buffers;
+};
+
+// Shares coding unit storage between the pictures of an encoder or decoder,
+// so that only pictures currently being coded hold any storage
+class CuStoragePool {
+public:
+  std::unique_ptr<CuStorage> Acquire(int width, int height, size_t alloc_size);
+  void Release(std::unique_ptr<CuStorage> storage);
+
+private:
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<CuStorage>> free_storage_;
+};
+
 class PictureData {
 public:
-  PictureData(ChromaFormat chroma_format, int width, int height, int bitdepth);
+  PictureData(ChromaFormat chroma_format, int width, int height, int bitdepth,
+              std::shared_ptr<CuStoragePool> cu_storage_pool = nullptr);
   ~PictureData();
 
   void Init(const SegmentHeader &segment, const Qp &pic_qp,
@@ -99,6 +146,16 @@ public:
       (posx / constants::kMinBlockSize);
     return cu_pic_table_[static_cast<int>(cu_tree)][cu_idx];
   }
+  CuNeighborInfo GetNeighborInfoAt(CuTree cu_tree, int posx, int posy) const {
+    ptrdiff_t cu_idx = (posy / constants::kMinBlockSize) * cu_pic_stride_ +
+      (posx / constants::kMinBlockSize);
+    return neighbor_info_table_[static_cast<int>(cu_tree)][cu_idx];
+  }
+  // Motion data kept after the coding units have been released
+  const MotionField& GetMotionField() const { return motion_field_; }
+  // Stores the motion field of the finished picture and returns the coding
+  // unit storage to the pool (if any) until the next picture is coded
+  void ReleaseCodingUnits();
   CodingUnit* GetCuAtForModification(CuTree cu_tree, int posx, int posy) {
     ptrdiff_t cu_idx = (posy / constants::kMinBlockSize) * cu_pic_stride_ +
       (posx / constants::kMinBlockSize);
@@ -109,6 +166,8 @@ public:
                        int width, int height);
   void ReleaseCu(CodingUnit *cu);
   void MarkUsedInPic(CodingUnit *cu);
+  // Refreshes the neighbor info of a coding unit that is marked in picture
+  void UpdateNeighborInfo(const CodingUnit &cu);
   void ClearMarkCuInPic(CodingUnit *cu);
 
   // High level syntax
@@ -144,18 +203,22 @@ public:
 
 private:
   RefPicList DetermineTmvpRefList(int *tmvp_ref_idx);
+  void AcquireCuStorage();
   void AllocateAllCtu(CuTree cu_tree);
+  void StoreMotionField(const CodingUnit *cu);
 
   std::array<std::vector<CodingUnit*>,
     constants::kMaxNumCuTrees> ctu_rs_list_;
-  std::array<std::vector<CodingUnit*>,
-    constants::kMaxNumCuTrees> cu_pic_table_;
+  // Points into the lookup tables of the current cu storage
+  std::array<CodingUnit**, constants::kMaxNumCuTrees> cu_pic_table_;
+  std::array<CuNeighborInfo*, constants::kMaxNumCuTrees> neighbor_info_table_;
   std::array<std::vector<YuvComponent>,
     constants::kMaxNumCuTrees> cu_tree_components_;
   // Non owning pointers to CU objects that were preivously used in rdo
   std::vector<CodingUnit*> cu_alloc_free_list_;
-  // Chunks of allocated memory, the inner arrays are static and never resized
-  std::vector<std::vector<CodingUnit>> cu_alloc_buffers_;
+  std::shared_ptr<CuStoragePool> cu_storage_pool_;
+  std::unique_ptr<CuStorage> cu_storage_;
+  MotionField motion_field_;
   // Holds coefficients for a single ctu, then reused for next one
   std::unique_ptr<CoeffCtuBuffer> ctu_coeff_;
   ptrdiff_t cu_pic_stride_;
@@ -191,6 +254,6 @@ private:
   int tc_offset_ = 0;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_PICTURE_DATA_H_
@@ -19,7 +19,9 @@
 #ifndef XVC_COMMON_LIB_PICTURE_TYPES_H_
 #define XVC_COMMON_LIB_PICTURE_TYPES_H_
 
-namespace xvc {
+#include "xvc_common_lib/common.h"
+
+namespace XVC_NAMESPACE {
 
 enum class NalUnitType {
   kIntraPicture = 0,
@@ -53,6 +55,6 @@ enum class PicturePredictionType {
   kInvalid = 99,
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_PICTURE_TYPES_H_
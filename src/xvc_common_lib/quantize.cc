@@ -26,7 +26,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/transform.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 const uint8_t Qp::kChromaScale_[Qp::kChromaQpMax_ + 1] = {
   0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21,
@@ -134,13 +134,8 @@ double Qp::CalculateLambda(int qp, PicturePredictionType pic_type,
 void Quantize::Inverse(YuvComponent comp, const Qp &qp, int width, int height,
                        int bitdepth, const Coeff *in, ptrdiff_t in_stride,
                        Coeff *out, ptrdiff_t out_stride) {
-  const bool size_rounding_bias =
-    (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
-  const int transform_shift = GetTransformShift(width, height, bitdepth);
-  const int shift = kIQuantShift - transform_shift +
-    (size_rounding_bias ? 8 : 0);
-  const int scale = qp.GetInvScale(comp) * (size_rounding_bias ? 181 : 1);
-
+  int scale, shift;
+  GetInverseScale(comp, qp, width, height, bitdepth, &scale, &shift);
   if (shift > 0) {
     int offset = (1 << (shift - 1));
     for (int y = 0; y < height; y++) {
@@ -164,10 +159,30 @@ void Quantize::Inverse(YuvComponent comp, const Qp &qp, int width, int height,
   }
 }
 
+Coeff Quantize::InverseDc(YuvComponent comp, const Qp &qp, int width,
+                          int height, int bitdepth, Coeff dc_coeff) {
+  int scale, shift;
+  GetInverseScale(comp, qp, width, height, bitdepth, &scale, &shift);
+  int coeff = shift > 0 ?
+    ((dc_coeff * scale) + (1 << (shift - 1))) >> shift :
+    (dc_coeff * scale) << -shift;
+  return util::Clip3(coeff, constants::kInt16Min, constants::kInt16Max);
+}
+
 int Quantize::GetTransformShift(int width, int height, int bitdepth) {
   const int tr_size_log2 =
     (util::SizeToLog2(width) + util::SizeToLog2(height)) >> 1;
   return constants::kMaxTrDynamicRange - bitdepth - tr_size_log2;
 }
 
-}   // namespace xvc
+void Quantize::GetInverseScale(YuvComponent comp, const Qp &qp, int width,
+                               int height, int bitdepth, int *scale,
+                               int *shift) {
+  const bool size_rounding_bias =
+    (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
+  const int transform_shift = GetTransformShift(width, height, bitdepth);
+  *shift = kIQuantShift - transform_shift + (size_rounding_bias ? 8 : 0);
+  *scale = qp.GetInvScale(comp) * (size_rounding_bias ? 181 : 1);
+}
+
+}   // namespace XVC_NAMESPACE
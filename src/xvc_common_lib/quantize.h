@@ -25,7 +25,7 @@
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/picture_types.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class CodingUnit;
 
@@ -93,9 +93,16 @@ public:
   void Inverse(YuvComponent comp, const Qp &qp, int width, int height,
                int bitdepth, const Coeff *in, ptrdiff_t in_stride, Coeff *out,
                ptrdiff_t out_stride);
+  Coeff InverseDc(YuvComponent comp, const Qp &qp, int width, int height,
+                  int bitdepth, Coeff dc_coeff);
   static int GetTransformShift(int width, int height, int bitdepth);
+
+private:
+  static void GetInverseScale(YuvComponent comp, const Qp &qp, int width,
+                              int height, int bitdepth, int *scale,
+                              int *shift);
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_QUANTIZE_H_
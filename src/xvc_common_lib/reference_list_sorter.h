@@ -28,7 +28,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 template<class T>
 class ReferenceListSorter {
@@ -247,6 +247,6 @@ private:
   bool prev_segment_open_gop_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_REFERENCE_LIST_SORTER_H_
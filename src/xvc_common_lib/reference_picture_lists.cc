@@ -22,7 +22,7 @@
 
 #include "xvc_common_lib/picture_data.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 bool ReferencePictureLists::IsRefPicListUsed(RefPicList ref_pic_list,
                                              InterDir inter_dir) {
@@ -61,17 +61,22 @@ ReferencePictureLists::GetRefPicTid(RefPicList ref_list, int ref_idx) const {
   return (*entry_list)[ref_idx].data->GetTid();
 }
 
-const CodingUnit*
-ReferencePictureLists::GetCodingUnitAt(RefPicList ref_list, int index,
-                                       CuTree cu_tree, int posx,
-                                       int posy) const {
-  std::shared_ptr<const PictureData> pic_data;
+PicNum
+ReferencePictureLists::GetRefPicDoc(RefPicList ref_list, int ref_idx) const {
+  const std::vector<RefEntry> *entry_list =
+    ref_list == RefPicList::kL0 ? &l0_ : &l1_;
+  if (static_cast<int>(entry_list->size()) <= ref_idx) {
+    return static_cast<PicNum>(-1);
+  }
+  return (*entry_list)[ref_idx].data->GetDoc();
+}
+
+const MotionField&
+ReferencePictureLists::GetMotionField(RefPicList ref_list, int index) const {
   if (ref_list == RefPicList::kL0) {
-    pic_data = l0_[index].data;
-  } else {
-    pic_data = l1_[index].data;
+    return l0_[index].data->GetMotionField();
   }
-  return pic_data->GetCuAt(cu_tree, posx, posy);
+  return l1_[index].data->GetMotionField();
 }
 
 void
@@ -129,4 +134,4 @@ void ReferencePictureLists::Reset(PicNum current_poc) {
   only_back_references_ = true;
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -26,7 +26,7 @@
 #include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/yuv_pic.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 enum class RefPicList {
   kL0 = 0,
@@ -35,6 +35,7 @@ enum class RefPicList {
 };
 
 class CodingUnit;
+class MotionField;
 class PictureData;
 
 class ReferencePictureLists {
@@ -58,8 +59,8 @@ public:
   bool HasOnlyBackReferences() const { return only_back_references_; }
   PicturePredictionType GetRefPicType(RefPicList ref_list, int ref_idx) const;
   int GetRefPicTid(RefPicList ref_list, int ref_idx) const;
-  const CodingUnit* GetCodingUnitAt(RefPicList ref_list, int ref_idx,
-                                    CuTree cu_tree, int posx, int posy) const;
+  PicNum GetRefPicDoc(RefPicList ref_list, int ref_idx) const;
+  const MotionField& GetMotionField(RefPicList ref_list, int ref_idx) const;
   void SetRefPic(RefPicList ref_list, int index, PicNum ref_poc,
                  const std::shared_ptr<const PictureData> &pic_data,
                  const std::shared_ptr<const YuvPicture> &ref_pic);
@@ -80,6 +81,6 @@ private:
   bool only_back_references_ = true;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_REFERENCE_PICTURE_LISTS_H_
@@ -24,7 +24,7 @@
 
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 namespace resample {
 
@@ -409,4 +409,4 @@ template void BilinearResample<Sample, uint16_t>(uint8_t *dst_start,
 
 }   // namespace resample
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -21,7 +21,7 @@
 
 #include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 namespace resample {
 
@@ -39,6 +39,6 @@ void BilinearResample(uint8_t *dst_start, int dst_width, int dst_height,
 
 }   // namespace resample
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_RESAMPLE_H_
@@ -20,7 +20,7 @@
 
 #include <cassert>
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 thread_local Restrictions Restrictions::instance;
 
@@ -297,4 +297,4 @@ void Restrictions::EnableRestrictedMode(RestrictedMode mode) {
   }
 }
 
-}  // namespace xvc
+}  // namespace XVC_NAMESPACE
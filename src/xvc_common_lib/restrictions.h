@@ -19,8 +19,9 @@
 #ifndef XVC_COMMON_LIB_RESTRICTIONS_H_
 #define XVC_COMMON_LIB_RESTRICTIONS_H_
 
+#include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 enum class RestrictedMode {
   kUnrestricted = 0,
@@ -199,12 +200,13 @@ private:
   friend class Encoder;
   friend class Decoder;
   friend class ThreadDecoder;
+  friend class SegmentParallelEncoder;
   static thread_local Restrictions instance;
   static Restrictions &GetRW() { return instance; }
 
   void EnableRestrictedMode(RestrictedMode mode);
 } Restrictions;
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_RESTRICTIONS_H_
@@ -26,7 +26,7 @@
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 template<typename T>
 class DataBuffer {
@@ -76,6 +76,20 @@ public:
     }
   }
 
+  void AddClip(int width, int height,
+               const DataBuffer<const Sample> &pred_buffer, Residual residual,
+               Sample min_val, Sample max_val) {
+    const Sample *src = pred_buffer.GetDataPtr();
+    Sample *dst = GetDataPtr();
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        dst[x] = util::Clip3<Sample>(src[x] + residual, min_val, max_val);
+      }
+      src += pred_buffer.GetStride();
+      dst += GetStride();
+    }
+  }
+
   void AddAvg(int width, int height,
               const DataBuffer<const int16_t> &src1_buffer,
               const DataBuffer<const int16_t> &src2_buffer,
@@ -131,6 +145,18 @@ public:
       dst += GetStride();
     }
   }
+
+  int64_t SumAbs(int width, int height) const {
+    const Residual *src = GetDataPtr();
+    int64_t sum = 0;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        sum += src[x] < 0 ? -src[x] : src[x];
+      }
+      src += GetStride();
+    }
+    return sum;
+  }
 };
 
 class CoeffBuffer : public DataBuffer<Coeff> {
@@ -210,6 +236,6 @@ private:
     constants::kMaxYuvComponents> comp_storage_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_SAMPLE_BUFFER_H_
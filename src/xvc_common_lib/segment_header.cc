@@ -22,9 +22,9 @@
 #include <array>
 #include <cassert>
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
-static const int kMaxPicNumVal = xvc::constants::kTimeScale + 1;
+static const int kMaxPicNumVal = XVC_NAMESPACE::constants::kTimeScale + 1;
 
 static const std::array<std::array<PicNum, 17>, 17> kDocToPoc = { {
   { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
@@ -296,4 +296,4 @@ int SegmentHeader::DocToTid(PicNum sub_gop_length, PicNum doc) {
 }
 
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -23,7 +23,7 @@
 #include "xvc_common_lib/checksum.h"
 #include "xvc_common_lib/restrictions.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 struct SegmentHeader {
   static PicNum CalcDocFromPoc(PicNum poc, PicNum sub_gop_length,
@@ -78,6 +78,6 @@ private:
   static int DocToTid(PicNum sub_gop_length, PicNum doc);
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_SEGMENT_HEADER_H_
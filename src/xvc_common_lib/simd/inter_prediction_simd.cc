@@ -39,7 +39,7 @@
 #define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
 #endif
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 namespace simd {
 
 constexpr int kBin8_01_00_11_10 = (1 << 6) | (0 << 4) | (3 << 2) | (2 << 0);
@@ -1194,7 +1194,7 @@ void FilterVerChromaNeon(int width, int height, int bitdepth,
 
 #if XVC_ARCH_ARM
 void InterPredictionSimd::Register(const std::set<CpuCapability> &caps,
-                                   xvc::SimdFunctions *simd_functions) {
+                                   SimdFunctions *simd_functions) {
 #if XVC_HAVE_NEON
   auto &ip = simd_functions->inter_prediction;
   if (caps.find(CpuCapability::kNeon) != caps.end()) {
@@ -1219,7 +1219,7 @@ void InterPredictionSimd::Register(const std::set<CpuCapability> &caps,
 
 #if XVC_ARCH_X86
 void InterPredictionSimd::Register(const std::set<CpuCapability> &caps,
-                                   xvc::SimdFunctions *simd_functions) {
+                                   SimdFunctions *simd_functions) {
   auto &ip = simd_functions->inter_prediction;
   if (caps.find(CpuCapability::kSse2) != caps.end()) {
     ip.add_avg[1] = &AddAvgSse2;
@@ -1242,9 +1242,9 @@ void InterPredictionSimd::Register(const std::set<CpuCapability> &caps,
 
 #if XVC_ARCH_MIPS
 void InterPredictionSimd::Register(const std::set<CpuCapability> &caps,
-                                   xvc::SimdFunctions *simd_functions) {
+                                   SimdFunctions *simd_functions) {
 }
 #endif  // XVC_ARCH_MIPS
 
 }   // namespace simd
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -24,7 +24,7 @@
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/simd_cpu.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 struct SimdFunctions;
 
@@ -32,10 +32,10 @@ namespace simd {
 
 struct InterPredictionSimd {
   static void Register(const std::set<CpuCapability> &caps,
-                       xvc::SimdFunctions *simd);
+                       XVC_NAMESPACE::SimdFunctions *simd);
 };
 
 }   // namespace simd
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_SIMD_INTER_PREDICTION_SIMD_H_
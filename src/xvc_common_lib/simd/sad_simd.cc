@@ -0,0 +1,190 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+
+#include "xvc_common_lib/simd/sad_simd.h"
+
+#if XVC_ARCH_X86
+#include <immintrin.h>
+#endif
+
+#include <cstdlib>
+
+#include "xvc_common_lib/simd_functions.h"
+
+#ifdef _MSC_VER
+#define __attribute__(SPEC)
+#endif
+
+#ifdef XVC_ARCH_X86
+// Formatting helper
+#define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
+#define CAST_M256_CONST(VAL) reinterpret_cast<const __m256i*>((VAL))
+#endif
+
+namespace XVC_NAMESPACE {
+namespace simd {
+
+#if XVC_ARCH_X86
+static const int kNumCand = SimdFunctions::SadFunc::kNumCand;
+
+// Sum of absolute differences for the columns not covered by vector code
+template<typename SampleT1>
+static void SadX4Tail(int x0, int width, int height,
+                      const SampleT1 *src1, ptrdiff_t stride1,
+                      const Sample *const *src2, ptrdiff_t stride2,
+                      uint64_t *sad) {
+  for (int i = 0; i < kNumCand; i++) {
+    const SampleT1 *orig = src1;
+    const Sample *cand = src2[i];
+    uint64_t sum = 0;
+    for (int y = 0; y < height; y++) {
+      for (int x = x0; x < width; x++) {
+        sum += std::abs(orig[x] - cand[x]);
+      }
+      orig += stride1;
+      cand += stride2;
+    }
+    sad[i] += sum;
+  }
+}
+
+// Loads 8 samples widened to 16 bit
+template<typename T>
+__attribute__((target("sse2")))
+static inline __m128i Load8Sse2(const T *src) {
+  if (sizeof(T) == 1) {
+    return _mm_unpacklo_epi8(_mm_loadl_epi64(CAST_M128_CONST(src)),
+                             _mm_setzero_si128());
+  }
+  return _mm_loadu_si128(CAST_M128_CONST(src));
+}
+
+// Loads 16 samples widened to 16 bit
+template<typename T>
+__attribute__((target("avx2")))
+static inline __m256i Load16Avx2(const T *src) {
+  if (sizeof(T) == 1) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(CAST_M128_CONST(src)));
+  }
+  return _mm256_loadu_si256(CAST_M256_CONST(src));
+}
+
+__attribute__((target("sse2")))
+static inline uint64_t HorizontalSumSse2(__m128i sum) {
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+  return static_cast<uint32_t>(_mm_cvtsi128_si32(sum));
+}
+
+// Differences are at most bitdepth + 2 bits (bi-pred original is
+// 2 * orig - pred), so 16 bit absolute differences and 32 bit sums suffice
+template<typename SampleT1>
+__attribute__((target("sse2")))
+static void SadX4Sse2(int width, int height,
+                      const SampleT1 *src1, ptrdiff_t stride1,
+                      const Sample *const *src2, ptrdiff_t stride2,
+                      uint64_t *sad) {
+  const int width8 = width & ~7;
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+  __m128i acc[kNumCand];
+  for (int i = 0; i < kNumCand; i++) {
+    acc[i] = zero;
+  }
+  const SampleT1 *orig = src1;
+  ptrdiff_t offset = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width8; x += 8) {
+      __m128i vorig = Load8Sse2(orig + x);
+      for (int i = 0; i < kNumCand; i++) {
+        __m128i diff = _mm_sub_epi16(vorig, Load8Sse2(src2[i] + offset + x));
+        __m128i absdiff = _mm_max_epi16(diff, _mm_sub_epi16(zero, diff));
+        acc[i] = _mm_add_epi32(acc[i], _mm_madd_epi16(absdiff, ones));
+      }
+    }
+    orig += stride1;
+    offset += stride2;
+  }
+  for (int i = 0; i < kNumCand; i++) {
+    sad[i] = HorizontalSumSse2(acc[i]);
+  }
+  if (width8 < width) {
+    SadX4Tail(width8, width, height, src1, stride1, src2, stride2, sad);
+  }
+}
+
+template<typename SampleT1>
+__attribute__((target("avx2")))
+static void SadX4Avx2(int width, int height,
+                      const SampleT1 *src1, ptrdiff_t stride1,
+                      const Sample *const *src2, ptrdiff_t stride2,
+                      uint64_t *sad) {
+  const int width16 = width & ~15;
+  if (width16 == 0) {
+    SadX4Sse2(width, height, src1, stride1, src2, stride2, sad);
+    return;
+  }
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i acc[kNumCand];
+  for (int i = 0; i < kNumCand; i++) {
+    acc[i] = _mm256_setzero_si256();
+  }
+  const SampleT1 *orig = src1;
+  ptrdiff_t offset = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i vorig = Load16Avx2(orig + x);
+      for (int i = 0; i < kNumCand; i++) {
+        __m256i diff =
+          _mm256_sub_epi16(vorig, Load16Avx2(src2[i] + offset + x));
+        __m256i absdiff = _mm256_abs_epi16(diff);
+        acc[i] = _mm256_add_epi32(acc[i], _mm256_madd_epi16(absdiff, ones));
+      }
+    }
+    orig += stride1;
+    offset += stride2;
+  }
+  for (int i = 0; i < kNumCand; i++) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc[i]),
+                                _mm256_extracti128_si256(acc[i], 1));
+    sad[i] = HorizontalSumSse2(sum);
+  }
+  if (width16 < width) {
+    SadX4Tail(width16, width, height, src1, stride1, src2, stride2, sad);
+  }
+}
+#endif  // XVC_ARCH_X86
+
+void SadSimd::Register(const std::set<CpuCapability> &caps,
+                       XVC_NAMESPACE::SimdFunctions *simd_functions) {
+#if XVC_ARCH_X86
+  auto &sad = simd_functions->sad;
+  if (caps.find(CpuCapability::kSse2) != caps.end()) {
+    sad.sad_sample = &SadX4Sse2<Sample>;
+    sad.sad_short = &SadX4Sse2<int16_t>;
+  }
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    sad.sad_sample = &SadX4Avx2<Sample>;
+    sad.sad_short = &SadX4Avx2<int16_t>;
+  }
+#endif  // XVC_ARCH_X86
+}
+
+}   // namespace simd
+}   // namespace XVC_NAMESPACE
@@ -26,7 +26,7 @@
 
 #include <string.h>
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 std::set<CpuCapability> SimdCpu::GetMaskedCaps(uint32_t mask) {
   const auto caps = GetRuntimeCapabilities();
@@ -181,4 +181,4 @@ std::set<CpuCapability> SimdCpu::GetRuntimeCapabilities() {
 
 #endif
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
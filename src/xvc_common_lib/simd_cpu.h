@@ -21,7 +21,9 @@
 
 #include <set>
 
-namespace xvc {
+#include "xvc_common_lib/common.h"
+
+namespace XVC_NAMESPACE {
 
 enum class CpuCapability {
   kNeon = 1,
@@ -43,6 +45,6 @@ struct SimdCpu {
   static std::set<CpuCapability> GetRuntimeCapabilities();
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_SIMD_CPU_H_
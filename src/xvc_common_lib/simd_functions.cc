@@ -18,17 +18,51 @@
 
 #include "xvc_common_lib/simd_functions.h"
 
+#include <cstdlib>
+
 #if defined(XVC_ARCH_ARM) || defined(XVC_ARCH_X86) || defined(XVC_ARCH_MIPS)
 #include "xvc_common_lib/simd/inter_prediction_simd.h"
+#include "xvc_common_lib/simd/sad_simd.h"
 #endif
 
-namespace xvc {
+namespace XVC_NAMESPACE {
+
+template<typename SampleT1>
+static void SadX4(int width, int height,
+                  const SampleT1 *src1, ptrdiff_t stride1,
+                  const Sample *const *src2, ptrdiff_t stride2,
+                  uint64_t *sad) {
+  const int kNumCand = SimdFunctions::SadFunc::kNumCand;
+  const Sample *cand[kNumCand];
+  for (int i = 0; i < kNumCand; i++) {
+    cand[i] = src2[i];
+    sad[i] = 0;
+  }
+  for (int y = 0; y < height; y++) {
+    for (int i = 0; i < kNumCand; i++) {
+      uint64_t sum = 0;
+      for (int x = 0; x < width; x++) {
+        sum += std::abs(src1[x] - cand[i][x]);
+      }
+      sad[i] += sum;
+      cand[i] += stride2;
+    }
+    src1 += stride1;
+  }
+}
+
+SimdFunctions::SadFunc::SadFunc()
+  : sad_sample(&SadX4<Sample>),
+  sad_short(&SadX4<int16_t>) {
+}
 
 SimdFunctions::SimdFunctions(const std::set<CpuCapability> &capabilities)
-  : inter_prediction() {
+  : inter_prediction(),
+  sad() {
 #if defined(XVC_ARCH_ARM) || defined(XVC_ARCH_X86) || defined(XVC_ARCH_MIPS)
   simd::InterPredictionSimd::Register(capabilities, this);
+  simd::SadSimd::Register(capabilities, this);
 #endif
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
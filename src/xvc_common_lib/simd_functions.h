@@ -25,14 +25,32 @@
 #include "xvc_common_lib/simd_cpu.h"
 #include "xvc_common_lib/inter_prediction.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 struct SimdFunctions {
+  struct SadFunc {
+    // Number of candidate blocks compared per call
+    static const int kNumCand = 4;
+
+    SadFunc();
+    // Sum of absolute differences between one block and kNumCand candidate
+    // blocks sharing the same stride, each original row is read only once
+    void(*sad_sample)(int width, int height,
+                      const Sample *src1, ptrdiff_t stride1,
+                      const Sample *const *src2, ptrdiff_t stride2,
+                      uint64_t *sad);
+    void(*sad_short)(int width, int height,
+                     const int16_t *src1, ptrdiff_t stride1,
+                     const Sample *const *src2, ptrdiff_t stride2,
+                     uint64_t *sad);
+  };
+
   explicit SimdFunctions(const std::set<CpuCapability> &capabilities);
 
   InterPrediction::SimdFunc inter_prediction;
+  SadFunc sad;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_SIMD_FUNCTIONS_H_
@@ -33,7 +33,7 @@
 #pragma warning(disable:4244)
 #endif
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 static const int16_t kInvTransform2[2][2] = {
   { 256, 256 },
@@ -414,56 +414,105 @@ std::array<std::array<uint8_t, 16>, 3> TransformHelper::kScanCoeff4x4 = { {
   { 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15 },
 } };
 
-void InverseTransform::Transform(int width, int height, bool is_luma_intra,
+// Direct matrix multiplication is cheaper than the partial butterflies when
+// only a few of the low frequency inputs are non-zero
+static bool UseSparseInvTransform(int size, int num_inputs) {
+  return size >= 8 && num_inputs * 4 <= size;
+}
+
+static const int16_t* GetInvTransformMatrix(int size) {
+  switch (size) {
+    case 8: return &kInvTransform8[0][0];
+    case 16: return &kInvTransform16[0][0];
+    case 32: return &kInvTransform32[0][0];
+    case 64: return &kInvTransform64[0][0];
+    default:
+      assert(0);
+      return nullptr;
+  }
+}
+
+void InverseTransform::Transform(int width, int height,
+                                 int extent_width, int extent_height,
+                                 bool is_luma_intra,
                                  const Coeff *coeff, ptrdiff_t coeff_stride,
                                  Residual *resi, ptrdiff_t resi_stride) {
+  const bool is_dst = width == 4 && height == 4 && is_luma_intra;
+  assert(extent_width <= width && extent_height <= height);
+  // Columns of zero coefficients give zero rows in the intermediate result
+  int num_lines = is_dst ? width : extent_width;
+  int num_inputs = extent_height;
+  if (height == 64 && constants::kZeroOutHighFreqLargeTransforms) {
+    num_lines = std::min(num_lines, 32);
+    num_inputs = std::min(num_inputs, 32);
+  }
   const int shift1 = 7 +
     (height >= 64 || height == 2 ? constants::kTransformExtendedPrecision : 0);
-  switch (height) {
-    case 2:
-      InvPartialTransform2(shift1, width, coeff, coeff_stride,
-                           &coeff_temp_[0], kBufferStride_);
-      break;
-    case 4:
-      if (width == 4 && is_luma_intra) {
-        InvPartialDST4(shift1, coeff, coeff_stride,
-                       &coeff_temp_[0], kBufferStride_);
-      } else {
-        InvPartialTransform4(shift1, width, coeff, coeff_stride,
+  if (UseSparseInvTransform(height, num_inputs)) {
+    InvPartialTransformSparse(shift1, height, num_inputs, num_lines,
+                              coeff, coeff_stride,
+                              &coeff_temp_[0], kBufferStride_);
+  } else {
+    switch (height) {
+      case 2:
+        InvPartialTransform2(shift1, num_lines, coeff, coeff_stride,
                              &coeff_temp_[0], kBufferStride_);
-      }
-      break;
-    case 8:
-      InvPartialTransform8(shift1, width, coeff, coeff_stride,
-                           &coeff_temp_[0], kBufferStride_);
-      break;
-    case 16:
-      InvPartialTransform16(shift1, width, coeff, coeff_stride,
-                            &coeff_temp_[0], kBufferStride_);
-      break;
-    case 32:
-      InvPartialTransform32(shift1, width, coeff, coeff_stride,
-                            &coeff_temp_[0], kBufferStride_);
-      break;
-    case 64:
-      InvPartialTransform64(shift1, width,
-                            constants::kZeroOutHighFreqLargeTransforms,
-                            coeff, coeff_stride,
-                            &coeff_temp_[0], kBufferStride_);
-      break;
-    default:
-      assert(0);
-      break;
+        break;
+      case 4:
+        if (is_dst) {
+          InvPartialDST4(shift1, coeff, coeff_stride,
+                         &coeff_temp_[0], kBufferStride_);
+        } else {
+          InvPartialTransform4(shift1, num_lines, coeff, coeff_stride,
+                               &coeff_temp_[0], kBufferStride_);
+        }
+        break;
+      case 8:
+        InvPartialTransform8(shift1, num_lines, coeff, coeff_stride,
+                             &coeff_temp_[0], kBufferStride_);
+        break;
+      case 16:
+        InvPartialTransform16(shift1, num_lines, coeff, coeff_stride,
+                              &coeff_temp_[0], kBufferStride_);
+        break;
+      case 32:
+        InvPartialTransform32(shift1, num_lines, coeff, coeff_stride,
+                              &coeff_temp_[0], kBufferStride_);
+        break;
+      case 64:
+        InvPartialTransform64(shift1, num_lines,
+                              constants::kZeroOutHighFreqLargeTransforms,
+                              coeff, coeff_stride,
+                              &coeff_temp_[0], kBufferStride_);
+        break;
+      default:
+        assert(0);
+        break;
+    }
   }
   const int shift2 = 20 - bitdepth_ +
     (width >= 64 || width == 2 ? constants::kTransformExtendedPrecision : 0);
+  num_inputs = num_lines;
+  if (width == 64 && constants::kZeroOutHighFreqLargeTransforms) {
+    num_inputs = std::min(num_inputs, 32);
+  }
+  if (UseSparseInvTransform(width, num_inputs)) {
+    InvPartialTransformSparse(shift2, width, num_inputs, height,
+                              &coeff_temp_[0], kBufferStride_,
+                              resi, resi_stride);
+    return;
+  }
+  // The partial butterflies read all inputs
+  for (int y = num_lines; y < width; y++) {
+    memset(&coeff_temp_[y * kBufferStride_], 0, sizeof(Coeff) * height);
+  }
   switch (width) {
     case 2:
       InvPartialTransform2(shift2, height, &coeff_temp_[0], kBufferStride_,
                            resi, resi_stride);
       break;
     case 4:
-      if (height == 4 && is_luma_intra) {
+      if (is_dst) {
         InvPartialDST4(shift2, &coeff_temp_[0], kBufferStride_, resi,
                        resi_stride);
       } else {
@@ -494,6 +543,55 @@ void InverseTransform::Transform(int width, int height, bool is_luma_intra,
   }
 }
 
+Residual InverseTransform::TransformDc(int width, int height,
+                                       Coeff dc_coeff) {
+  // Same rounding and clipping as the two partial butterflies
+  const int shift1 = 7 +
+    (height >= 64 || height == 2 ? constants::kTransformExtendedPrecision : 0);
+  const int shift2 = 20 - bitdepth_ +
+    (width >= 64 || width == 2 ? constants::kTransformExtendedPrecision : 0);
+  const int dc_basis1 = height >= 64 || height == 2 ? 256 : 64;
+  const int dc_basis2 = width >= 64 || width == 2 ? 256 : 64;
+  int tmp = util::Clip3((dc_basis1 * dc_coeff + (1 << (shift1 - 1))) >> shift1,
+                        constants::kInt16Min, constants::kInt16Max);
+  int resi = util::Clip3((dc_basis2 * tmp + (1 << (shift2 - 1))) >> shift2,
+                         constants::kInt16Min, constants::kInt16Max);
+  return static_cast<Residual>(resi);
+}
+
+void
+InverseTransform::InvPartialTransformSparse(int shift, int size,
+                                            int num_inputs, int lines,
+                                            const Coeff *in,
+                                            ptrdiff_t in_stride,
+                                            Coeff *out, ptrdiff_t out_stride) {
+  const int16_t *matrix = GetInvTransformMatrix(size);
+  const int add = 1 << (shift - 1);
+  int sum[constants::kMaxBlockSize];
+
+  for (int y = 0; y < lines; y++) {
+    for (int k = 0; k < size; k++) {
+      sum[k] = add;
+    }
+    for (int i = 0; i < num_inputs; i++) {
+      const int val = in[i * in_stride];
+      if (!val) {
+        continue;
+      }
+      const int16_t *basis = matrix + i * size;
+      for (int k = 0; k < size; k++) {
+        sum[k] += basis[k] * val;
+      }
+    }
+    for (int k = 0; k < size; k++) {
+      out[k] = util::Clip3(sum[k] >> shift,
+                           constants::kInt16Min, constants::kInt16Max);
+    }
+    in++;
+    out += out_stride;
+  }
+}
+
 void InverseTransform::InvPartialDST4(int shift,
                                       const Coeff *in, ptrdiff_t in_stride,
                                       Coeff *out, ptrdiff_t out_stride) {
@@ -974,6 +1072,23 @@ void ForwardTransform::Transform(int width, int height, bool is_luma_intra,
   }
 }
 
+int64_t ForwardTransform::GetMaxCoeffBound(int width, int height,
+                                           int64_t sum_abs_resi) const {
+  // Largest basis function magnitude per transform size (DST included)
+  auto max_basis = [](int size) {
+    return size == 2 ? 256 : (size == 4 ? 84 : (size == 8 ? 89 :
+                                                (size == 64 ? 362 : 90)));
+  };
+  const int shift1 = util::SizeToLog2(width) + bitdepth_ - 9 +
+    (width >= 64 || width == 2 ? constants::kTransformExtendedPrecision : 0);
+  const int shift2 = util::SizeToLog2(height) + 6 +
+    (height >= 64 || height == 2 ? constants::kTransformExtendedPrecision : 0);
+  // Each output of the first pass is bounded by its row sum, with rounding
+  const int64_t sum_abs_temp =
+    ((max_basis(width) * sum_abs_resi) >> shift1) + 1 + height;
+  return ((max_basis(height) * sum_abs_temp) >> shift2) + 1;
+}
+
 void ForwardTransform::FwdPartialDST4(int shift,
                                       const Coeff *in, ptrdiff_t in_stride,
                                       Coeff *out, ptrdiff_t out_stride) {
@@ -1405,4 +1520,28 @@ void TransformHelper::DeriveSubblockScan(ScanOrder scan_order, int width,
   }
 }
 
-}   // namespace xvc
+void TransformHelper::DeriveCoeffExtent(int width, int height,
+                                        const Coeff *coeff,
+                                        ptrdiff_t coeff_stride,
+                                        int *extent_width, int *extent_height) {
+  int max_x = -1;
+  int max_y = -1;
+  for (int y = 0; y < height; y++) {
+    for (int x = width - 1; x > max_x; x--) {
+      if (coeff[x]) {
+        max_x = x;
+        break;
+      }
+    }
+    for (int x = 0; x <= max_x && max_y < y; x++) {
+      if (coeff[x]) {
+        max_y = y;
+      }
+    }
+    coeff += coeff_stride;
+  }
+  *extent_width = max_x + 1;
+  *extent_height = max_y + 1;
+}
+
+}   // namespace XVC_NAMESPACE
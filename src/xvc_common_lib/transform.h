@@ -25,7 +25,7 @@
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 enum class ScanOrder : int {
   kDiagonal = 0,
@@ -38,7 +38,21 @@ class InverseTransform {
 public:
   explicit InverseTransform(int bitdepth) : bitdepth_(bitdepth) {}
   void Transform(int width, int height, bool is_luma_intra, const Coeff *coeff,
+                 ptrdiff_t coeff_stride, Residual *resi, ptrdiff_t resi_stride) {
+    Transform(width, height, width, height, is_luma_intra, coeff, coeff_stride,
+              resi, resi_stride);
+  }
+  // All non-zero coefficients must be within the top-left extent_width x
+  // extent_height area, columns outside of extent_width are never read
+  void Transform(int width, int height, int extent_width, int extent_height,
+                 bool is_luma_intra, const Coeff *coeff,
                  ptrdiff_t coeff_stride, Residual *resi, ptrdiff_t resi_stride);
+  // Residual of a block where only the dc coefficient can be non-zero,
+  // all samples get the same value except for 4x4 luma intra (dst)
+  static bool IsDcConstant(int width, int height, bool is_luma_intra) {
+    return !(width == 4 && height == 4 && is_luma_intra);
+  }
+  Residual TransformDc(int width, int height, Coeff dc_coeff);
 
 private:
   static const ptrdiff_t kBufferStride_ = constants::kMaxBlockSize;
@@ -62,6 +76,10 @@ private:
   void InvPartialTransform64(int shift, int lines, bool skip_full_height,
                              const Coeff *in, ptrdiff_t in_stride,
                              Coeff *out, ptrdiff_t out_stride);
+  void InvPartialTransformSparse(int shift, int size, int num_inputs,
+                                 int lines,
+                                 const Coeff *in, ptrdiff_t in_stride,
+                                 Coeff *out, ptrdiff_t out_stride);
 
   int bitdepth_;
   std::array<Coeff, kBufferStride_ * kBufferStride_> coeff_temp_;
@@ -69,10 +87,17 @@ private:
 
 class ForwardTransform {
 public:
-  explicit ForwardTransform(int bitdepth) : bitdepth_(bitdepth) {}
+  // Temporary buffer is cleared since zeroed out high frequency rows of
+  // size 64 transforms are never written but still read by the second pass
+  explicit ForwardTransform(int bitdepth)
+    : bitdepth_(bitdepth), coeff_temp_() {
+  }
   void Transform(int width, int height, bool is_luma_intra,
                  const Residual *resi, ptrdiff_t resi_stride,
                  Coeff *coeff, ptrdiff_t coeff_stride);
+  // Upper bound of the magnitude of any output coefficient given the sum of
+  // absolute residual values
+  int64_t GetMaxCoeffBound(int width, int height, int64_t sum_abs_resi) const;
 
 private:
   static const ptrdiff_t kBufferStride_ = constants::kMaxBlockSize;
@@ -113,6 +138,9 @@ public:
                                       YuvComponent comp);
   static void DeriveSubblockScan(ScanOrder scan_order, int width,
                                  int height, uint16_t *scan_table);
+  static void DeriveCoeffExtent(int width, int height, const Coeff *coeff,
+                                ptrdiff_t coeff_stride, int *extent_width,
+                                int *extent_height);
   static const uint8_t* GetCoeffScanTable2x2(ScanOrder scan_order) {
     return &kScanCoeff2x2[static_cast<int>(scan_order)][0];
   }
@@ -121,6 +149,6 @@ public:
   }
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_TRANSFORM_H_
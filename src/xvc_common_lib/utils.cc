@@ -18,7 +18,7 @@
 
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 namespace util {
 
@@ -134,4 +134,4 @@ int ScaleChromaY(int size, ChromaFormat chroma_format) {
 
 }  // namespace util
 
-}  // namespace xvc
+}  // namespace XVC_NAMESPACE
@@ -24,7 +24,7 @@
 
 #include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 namespace util {
 
@@ -90,6 +90,6 @@ inline int GetNumComponents(ChromaFormat chroma_fmt) {
 
 }   // namespace util
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_UTILS_H_
@@ -20,7 +20,7 @@
 
 #include <cstring>
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 namespace util {
 
 static void MD5Transform(uint32_t buf[4], uint32_t const in[16]);
@@ -219,4 +219,4 @@ static void MD5Transform(uint32_t buf[4], uint32_t const in[16]) {
 }
 
 }   // namespace util
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -21,7 +21,9 @@
 
 #include <stdint.h>
 
-namespace xvc {
+#include "xvc_common_lib/common.h"
+
+namespace XVC_NAMESPACE {
 namespace util {
 
 class MD5 {
@@ -38,6 +40,6 @@ private:
 };
 
 }   // namespace util
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_UTILS_MD5_H_
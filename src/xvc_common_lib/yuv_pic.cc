@@ -24,7 +24,7 @@
 #include "xvc_common_lib/resample.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 const int kColorConversionBitdepth = 12;
 
@@ -469,4 +469,4 @@ void YuvPicture::ConvertColorSpace8bit709(uint8_t *dst, int width, int height,
   }
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
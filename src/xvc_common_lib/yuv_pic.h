@@ -24,7 +24,7 @@
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/sample_buffer.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class YuvPicture {
 public:
@@ -86,6 +86,6 @@ private:
   Sample *comp_pel_[constants::kMaxYuvComponents];
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_COMMON_LIB_YUV_PIC_H_
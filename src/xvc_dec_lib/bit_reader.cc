@@ -23,70 +23,75 @@
 #include <cstring>
 #include <stdexcept>
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 size_t BitReader::GetPosition() const {
-  assert(bit_mask_ == 0x80);
-  return consumed_;
-}
-
-int BitReader::ReadBit() {
-  int val = buffer_[consumed_] & bit_mask_;
-  bit_mask_ >>= 1;
-  if (!bit_mask_) {
-    bit_mask_ = 0x80;
-    assert(consumed_ < length_);
-    if (consumed_ < length_) {
-      consumed_++;
-    }
-  }
-  return val ? 1 : 0;
-}
-
-uint32_t BitReader::ReadBits(int num_bits) {
-  uint32_t bits = 0;
-  while (num_bits) {
-    bits |= ReadBit() << (num_bits - 1);
-    num_bits--;
-  }
-  return bits;
+  assert((cache_bits_ & 7) == 0);
+  return consumed_ - (cache_bits_ >> 3);
 }
 
 void BitReader::SkipBits() {
-  if (bit_mask_ != 0x80) {
-    bit_mask_ = 0x80;
-    assert(consumed_ < length_);
-    if (consumed_ < length_) {
-      consumed_++;
-    }
-  }
-}
-
-uint8_t BitReader::ReadByte() {
-  assert(consumed_ < length_);
-  if (consumed_ >= length_) {
-    throw std::runtime_error("corrupt bitstream");
-  }
-  return buffer_[consumed_++];
+  int num_bits = cache_bits_ & 7;
+  cache_ <<= num_bits;
+  cache_bits_ -= num_bits;
 }
 
 void BitReader::ReadBytes(uint8_t *bytes, size_t len) {
+  SetBitPosition(GetPosition() << 3);
   assert(consumed_ < length_);
   assert(consumed_ + len <= length_);
-  size_t tocopy = std::min(len, length_ - consumed_);
+  size_t tocopy = consumed_ < length_ ? std::min(len, length_ - consumed_) : 0;
   std::memcpy(bytes, &buffer_[consumed_], tocopy);
   consumed_ += tocopy;
 }
 
 void BitReader::Rewind(int num_bits) {
-  while (num_bits--) {
-    bit_mask_ <<= 1;
-    if (bit_mask_ == 0x100) {
-      bit_mask_ = 0x1;
-      assert(consumed_ > 0);
-      --consumed_;
+  size_t bit_position = (consumed_ << 3) - cache_bits_;
+  assert(bit_position >= static_cast<size_t>(num_bits));
+  SetBitPosition(bit_position - num_bits);
+}
+
+void BitReader::Refill() {
+  if (consumed_ + sizeof(uint64_t) <= length_) {
+    // Fast path, load a full word and keep the whole bytes that fit
+    uint64_t word = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      word = (word << 8) | buffer_[consumed_ + i];
+    }
+    int num_bytes = (64 - cache_bits_) >> 3;
+    int total_bits = cache_bits_ + (num_bytes << 3);
+    uint64_t bits = word >> cache_bits_;
+    if (total_bits < 64) {
+      bits &= ~0ULL << (64 - total_bits);
     }
+    cache_ |= bits;
+    cache_bits_ = total_bits;
+    consumed_ += num_bytes;
+    return;
+  }
+  // Guarded path near end of buffer
+  while (cache_bits_ <= 56) {
+    uint64_t byte = consumed_ < length_ ? buffer_[consumed_] : 0;
+    cache_ |= byte << (56 - cache_bits_);
+    cache_bits_ += 8;
+    consumed_++;
   }
 }
 
-}   // namespace xvc
+uint8_t BitReader::ReadByteSlow() {
+  // Cache might contain zero padding from beyond the end of buffer
+  if ((consumed_ << 3) - cache_bits_ + 8 > (length_ << 3)) {
+    assert(0);
+    throw std::runtime_error("corrupt bitstream");
+  }
+  return static_cast<uint8_t>(ReadBits(8));
+}
+
+void BitReader::SetBitPosition(size_t bit_position) {
+  consumed_ = bit_position >> 3;
+  cache_ = 0;
+  cache_bits_ = 0;
+  ReadBits(static_cast<int>(bit_position & 7));
+}
+
+}   // namespace XVC_NAMESPACE
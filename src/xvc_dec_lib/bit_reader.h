@@ -19,12 +19,13 @@
 #ifndef XVC_DEC_LIB_BIT_READER_H_
 #define XVC_DEC_LIB_BIT_READER_H_
 
+#include <cassert>
 #include <fstream>
 #include <vector>
 
 #include "xvc_common_lib/common.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class BitReader {
 public:
@@ -33,22 +34,42 @@ public:
   }
 
   size_t GetPosition() const;
-  int ReadBit();
-  uint32_t ReadBits(int num_bits);
+  int ReadBit() { return static_cast<int>(ReadBits(1)); }
+  uint32_t ReadBits(int num_bits) {
+    assert(num_bits <= 32);
+    if (num_bits > cache_bits_) {
+      Refill();
+    }
+    uint32_t bits = num_bits == 0 ? 0 :
+      static_cast<uint32_t>(cache_ >> (64 - num_bits));
+    cache_ <<= num_bits;
+    cache_bits_ -= num_bits;
+    return bits;
+  }
   void SkipBits();
-  uint8_t ReadByte();
+  uint8_t ReadByte() {
+    // Byte aligned reads with empty cache are used by the entropy decoder
+    if (cache_bits_ == 0 && consumed_ < length_) {
+      return buffer_[consumed_++];
+    }
+    return ReadByteSlow();
+  }
   void ReadBytes(uint8_t *bytes, size_t len);
   void Rewind(int num_bits);
 
 private:
   void Refill();
+  uint8_t ReadByteSlow();
+  void SetBitPosition(size_t bit_position);
 
-  int bit_mask_ = 0x80;
+  // Bits are cached msb first, reading beyond the end of buffer gives zeros
+  uint64_t cache_ = 0;
+  int cache_bits_ = 0;
   size_t consumed_ = 0;
   const uint8_t *buffer_ = nullptr;
   size_t length_ = 0;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif    // XVC_DEC_LIB_BIT_READER_H_
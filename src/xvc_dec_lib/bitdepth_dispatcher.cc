@@ -0,0 +1,566 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_dec_lib/bitdepth_dispatcher.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/simd_cpu.h"
+#include "xvc_dec_lib/bit_reader.h"
+#include "xvc_dec_lib/decoder.h"
+#include "xvc_dec_lib/segment_header_reader.h"
+
+namespace xvc {
+
+class BitdepthDispatcher : public xvc_decoder {
+public:
+  explicit BitdepthDispatcher(const xvc_decoder_parameters &params)
+    : params_(params) {
+  }
+  xvc_dec_return_code DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
+                                int64_t user_data);
+  xvc_dec_return_code GetDecodedPicture(xvc_decoded_picture *output_pic);
+  xvc_dec_return_code Flush();
+  void UpdateParameters(const xvc_decoder_parameters &params);
+  int GetNumCorruptedPics();
+
+private:
+  struct Instance {
+    Instance(BitdepthDispatcher *disp, const xvc_decoder_api *decoder_api)
+      : dispatcher(disp), api(decoder_api) {
+    }
+    ~Instance();
+    xvc_dec_return_code DecodeNal(const uint8_t *nal_unit,
+                                  size_t nal_unit_size, int64_t user_data);
+    BitdepthDispatcher *dispatcher;
+    const xvc_decoder_api *api;
+    xvc_decoder *decoder = nullptr;
+    // Follows the segment counter of the decoder
+    SegmentNum soc = static_cast<SegmentNum>(-1);
+    // Picture numbering of each instance starts from zero, the offsets are
+    // derived from its first output picture
+    bool aligned = false;
+    uint32_t poc_offset = 0;
+    uint32_t doc_offset = 0;
+    uint32_t soc_offset = 0;
+    // Started at the intra access picture of an open gop segment boundary,
+    // which is output with the doc it has before the previous tail pictures
+    bool tail_boundary_start = false;
+    bool has_first_doc = false;
+    uint32_t first_doc = 0;
+    // Ended by the tail pictures of its last segment, the intra access
+    // picture they reference is output by the next instance instead
+    bool tail_boundary_end = false;
+    SegmentNum tail_boundary_soc = 0;
+  };
+  static void OnInstanceOutput(void *opaque, const xvc_decoded_picture *pic);
+  xvc_dec_return_code DecodeSegmentHeader(const uint8_t *nal_unit,
+                                          size_t nal_unit_size,
+                                          int64_t user_data,
+                                          BitReader *bit_reader);
+  xvc_dec_return_code SwitchAtIntraAccessPicture(const uint8_t *nal_unit,
+                                                 size_t nal_unit_size,
+                                                 int64_t user_data);
+  bool DecodeTailPictures(const uint8_t *nal_unit, size_t nal_unit_size,
+                          int64_t user_data);
+  xvc_dec_return_code CompletePendingSwitch();
+  void SwitchDecoder(const xvc_decoder_api *api);
+  bool PrepareOutput(Instance *instance, xvc_decoded_picture *pic);
+
+  xvc_decoder_parameters params_;
+  // Updated when instances are destroyed
+  int num_corrupted_pics_released_ = 0;
+  std::unique_ptr<Instance> active_;
+  // Decoders of previous segments that still have pictures to output
+  std::deque<std::unique_ptr<Instance>> draining_;
+  // Current segment of the active instance
+  bool segment_valid_ = false;
+  SegmentHeader segment_header_;
+  // Tail pictures of an open gop segment are sent before the next segment
+  // header, but are decoded after its intra access picture
+  int num_tail_pics_ = 0;
+  // Segment header of another bitdepth that follows tail pictures, the
+  // decoder is switched at its intra access picture
+  bool switch_pending_ = false;
+  const xvc_decoder_api *pending_api_ = nullptr;
+  SegmentHeader pending_segment_header_;
+  std::vector<uint8_t> pending_header_nal_;
+  int64_t pending_header_user_data_ = 0;
+  // Intra access picture of the last open gop switch, as decoded by the
+  // previous instance
+  bool has_boundary_pic_ = false;
+  xvc_dec_pic_stats boundary_pic_;
+  // Stream numbering of the output so far
+  bool any_output_ = false;
+  xvc_dec_pic_stats last_output_;
+  uint32_t max_output_doc_ = 0;
+};
+
+BitdepthDispatcher::Instance::~Instance() {
+  if (!decoder) {
+    return;
+  }
+  int num = 0;
+  api->decoder_check_conformance(decoder, &num);
+  dispatcher->num_corrupted_pics_released_ += num;
+  api->decoder_destroy(decoder);
+}
+
+xvc_dec_return_code
+BitdepthDispatcher::Instance::DecodeNal(const uint8_t *nal_unit,
+                                        size_t nal_unit_size,
+                                        int64_t user_data) {
+  return api->decoder_decode_nal(decoder, nal_unit, nal_unit_size, user_data);
+}
+
+xvc_dec_return_code
+BitdepthDispatcher::DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
+                              int64_t user_data) {
+  BitReader bit_reader(nal_unit, nal_unit_size);
+  uint8_t header = bit_reader.ReadByte();
+  int nal_rfe = ((header >> 6) & 3);
+  bool valid_header = true;
+  if (nal_rfe > 0) {
+    if (header == constants::kEncapsulationCode1 ||
+        header == constants::kEncapsulationCode2) {
+      bit_reader.ReadByte();
+      header = bit_reader.ReadByte();
+    } else {
+      valid_header = false;
+    }
+  }
+  const NalUnitType nal_unit_type = NalUnitType((header >> 1) & 31);
+  if (valid_header && nal_unit_type == NalUnitType::kSegmentHeader) {
+    return DecodeSegmentHeader(nal_unit, nal_unit_size, user_data,
+                               &bit_reader);
+  }
+  if (!active_) {
+    return XVC_DEC_NO_SEGMENT_HEADER_DECODED;
+  }
+  const bool picture_nal = valid_header &&
+    nal_unit_type >= NalUnitType::kIntraPicture &&
+    nal_unit_type <= NalUnitType::kReservedPictureType10;
+  const bool buffer_flag = picture_nal && bit_reader.ReadBit() != 0;
+  if (switch_pending_) {
+    if (nal_unit_type == NalUnitType::kIntraAccessPicture && picture_nal &&
+        !buffer_flag) {
+      return SwitchAtIntraAccessPicture(nal_unit, nal_unit_size, user_data);
+    }
+    // Without the intra access picture the tail pictures are discarded
+    CompletePendingSwitch();
+  }
+  if (buffer_flag) {
+    num_tail_pics_++;
+  }
+  return active_->DecodeNal(nal_unit, nal_unit_size, user_data);
+}
+
+xvc_dec_return_code
+BitdepthDispatcher::GetDecodedPicture(xvc_decoded_picture *output_pic) {
+  // Remaining pictures of previous segments are output first
+  while (!draining_.empty()) {
+    Instance *instance = draining_.front().get();
+    while (instance->api->decoder_get_picture(instance->decoder,
+                                              output_pic) == XVC_DEC_OK) {
+      if (PrepareOutput(instance, output_pic)) {
+        return XVC_DEC_OK;
+      }
+    }
+    draining_.pop_front();
+  }
+  if (!active_) {
+    return XVC_DEC_NO_SEGMENT_HEADER_DECODED;
+  }
+  xvc_dec_return_code ret;
+  while ((ret = active_->api->decoder_get_picture(active_->decoder,
+                                                  output_pic)) == XVC_DEC_OK) {
+    if (PrepareOutput(active_.get(), output_pic)) {
+      return XVC_DEC_OK;
+    }
+  }
+  return ret;
+}
+
+xvc_dec_return_code BitdepthDispatcher::Flush() {
+  if (switch_pending_) {
+    CompletePendingSwitch();
+  }
+  if (!active_) {
+    return XVC_DEC_OK;
+  }
+  // Tail pictures of an open gop segment are discarded by the flush
+  num_tail_pics_ = 0;
+  active_->soc++;
+  return active_->api->decoder_flush(active_->decoder);
+}
+
+void BitdepthDispatcher::UpdateParameters(
+  const xvc_decoder_parameters &params) {
+  // Same subset of parameters as for a single decoder instance
+  params_.max_framerate = params.max_framerate;
+  params_.real_time = params.real_time;
+  for (auto &instance : draining_) {
+    instance->api->decoder_update_parameters(instance->decoder, &params_);
+  }
+  if (active_) {
+    active_->api->decoder_update_parameters(active_->decoder, &params_);
+  }
+}
+
+int BitdepthDispatcher::GetNumCorruptedPics() {
+  int num_corrupted_pics = num_corrupted_pics_released_;
+  for (auto &instance : draining_) {
+    int num = 0;
+    instance->api->decoder_check_conformance(instance->decoder, &num);
+    num_corrupted_pics += num;
+  }
+  if (active_) {
+    int num = 0;
+    active_->api->decoder_check_conformance(active_->decoder, &num);
+    num_corrupted_pics += num;
+  }
+  return num_corrupted_pics;
+}
+
+void BitdepthDispatcher::OnInstanceOutput(void *opaque,
+                                          const xvc_decoded_picture *pic) {
+  Instance *instance = reinterpret_cast<Instance*>(opaque);
+  BitdepthDispatcher *dispatcher = instance->dispatcher;
+  xvc_decoded_picture output_pic = *pic;
+  if (dispatcher->PrepareOutput(instance, &output_pic)) {
+    dispatcher->params_.output_callback(
+      dispatcher->params_.output_callback_opaque, &output_pic);
+  }
+}
+
+xvc_dec_return_code
+BitdepthDispatcher::DecodeSegmentHeader(const uint8_t *nal_unit,
+                                        size_t nal_unit_size,
+                                        int64_t user_data,
+                                        BitReader *bit_reader) {
+  if (switch_pending_) {
+    CompletePendingSwitch();
+  }
+  SegmentHeader segment_header;
+  Decoder::State state =
+    SegmentHeaderReader::Read(&segment_header, bit_reader, 0);
+  const bool valid = state == Decoder::State::kSegmentHeaderDecoded;
+  // Errors are reported by the decoder with highest bitdepth support
+  const xvc_decoder_api *api =
+    valid && segment_header.internal_bitdepth <= 8 ?
+    xvc_decoder_api_get_8bit() : xvc_decoder_api_get_16bit();
+  const bool tail_pics =
+    segment_valid_ && segment_header_.open_gop && num_tail_pics_ > 0;
+  num_tail_pics_ = 0;
+  if (active_ && api != active_->api && tail_pics && valid) {
+    // The tail pictures of the current segment reference the intra access
+    // picture of the new segment, which is needed before switching
+    switch_pending_ = true;
+    pending_api_ = api;
+    pending_segment_header_ = segment_header;
+    pending_header_nal_.assign(nal_unit, nal_unit + nal_unit_size);
+    pending_header_user_data_ = user_data;
+    return XVC_DEC_OK;
+  }
+  if (!active_ || api != active_->api) {
+    if (active_) {
+      // Pictures of the previous segment are output before the new segment
+      active_->api->decoder_flush(active_->decoder);
+    }
+    SwitchDecoder(api);
+  }
+  segment_valid_ = valid;
+  segment_header_ = segment_header;
+  active_->soc++;
+  return active_->DecodeNal(nal_unit, nal_unit_size, user_data);
+}
+
+xvc_dec_return_code
+BitdepthDispatcher::SwitchAtIntraAccessPicture(const uint8_t *nal_unit,
+                                               size_t nal_unit_size,
+                                               int64_t user_data) {
+  if (DecodeTailPictures(nal_unit, nal_unit_size, user_data)) {
+    active_->tail_boundary_end = true;
+    active_->tail_boundary_soc = active_->soc;
+  } else {
+    active_->api->decoder_flush(active_->decoder);
+  }
+  switch_pending_ = false;
+  SwitchDecoder(pending_api_);
+  active_->tail_boundary_start = true;
+  segment_valid_ = true;
+  segment_header_ = pending_segment_header_;
+  active_->soc++;
+  active_->DecodeNal(&pending_header_nal_[0], pending_header_nal_.size(),
+                     pending_header_user_data_);
+  return active_->DecodeNal(nal_unit, nal_unit_size, user_data);
+}
+
+bool BitdepthDispatcher::DecodeTailPictures(const uint8_t *nal_unit,
+                                            size_t nal_unit_size,
+                                            int64_t user_data) {
+  // The tail pictures are decoded by the instance of their own segment,
+  // only the intra access picture they reference is decoded twice
+  Instance *instance = active_.get();
+  if (instance->api == xvc_decoder_api_get_16bit()) {
+    instance->soc++;
+    instance->DecodeNal(&pending_header_nal_[0], pending_header_nal_.size(),
+                        pending_header_user_data_);
+    instance->DecodeNal(nal_unit, nal_unit_size, user_data);
+    reinterpret_cast<Decoder*>(instance->decoder)->FlushTailPictures();
+    return true;
+  }
+  // Intra access picture of high bitdepth, converted by a 16bit decoder to
+  // the format of the 8bit tail pictures in the same way as when decoded
+  // by a single decoder
+  Decoder decoder(0);
+  decoder.SetCpuCapabilities(SimdCpu::GetMaskedCaps(params_.simd_mask));
+  decoder.DecodeNal(&pending_header_nal_[0], pending_header_nal_.size());
+  decoder.DecodeNal(nal_unit, nal_unit_size);
+  std::vector<uint8_t> pic_bytes;
+  if (!decoder.GetReferencePicture(segment_header_, &pic_bytes) ||
+      xvc_decoder_flush_tail_pictures_8bit(instance->decoder, nal_unit,
+                                           nal_unit_size, user_data,
+                                           &pic_bytes[0]) != XVC_DEC_OK) {
+    return false;
+  }
+  instance->soc++;
+  return true;
+}
+
+xvc_dec_return_code BitdepthDispatcher::CompletePendingSwitch() {
+  switch_pending_ = false;
+  active_->api->decoder_flush(active_->decoder);
+  SwitchDecoder(pending_api_);
+  segment_valid_ = true;
+  segment_header_ = pending_segment_header_;
+  active_->soc++;
+  return active_->DecodeNal(&pending_header_nal_[0],
+                            pending_header_nal_.size(),
+                            pending_header_user_data_);
+}
+
+void BitdepthDispatcher::SwitchDecoder(const xvc_decoder_api *api) {
+  if (active_) {
+    draining_.push_back(std::move(active_));
+  }
+  active_.reset(new Instance(this, api));
+  xvc_decoder_parameters params = params_;
+  if (params_.output_callback) {
+    params.output_callback = &BitdepthDispatcher::OnInstanceOutput;
+    params.output_callback_opaque = active_.get();
+  }
+  active_->decoder = api->decoder_create(&params);
+}
+
+bool BitdepthDispatcher::PrepareOutput(Instance *instance,
+                                       xvc_decoded_picture *pic) {
+  xvc_dec_pic_stats &stats = pic->stats;
+  if (!instance->aligned) {
+    if (instance->tail_boundary_start && has_boundary_pic_) {
+      // Continues from the intra access picture, the doc of later pictures
+      // follows the tail pictures that have been output before
+      instance->poc_offset = boundary_pic_.poc - stats.poc;
+      instance->doc_offset = max_output_doc_ - stats.doc;
+      instance->soc_offset = boundary_pic_.soc - stats.soc;
+      instance->has_first_doc = true;
+      instance->first_doc = boundary_pic_.doc;
+      has_boundary_pic_ = false;
+    } else if (any_output_) {
+      // Otherwise numbering continues after the last output picture
+      instance->poc_offset = last_output_.poc + 1 - stats.poc;
+      instance->doc_offset = max_output_doc_ + 1 - stats.doc;
+      instance->soc_offset = last_output_.soc + 1 - stats.soc;
+    }
+    instance->aligned = true;
+  }
+  const bool boundary_pic = instance->tail_boundary_end &&
+    stats.soc == instance->tail_boundary_soc;
+  stats.poc += instance->poc_offset;
+  stats.doc = instance->has_first_doc ?
+    instance->first_doc : stats.doc + instance->doc_offset;
+  stats.soc += instance->soc_offset;
+  instance->has_first_doc = false;
+  if (boundary_pic) {
+    // Intra access picture only decoded as reference for tail pictures
+    boundary_pic_ = stats;
+    has_boundary_pic_ = true;
+    return false;
+  }
+  any_output_ = true;
+  last_output_ = stats;
+  max_output_doc_ = std::max(max_output_doc_, stats.doc);
+  return true;
+}
+
+}   // namespace xvc
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  static xvc_decoder_parameters* xvc_dispatch_parameters_create() {
+    return xvc_decoder_api_get_16bit()->parameters_create();
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_parameters_destroy(xvc_decoder_parameters *param) {
+    return xvc_decoder_api_get_16bit()->parameters_destroy(param);
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_parameters_set_default(xvc_decoder_parameters *param) {
+    return xvc_decoder_api_get_16bit()->parameters_set_default(param);
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_parameters_check(xvc_decoder_parameters *param) {
+    return xvc_decoder_api_get_16bit()->parameters_check(param);
+  }
+
+  static xvc_decoded_picture*
+    xvc_dispatch_picture_create(xvc_decoder *decoder) {
+    return xvc_decoder_api_get_16bit()->picture_create(decoder);
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_picture_destroy(xvc_decoded_picture *picture) {
+    return xvc_decoder_api_get_16bit()->picture_destroy(picture);
+  }
+
+  static xvc_decoder*
+    xvc_dispatch_decoder_create(xvc_decoder_parameters *param) {
+    if (xvc_dispatch_parameters_check(param) != XVC_DEC_OK) {
+      return nullptr;
+    }
+    return new xvc::BitdepthDispatcher(*param);
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_decoder_destroy(xvc_decoder *decoder) {
+    if (decoder) {
+      delete reinterpret_cast<xvc::BitdepthDispatcher*>(decoder);
+    }
+    return XVC_DEC_OK;
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_decoder_update_parameters(xvc_decoder *decoder,
+                                           xvc_decoder_parameters *param) {
+    if (xvc_dispatch_parameters_check(param) != XVC_DEC_OK) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    reinterpret_cast<xvc::BitdepthDispatcher*>(decoder)->
+      UpdateParameters(*param);
+    return XVC_DEC_OK;
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_decoder_decode_nal(xvc_decoder *decoder,
+                                    const uint8_t *nal_unit,
+                                    size_t nal_unit_size, int64_t user_data) {
+    if (!decoder || !nal_unit || nal_unit_size < 1) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    return reinterpret_cast<xvc::BitdepthDispatcher*>(decoder)->
+      DecodeNal(nal_unit, nal_unit_size, user_data);
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_decoder_get_picture(xvc_decoder *decoder,
+                                     xvc_decoded_picture *pic_bytes) {
+    if (!decoder || !pic_bytes) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    return reinterpret_cast<xvc::BitdepthDispatcher*>(decoder)->
+      GetDecodedPicture(pic_bytes);
+  }
+
+  static xvc_dec_return_code xvc_dispatch_decoder_flush(xvc_decoder *decoder) {
+    if (!decoder) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    return reinterpret_cast<xvc::BitdepthDispatcher*>(decoder)->Flush();
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_decoder_check_conformance(xvc_decoder *decoder,
+                                           int *out_num) {
+    if (!decoder) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    int num_corrupted =
+      reinterpret_cast<xvc::BitdepthDispatcher*>(decoder)->
+      GetNumCorruptedPics();
+    if (out_num) {
+      *out_num = num_corrupted;
+    }
+    if (num_corrupted > 0) {
+      return XVC_DEC_NOT_CONFORMING;
+    }
+    return XVC_DEC_OK;
+  }
+
+  static const char*
+    xvc_dispatch_get_error_text(xvc_dec_return_code error_code) {
+    return xvc_decoder_api_get_16bit()->xvc_dec_get_error_text(error_code);
+  }
+
+  static xvc_decoder_thread_pool*
+    xvc_dispatch_thread_pool_create(int num_threads) {
+    // The same pool is used by decoders of all bitdepths
+    return xvc_decoder_api_get_16bit()->thread_pool_create(num_threads);
+  }
+
+  static xvc_dec_return_code
+    xvc_dispatch_thread_pool_destroy(xvc_decoder_thread_pool *thread_pool) {
+    return xvc_decoder_api_get_16bit()->thread_pool_destroy(thread_pool);
+  }
+
+  static const xvc_decoder_api xvc_dec_api_dispatch = {
+    &xvc_dispatch_parameters_create,
+    &xvc_dispatch_parameters_destroy,
+    &xvc_dispatch_parameters_set_default,
+    &xvc_dispatch_parameters_check,
+    &xvc_dispatch_picture_create,
+    &xvc_dispatch_picture_destroy,
+    &xvc_dispatch_decoder_create,
+    &xvc_dispatch_decoder_destroy,
+    &xvc_dispatch_decoder_update_parameters,
+    &xvc_dispatch_decoder_decode_nal,
+    &xvc_dispatch_decoder_get_picture,
+    &xvc_dispatch_decoder_flush,
+    &xvc_dispatch_decoder_check_conformance,
+    &xvc_dispatch_get_error_text,
+    &xvc_dispatch_thread_pool_create,
+    &xvc_dispatch_thread_pool_destroy,
+  };
+
+  const xvc_decoder_api* xvc_decoder_api_get() {
+    return &xvc_dec_api_dispatch;
+  }
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -0,0 +1,54 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_DEC_LIB_BITDEPTH_DISPATCHER_H_
+#define XVC_DEC_LIB_BITDEPTH_DISPATCHER_H_
+
+#include "xvc_dec_lib/xvcdec.h"
+
+// In high bitdepth builds the decoder is also built with 8bit sample
+// storage. The public api then forwards each segment to the decoder with
+// the smallest sample type that can represent its internal bitdepth. Open gop
+// tail pictures are decoded by the decoder of their own segment, which is
+// given the intra access picture of the next segment before switching.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // Decoder built with 8bit samples (only for bitstreams of 8bit bitdepth)
+  const xvc_decoder_api* xvc_decoder_api_get_8bit();
+
+  // Decoder built with 16bit samples
+  const xvc_decoder_api* xvc_decoder_api_get_16bit();
+
+  // Decodes the tail pictures of the current segment of an 8bit decoder,
+  // given the intra access picture of the next segment with samples already
+  // converted to the format of the current segment, and then flushes
+  xvc_dec_return_code
+    xvc_decoder_flush_tail_pictures_8bit(xvc_decoder *decoder,
+                                         const uint8_t *nal_unit,
+                                         size_t nal_unit_size,
+                                         int64_t user_data,
+                                         const uint8_t *pic_bytes);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // XVC_DEC_LIB_BITDEPTH_DISPATCHER_H_
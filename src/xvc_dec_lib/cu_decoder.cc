@@ -23,7 +23,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 CuDecoder::CuDecoder(const SimdFunctions &simd, const Qp &pic_qp,
                      YuvPicture *decoded_pic, PictureData *pic_data)
@@ -88,6 +88,10 @@ void CuDecoder::DecompressCu(CodingUnit *cu) {
     }
   } else {
     pic_data_.MarkUsedInPic(cu);
+    if (cu->IsInter()) {
+      // Motion vectors are shared by all components
+      inter_pred_.CalculateMV(cu);
+    }
     for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
       DecompressComponent(cu, comp, cu->GetQp());
     }
@@ -101,8 +105,14 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
   int width = cu->GetWidth(comp);
   int height = cu->GetHeight(comp);
   bool cbf = cu->GetCbf(comp);
+  const bool is_luma_intra = util::IsLuma(comp) && cu->IsIntra();
+  // Blocks without residual or with only a dc coefficient (constant
+  // residual) are predicted directly into the decoded picture
+  const bool dc_only = cbf && cu->GetCoeffExtentWidth(comp) <= 1 &&
+    cu->GetCoeffExtentHeight(comp) <= 1 &&
+    InverseTransform::IsDcConstant(width, height, is_luma_intra);
   SampleBuffer dec_buffer = decoded_pic_.GetSampleBuffer(comp, cu_x, cu_y);
-  SampleBuffer &pred_buffer = cbf ? temp_pred_ : dec_buffer;
+  SampleBuffer &pred_buffer = cbf && !dc_only ? temp_pred_ : dec_buffer;
 
   // Predict
   if (cu->IsIntra()) {
@@ -112,7 +122,6 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
     intra_pred_.Predict(intra_mode, *cu, comp, dec, dec_stride,
                         pred_buffer.GetDataPtr(), pred_buffer.GetStride());
   } else {
-    inter_pred_.CalculateMV(cu);
     inter_pred_.MotionCompensation(*cu, comp, pred_buffer.GetDataPtr(),
                                    pred_buffer.GetStride());
   }
@@ -120,15 +129,28 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
     return;
   }
 
-  // Dequant
   CoeffBuffer cu_coeff_buf = cu->GetCoeff(comp);
+  if (dc_only) {
+    Coeff dc_coeff =
+      quantize_.InverseDc(comp, qp, width, height, decoded_pic_.GetBitdepth(),
+                          *cu_coeff_buf.GetDataPtr());
+    Residual dc_resi = inv_transform_.TransformDc(width, height, dc_coeff);
+    if (dc_resi != 0) {
+      dec_buffer.AddClip(width, height, dec_buffer, dc_resi,
+                         min_pel_, max_pel_);
+    }
+    return;
+  }
+
+  // Dequant
   quantize_.Inverse(comp, qp, width, height, decoded_pic_.GetBitdepth(),
                     cu_coeff_buf.GetDataPtr(), cu_coeff_buf.GetStride(),
                     temp_coeff_.GetDataPtr(), temp_coeff_.GetStride());
 
-  // Inverse transform
-  const bool is_luma_intra = util::IsLuma(comp) && cu->IsIntra();
-  inv_transform_.Transform(width, height, is_luma_intra,
+  // Inverse transform, zero rows and columns outside of the parsed
+  // coefficient area are skipped
+  inv_transform_.Transform(width, height, cu->GetCoeffExtentWidth(comp),
+                           cu->GetCoeffExtentHeight(comp), is_luma_intra,
                            temp_coeff_.GetDataPtr(), temp_coeff_.GetStride(),
                            temp_resi_.GetDataPtr(), temp_resi_.GetStride());
 
@@ -136,4 +158,4 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
   dec_buffer.AddClip(width, height, temp_pred_, temp_resi_, min_pel_, max_pel_);
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
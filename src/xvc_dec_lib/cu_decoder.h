@@ -32,7 +32,7 @@
 #include "xvc_dec_lib/cu_reader.h"
 #include "xvc_dec_lib/syntax_reader.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class CuDecoder {
 public:
@@ -61,6 +61,6 @@ private:
   CoeffBufferStorage temp_coeff_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_CU_DECODER_H_
@@ -21,7 +21,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 void CuReader::ReadCu(CodingUnit *cu, SplitRestriction split_restriction,
                       SyntaxReader *reader) {
@@ -206,11 +206,14 @@ void CuReader::ReadCoefficients(CodingUnit *cu, YuvComponent comp,
   cu_coeff_buf.ZeroOut(cu->GetWidth(comp), cu->GetHeight(comp));
   if (cbf) {
     ctu_has_coeffs_ = true;
+    int extent_width, extent_height;
     reader->ReadCoefficients(*cu, comp, cu_coeff_buf.GetDataPtr(),
-                             cu_coeff_buf.GetStride());
+                             cu_coeff_buf.GetStride(), &extent_width,
+                             &extent_height);
+    cu->SetCoeffExtent(comp, extent_width, extent_height);
   }
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 
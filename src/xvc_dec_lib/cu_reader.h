@@ -23,7 +23,7 @@
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_dec_lib/syntax_reader.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class CuReader {
 public:
@@ -55,6 +55,6 @@ private:
   bool ctu_has_coeffs_ = false;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_CU_READER_H_
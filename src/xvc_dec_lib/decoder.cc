@@ -18,6 +18,7 @@
 
 #include "xvc_dec_lib/decoder.h"
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
@@ -26,28 +27,71 @@
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/utils.h"
 #include "xvc_dec_lib/segment_header_reader.h"
+#include "xvc_dec_lib/segment_parallel_decoder.h"
 #include "xvc_dec_lib/thread_decoder.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
+
+// Number of pictures the decoder may lag behind before dropping a layer,
+// at least one sub gop since pictures are decoded in bursts when reordered
+static const double kRealTimeMaxLatePics = 2.0;
+// Upper temporal layer is added back only if less than this fraction of
+// the presentation time was spent decoding the previous sub-gop
+static const double kRealTimeMaxLoadForUpSwitch = 0.4;
 
 Decoder::Decoder(int num_threads)
   : curr_segment_header_(std::make_shared<SegmentHeader>()),
   prev_segment_header_(std::make_shared<SegmentHeader>()),
-  simd_(SimdCpu::GetRuntimeCapabilities()) {
+  simd_capabilities_(SimdCpu::GetRuntimeCapabilities()),
+  simd_(simd_capabilities_) {
   if (num_threads != 0) {
     thread_decoder_ =
       std::unique_ptr<ThreadDecoder>(new ThreadDecoder(num_threads));
   }
 }
 
+Decoder::Decoder(DecoderThreadPool *thread_pool, int thread_priority)
+  : Decoder(0) {
+  thread_decoder_ = std::unique_ptr<ThreadDecoder>(
+    new ThreadDecoder(thread_pool, thread_priority));
+}
+
 Decoder::~Decoder() {
+  segment_decoder_.reset();
   if (thread_decoder_) {
     thread_decoder_->StopAll();
   }
 }
 
+void Decoder::SetParallelSegments(int num_segments) {
+  assert(state_ == State::kNoSegmentHeader && nal_buffer_.empty());
+  if (num_segments == 0) {
+    segment_decoder_.reset();
+    return;
+  }
+  segment_decoder_.reset(new SegmentParallelDecoder(num_segments, [this]() {
+    return CreateSegmentDecoder();
+  }));
+}
+
 bool Decoder::DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
                         int64_t user_data) {
+  // Worker threads decode concurrently, only the time the application is
+  // kept waiting is accounted
+  const bool measure_time = real_time_ && thread_decoder_;
+  const double start_time = measure_time ? real_time_clock_() : 0;
+  bool success = DecodeNalUnit(nal_unit, nal_unit_size, user_data);
+  if (measure_time) {
+    real_time_decode_time_ += real_time_clock_() - start_time;
+  }
+  if (output_callback_) {
+    DeliverOutputPictures();
+  }
+  return success;
+}
+
+bool Decoder::DecodeNalUnit(const uint8_t *nal_unit, size_t nal_unit_size,
+                            int64_t user_data) {
   // Nal header parsing
   BitReader bit_reader(nal_unit, nal_unit_size);
   uint8_t header = bit_reader.ReadByte();
@@ -67,7 +111,18 @@ bool Decoder::DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
 
   // Segment header parsing
   if (nal_unit_type == NalUnitType::kSegmentHeader) {
-    return DecodeSegmentHeaderNal(&bit_reader);
+    // A new chunk can start here if no tail picture of previous segment
+    // is referencing the intra access picture of this segment
+    const bool independent_segment =
+      state_ == State::kNoSegmentHeader || !curr_segment_header_->open_gop;
+    if (!DecodeSegmentHeaderNal(&bit_reader)) {
+      return false;
+    }
+    if (segment_decoder_) {
+      segment_decoder_->AddSegmentHeaderNal(nal_unit, nal_unit_size,
+                                            independent_segment);
+    }
+    return true;
   }
   if (state_ == State::kNoSegmentHeader ||
       state_ == State::kDecoderVersionTooLow ||
@@ -85,10 +140,22 @@ bool Decoder::DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
     // First, the buffer flag is checked to see if the picture
     // should be decoded or buffered.
     int buffer_flag = bit_reader.ReadBit();
+    if (segment_decoder_) {
+      // Picture is decoded together with the rest of its segment
+      segment_decoder_->AddPictureNal(nal_unit, nal_unit_size, user_data,
+                                      buffer_flag != 0);
+      if (state_ != State::kChecksumMismatch) {
+        state_ = State::kPicDecoded;
+      }
+      return true;
+    }
     int tid = bit_reader.ReadBits(3);
     int new_desired_max_tid = SegmentHeader::GetFramerateMaxTid(
       decoder_ticks_, curr_segment_header_->bitstream_ticks,
       curr_segment_header_->max_sub_gop_length);
+    if (real_time_) {
+      new_desired_max_tid = UpdateRealTimeMaxTid(tid, new_desired_max_tid);
+    }
     if (new_desired_max_tid < max_tid_ || tid == 0) {
       // Number of temporal layers can always be decreased,
       // but only increased at temporal layer 0 pictures.
@@ -155,6 +222,8 @@ bool Decoder::DecodeSegmentHeaderNal(BitReader *bit_reader) {
     return false;
   }
   sub_gop_length_ = curr_segment_header_->max_sub_gop_length;
+  // Without reordering there is no need to wait for a full sliding window
+  no_reordering_ = sub_gop_length_ == 1;
   if (sub_gop_length_ + 1 > sliding_window_length_) {
     sliding_window_length_ = sub_gop_length_ + 1 + (thread_decoder_ ? 1 : 0);
   }
@@ -178,6 +247,9 @@ bool Decoder::DecodeSegmentHeaderNal(BitReader *bit_reader) {
   }
   max_tid_ = SegmentHeader::GetFramerateMaxTid(
     decoder_ticks_, curr_segment_header_->bitstream_ticks, sub_gop_length_);
+  if (real_time_) {
+    max_tid_ = std::min(max_tid_, real_time_max_tid_);
+  }
   return true;
 }
 
@@ -210,12 +282,47 @@ Decoder::DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data) {
                                  doc_, soc_, num_tail_pics_);
   doc_ = pic_header.doc + 1;
 
+  // Low-delay output continues from an intra access picture when there are
+  // no earlier pictures left to output, e.g. after a flush or lost pictures
+  if (pic_header.nal_unit_type == NalUnitType::kIntraAccessPicture &&
+      num_tail_pics_ == 0 &&
+      std::none_of(pic_decoders_.begin(), pic_decoders_.end(),
+                   [](const std::shared_ptr<PictureDecoder> &pic) {
+    return pic->GetOutputStatus() != OutputStatus::kHasBeenOutput;
+  })) {
+    next_output_poc_ = pic_header.poc;
+  }
+
   // Reload restriction flags for current thread if segment has changed
   thread_local SegmentNum loaded_restrictions_soc = static_cast<SegmentNum>(-1);
   if (loaded_restrictions_soc != segment_header->soc) {
     Restrictions::GetRW() = segment_header->restrictions;
   }
 
+  if (thread_decoder_ && buffer_flag) {
+    // Tail pictures can reference the intra access picture of the next
+    // segment, which is converted on this thread if its format differs
+    for (auto &pic : pic_decoders_) {
+      auto pic_data = pic->GetPicData();
+      const OutputStatus status = pic->GetOutputStatus();
+      if (pic_data->GetSoc() != segment_header->soc &&
+          (status == OutputStatus::kProcessing ||
+           status == OutputStatus::kFinishedProcessing) &&
+          (pic_data->GetPictureWidth(YuvComponent::kY) !=
+           segment_header->GetInternalWidth() ||
+           pic_data->GetPictureHeight(YuvComponent::kY) !=
+           segment_header->GetInternalHeight() ||
+           pic_data->GetChromaFormat() != segment_header->chroma_format ||
+           pic_data->GetBitdepth() != segment_header->internal_bitdepth)) {
+        thread_decoder_->WaitForPicture(
+          pic, [this](std::shared_ptr<PictureDecoder> p, bool success,
+                      const PicDecList &deps) {
+          OnPictureDecoded(p, success, deps);
+        });
+      }
+    }
+  }
+
   // Determine dependencies for reference picture based on poc and tid
   const bool is_intra_nal =
     pic_header.nal_unit_type == NalUnitType::kIntraPicture ||
@@ -233,36 +340,17 @@ Decoder::DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data) {
   }
 
   // Find an available decoder to use for this nal
-  std::shared_ptr<PictureDecoder> pic_dec;
-  if (thread_decoder_) {
-    while (!(pic_dec = GetFreePictureDecoder(*segment_header))) {
-      thread_decoder_->WaitOne([this](std::shared_ptr<PictureDecoder> pic,
-                                      bool success, const PicDecList &deps) {
-        OnPictureDecoded(pic, success, deps);
-      });
-    }
-  } else {
-    pic_dec = GetFreePictureDecoder(*segment_header);
-    assert(pic_dec);
-  }
+  std::shared_ptr<PictureDecoder> pic_dec =
+    WaitForFreePictureDecoder(*segment_header);
 
   // Setup poc and output status on main thread
   pic_dec->Init(*segment_header, pic_header, std::move(ref_pic_list),
                 user_data);
-
-  // Special handling of inter dependency ref counting for lowest layer
+  pic_dec->SetOutputFormat(output_width_, output_height_,
+                           output_chroma_format_, output_color_matrix_,
+                           output_bitdepth_);
   if (pic_header.tid == 0) {
-    // This picture might be used by later lowest temporal layer pictures.
-    // Force an extra ref until we are sure it is no longer referenced
-    pic_dec->AddReferenceCount(1);
-    zero_tid_pic_dec_.push_back(pic_dec);
-    // Restrict number of lowest layer pictures that must be in picture buffer
-    while (static_cast<int>(zero_tid_pic_dec_.size()) >
-           segment_header->num_ref_pics + 1) {
-      auto &pic = zero_tid_pic_dec_.front();
-      pic->RemoveReferenceCount(1);
-      zero_tid_pic_dec_.pop_front();
-    }
+    AddZeroTidReference(pic_dec, *segment_header);
   }
 
   if (thread_decoder_) {
@@ -274,12 +362,119 @@ Decoder::DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data) {
     }
   } else {
     // Synchronous decode
+    const double start_time = real_time_ ? real_time_clock_() : 0;
     bool success = pic_dec->Decode(*segment_header, &pic_bit_reader);
+    if (real_time_) {
+      real_time_decode_time_ += real_time_clock_() - start_time;
+    }
     OnPictureDecoded(pic_dec, success, inter_dependencies);
   }
 }
 
 void Decoder::FlushBufferedNalUnits() {
+  FlushAllNalUnits();
+  if (output_callback_) {
+    DeliverOutputPictures();
+  }
+}
+
+void Decoder::FlushTailPictures() {
+  if (!segment_decoder_ && num_tail_pics_ > 0) {
+    // The intra access picture is first in the buffer if not yet decoded
+    DecodeAllBufferedNals();
+  }
+  FlushBufferedNalUnits();
+}
+
+bool Decoder::AddIntraAccessPicture(const uint8_t *nal_unit,
+                                    size_t nal_unit_size, int64_t user_data,
+                                    const uint8_t *pic_bytes) {
+  if (segment_decoder_ || num_tail_pics_ == 0 ||
+      (state_ != State::kSegmentHeaderDecoded &&
+       state_ != State::kPicDecoded && state_ != State::kChecksumMismatch)) {
+    return false;
+  }
+  BitReader bit_reader(nal_unit, nal_unit_size);
+  uint8_t header = bit_reader.ReadByte();
+  int nal_rfe = ((header >> 6) & 3);
+  if (nal_rfe > 0) {
+    if (header != constants::kEncapsulationCode1 &&
+        header != constants::kEncapsulationCode2) {
+      return false;
+    }
+    bit_reader.ReadByte();
+    header = bit_reader.ReadByte();
+  }
+  if (NalUnitType((header >> 1) & 31) != NalUnitType::kIntraAccessPicture ||
+      bit_reader.ReadBit() != 0) {
+    return false;
+  }
+  bit_reader.Rewind(9);
+
+  // The picture starts a new segment, stored in the current format
+  prev_segment_header_ = curr_segment_header_;
+  curr_segment_header_ = std::make_shared<SegmentHeader>(*prev_segment_header_);
+  soc_++;
+  curr_segment_header_->soc = soc_;
+  num_pics_in_buffer_++;
+  PictureDecoder::PicNalHeader pic_header =
+    PictureDecoder::DecodeHeader(&bit_reader, &sub_gop_end_poc_,
+                                 &sub_gop_start_poc_, &sub_gop_length_,
+                                 curr_segment_header_->max_sub_gop_length,
+                                 prev_segment_header_->max_sub_gop_length,
+                                 doc_, soc_, num_tail_pics_);
+  doc_ = pic_header.doc + 1;
+
+  std::shared_ptr<PictureDecoder> pic_dec =
+    WaitForFreePictureDecoder(*curr_segment_header_);
+  pic_dec->Init(*curr_segment_header_, pic_header, ReferencePictureLists(),
+                user_data);
+  pic_dec->SetOutputFormat(output_width_, output_height_,
+                           output_chroma_format_, output_color_matrix_,
+                           output_bitdepth_);
+  pic_dec->CopyDecodedPicture(*curr_segment_header_, pic_bytes);
+  AddZeroTidReference(pic_dec, *curr_segment_header_);
+  OnPictureDecoded(pic_dec, true, PicDecList());
+  return true;
+}
+
+bool Decoder::GetReferencePicture(const SegmentHeader &segment,
+                                  std::vector<uint8_t> *pic_bytes) {
+  std::shared_ptr<PictureDecoder> pic_dec;
+  for (auto &pic : pic_decoders_) {
+    if (pic->GetOutputStatus() != OutputStatus::kHasBeenOutput &&
+        (!pic_dec ||
+         pic->GetPicData()->GetDoc() > pic_dec->GetPicData()->GetDoc())) {
+      pic_dec = pic;
+    }
+  }
+  if (!pic_dec) {
+    return false;
+  }
+  if (thread_decoder_) {
+    thread_decoder_->WaitForPicture(
+      pic_dec, [this](std::shared_ptr<PictureDecoder> pic, bool success,
+                      const PicDecList &deps) {
+      OnPictureDecoded(pic, success, deps);
+    });
+  }
+  std::shared_ptr<YuvPicture> ref_pic =
+    pic_dec->GetAlternativeRecPic(segment.chroma_format,
+                                  segment.GetInternalWidth(),
+                                  segment.GetInternalHeight(),
+                                  segment.internal_bitdepth);
+  ref_pic->CopyToSameBitdepth(pic_bytes);
+  return true;
+}
+
+void Decoder::FlushAllNalUnits() {
+  if (segment_decoder_) {
+    segment_decoder_->Flush();
+    soc_++;
+    prev_segment_header_ = curr_segment_header_;
+    state_ = State::kNoSegmentHeader;
+    return;
+  }
   // Remove restriction of minimum picture buffer size
   // so that we can output any remaining pictures
   enforce_sliding_window_ = false;
@@ -292,6 +487,7 @@ void Decoder::FlushBufferedNalUnits() {
       // Throw away buffered Nal Units.
       num_pics_in_buffer_ -= static_cast<uint32_t>(nal_buffer_.size());
       nal_buffer_.clear();
+      num_tail_pics_ = 0;
     } else {
       // Step over the missing key picture and then decode the buffered
       // Nal Units.
@@ -307,18 +503,27 @@ void Decoder::FlushBufferedNalUnits() {
 }
 
 bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
-  // Prevent outputing pictures if non are available
-  // otherwise reference pictures might be corrupted
-  if (!HasPictureReadyForOutput()) {
-    output_pic->size = 0;
-    output_pic->bytes = nullptr;
-    for (int c = 0; c < constants::kMaxYuvComponents; c++) {
-      output_pic->planes[c] = nullptr;
-      output_pic->stride[c] = 0;
+  if (!real_time_ || !thread_decoder_) {
+    return GetNextOutputPicture(output_pic);
+  }
+  // Waiting for worker threads to finish a picture counts as decoding time
+  const double start_time = real_time_clock_();
+  bool success = GetNextOutputPicture(output_pic);
+  real_time_decode_time_ += real_time_clock_() - start_time;
+  return success;
+}
+
+bool Decoder::GetNextOutputPicture(xvc_decoded_picture *output_pic) {
+  if (segment_decoder_) {
+    if (!segment_decoder_->GetDecodedPicture(output_pic)) {
+      return false;
     }
-    return false;
+    if (!output_pic->stats.conforming) {
+      state_ = State::kChecksumMismatch;
+      num_corrupted_pics_++;
+    }
+    return true;
   }
-
   // Find the picture with lowest poc that has not been output.
   std::shared_ptr<PictureDecoder> pic_dec;
   PicNum lowest_poc = std::numeric_limits<PicNum>::max();
@@ -330,7 +535,10 @@ bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
       lowest_poc = pd->GetPoc();
     }
   }
-  if (!pic_dec) {
+  // Prevent outputing pictures if non are available
+  // otherwise reference pictures might be corrupted
+  if (!pic_dec || (!HasPictureReadyForOutput() &&
+                   !IsLowDelayOutputReady(*pic_dec))) {
     output_pic->size = 0;
     output_pic->bytes = nullptr;
     for (int c = 0; c < constants::kMaxYuvComponents; c++) {
@@ -350,11 +558,13 @@ bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
   }
 
   pic_dec->SetOutputStatus(OutputStatus::kHasBeenOutput);
+  next_output_poc_ = lowest_poc + 1;
   SetOutputStats(pic_dec, output_pic);
-  auto decoded_pic = pic_dec->GetRecPic();
-  decoded_pic->CopyTo(&output_pic_bytes_, output_width_, output_height_,
-                      output_chroma_format_, output_bitdepth_,
-                      output_color_matrix_);
+  // Output conversion is normally already done by the decoding thread
+  if (!pic_dec->HasOutputPicture()) {
+    pic_dec->PrepareOutputPicture();
+  }
+  pic_dec->SwapOutputBytes(&output_pic_bytes_);
   const int sample_size = output_bitdepth_ == 8 ? 1 : 2;
   output_pic->size = output_pic_bytes_.size();
   output_pic->bytes = output_pic_bytes_.empty() ? nullptr :
@@ -381,6 +591,109 @@ bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
   return true;
 }
 
+bool Decoder::IsLowDelayOutputReady(const PictureDecoder &pic_dec) {
+  // All pictures with lower poc must have been output already, since pictures
+  // are only output in poc order no such picture can be decoded later on
+  if (!low_delay_ && !no_reordering_) {
+    return false;
+  }
+  const PicNum poc = pic_dec.GetPicData()->GetPoc();
+  while (next_output_poc_ < poc && IsPocSkipped(next_output_poc_)) {
+    next_output_poc_++;
+  }
+  if (poc != next_output_poc_) {
+    return false;
+  }
+  if (thread_decoder_) {
+    // Do not block on pictures that are still being decoded
+    thread_decoder_->PollFinished([this](std::shared_ptr<PictureDecoder> pic,
+                                         bool success, const PicDecList &deps) {
+      OnPictureDecoded(pic, success, deps);
+    });
+    return pic_dec.GetOutputStatus() == OutputStatus::kHasNotBeenOutput;
+  }
+  return true;
+}
+
+bool Decoder::IsPocSkipped(PicNum poc) const {
+  // Pictures in earlier sub gops are either decoded already or lost
+  if (poc <= sub_gop_start_poc_) {
+    return true;
+  }
+  if (poc > sub_gop_start_poc_ + sub_gop_length_ ||
+      nal_buffer_.size() > static_cast<size_t>(num_tail_pics_)) {
+    return false;
+  }
+  // Pictures in the current sub gop are dropped above the max temporal layer
+  PicNum doc = SegmentHeader::CalcDocFromPoc(poc, sub_gop_length_,
+                                             sub_gop_start_poc_);
+  return SegmentHeader::CalcTidFromDoc(doc, sub_gop_length_,
+                                       sub_gop_start_poc_) > max_tid_;
+}
+
+void Decoder::DeliverOutputPictures() {
+  xvc_decoded_picture output_pic;
+  while (GetDecodedPicture(&output_pic)) {
+    output_callback_(output_callback_opaque_, &output_pic);
+  }
+}
+
+std::unique_ptr<Decoder> Decoder::CreateSegmentDecoder() const {
+  // Each segment is decoded single threaded, parallelism is across segments
+  std::unique_ptr<Decoder> decoder(new Decoder(0));
+  decoder->SetCpuCapabilities(simd_capabilities_);
+  decoder->output_width_ = output_width_;
+  decoder->output_height_ = output_height_;
+  decoder->output_chroma_format_ = output_chroma_format_;
+  decoder->output_color_matrix_ = output_color_matrix_;
+  decoder->output_bitdepth_ = output_bitdepth_;
+  decoder->decoder_ticks_ = decoder_ticks_;
+  return decoder;
+}
+
+int Decoder::UpdateRealTimeMaxTid(int tid, int framerate_max_tid) {
+  // Each picture in the bitstream occupies one tick period of presentation
+  // time, also when it is dropped. Only the decoding time since the previous
+  // picture is compared against it, so that an application pacing its calls
+  // to the presentation time is not seen as falling behind.
+  const double pic_duration =
+    1.0 * curr_segment_header_->bitstream_ticks / constants::kTimeScale;
+  const double decode_time = real_time_decode_time_;
+  real_time_decode_time_ = 0;
+  real_time_lateness_ =
+    std::max(0.0, real_time_lateness_ + decode_time - pic_duration);
+  real_time_busy_ += decode_time;
+  real_time_period_ += pic_duration;
+
+  // Layers above those present in the bitstream are not counted
+  const PicNum sub_gop_length = curr_segment_header_->max_sub_gop_length;
+  const int max_tid =
+    std::min(framerate_max_tid, SegmentHeader::GetMaxTid(sub_gop_length));
+  real_time_max_tid_ = std::min(real_time_max_tid_, max_tid);
+  const double max_late_pics =
+    std::max(kRealTimeMaxLatePics, static_cast<double>(sub_gop_length));
+  if (real_time_lateness_ > max_late_pics * pic_duration) {
+    // Falling behind, drop the highest temporal layer being decoded
+    real_time_max_tid_ = std::max(0, std::min(real_time_max_tid_,
+                                              max_tid_) - 1);
+    real_time_lateness_ = 0;
+    real_time_busy_ = 0;
+    real_time_period_ = 0;
+  } else if (tid == 0) {
+    // One more layer roughly doubles the number of decoded pictures, the
+    // load is only known after a full sub gop since the last change
+    if (real_time_lateness_ == 0 &&
+        real_time_period_ > (sub_gop_length - 0.5) * pic_duration &&
+        real_time_busy_ < kRealTimeMaxLoadForUpSwitch * real_time_period_ &&
+        real_time_max_tid_ < max_tid) {
+      real_time_max_tid_++;
+    }
+    real_time_busy_ = 0;
+    real_time_period_ = 0;
+  }
+  return real_time_max_tid_;
+}
+
 std::shared_ptr<PictureDecoder>
 Decoder::GetFreePictureDecoder(const SegmentHeader &segment) {
   if (pic_decoders_.size() < pic_buffering_num_) {
@@ -388,7 +701,8 @@ Decoder::GetFreePictureDecoder(const SegmentHeader &segment) {
       std::make_shared<PictureDecoder>(simd_, segment.chroma_format,
                                        segment.GetInternalWidth(),
                                        segment.GetInternalHeight(),
-                                       segment.internal_bitdepth);
+                                       segment.internal_bitdepth,
+                                       cu_storage_pool_);
     pic_decoders_.push_back(pic);
     return pic;
   }
@@ -423,11 +737,45 @@ Decoder::GetFreePictureDecoder(const SegmentHeader &segment) {
     pic_dec_it->reset(new PictureDecoder(simd_, segment.chroma_format,
                                          segment.GetInternalWidth(),
                                          segment.GetInternalHeight(),
-                                         segment.internal_bitdepth));
+                                         segment.internal_bitdepth,
+                                         cu_storage_pool_));
   }
   return *pic_dec_it;
 }
 
+std::shared_ptr<PictureDecoder>
+Decoder::WaitForFreePictureDecoder(const SegmentHeader &segment) {
+  std::shared_ptr<PictureDecoder> pic_dec;
+  if (thread_decoder_) {
+    while (!(pic_dec = GetFreePictureDecoder(segment))) {
+      thread_decoder_->WaitOne([this](std::shared_ptr<PictureDecoder> pic,
+                                      bool success, const PicDecList &deps) {
+        OnPictureDecoded(pic, success, deps);
+      });
+    }
+  } else {
+    pic_dec = GetFreePictureDecoder(segment);
+    assert(pic_dec);
+  }
+  return pic_dec;
+}
+
+void Decoder::AddZeroTidReference(std::shared_ptr<PictureDecoder> pic_dec,
+                                  const SegmentHeader &segment) {
+  // Special handling of inter dependency ref counting for lowest layer.
+  // This picture might be used by later lowest temporal layer pictures.
+  // Force an extra ref until we are sure it is no longer referenced
+  pic_dec->AddReferenceCount(1);
+  zero_tid_pic_dec_.push_back(pic_dec);
+  // Restrict number of lowest layer pictures that must be in picture buffer
+  while (static_cast<int>(zero_tid_pic_dec_.size()) >
+         segment.num_ref_pics + 1) {
+    auto &pic = zero_tid_pic_dec_.front();
+    pic->RemoveReferenceCount(1);
+    zero_tid_pic_dec_.pop_front();
+  }
+}
+
 void Decoder::OnPictureDecoded(std::shared_ptr<PictureDecoder> pic_dec,
                                bool success, const PicDecList &inter_deps) {
   pic_dec->SetOutputStatus(OutputStatus::kHasNotBeenOutput);
@@ -492,4 +840,4 @@ void Decoder::SetOutputStats(std::shared_ptr<PictureDecoder> pic_dec,
   }
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -19,7 +19,10 @@
 #ifndef XVC_DEC_LIB_DECODER_H_
 #define XVC_DEC_LIB_DECODER_H_
 
+// Some C++11 headers are not allowed by cpplint
+#include <chrono>   // NOLINT
 #include <deque>
+#include <functional>
 #include <list>
 #include <memory>
 #include <set>
@@ -36,10 +39,12 @@
 
 struct xvc_decoder {};
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 // To avoid including all thread related system headers
 class ThreadDecoder;
+class SegmentParallelDecoder;
+using DecoderThreadPool = xvc_decoder_thread_pool;
 
 class Decoder : public xvc_decoder {
 public:
@@ -53,11 +58,25 @@ public:
   };
 
   explicit Decoder(int num_threads);
+  // Pictures are decoded by the worker threads of a shared pool
+  Decoder(DecoderThreadPool *thread_pool, int thread_priority);
   ~Decoder();
   bool DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
                  int64_t user_data = 0);
   bool GetDecodedPicture(xvc_decoded_picture *dec_pic);
   void FlushBufferedNalUnits();
+  // Decodes the buffered tail pictures of the previous segment, once the
+  // intra access picture they reference is available, and then flushes
+  void FlushTailPictures();
+  // Adds the intra access picture of a segment that is decoded by another
+  // decoder, from samples already converted to the format of the current
+  // segment. Only the tail pictures of the current segment can follow.
+  bool AddIntraAccessPicture(const uint8_t *nal_unit, size_t nal_unit_size,
+                             int64_t user_data, const uint8_t *pic_bytes);
+  // Samples of the last decoded picture as referenced from a segment of
+  // another format, packed as by YuvPicture::CopyToSameBitdepth
+  bool GetReferencePicture(const SegmentHeader &segment,
+                           std::vector<uint8_t> *pic_bytes);
   PicNum GetNumDecodedPics() { return num_pics_in_buffer_; }
   PicNum HasPictureReadyForOutput() {
     return !enforce_sliding_window_ ||
@@ -65,8 +84,10 @@ public:
   }
   PicNum GetNumCorruptedPics() { return num_corrupted_pics_; }
   void SetCpuCapabilities(std::set<CpuCapability> capabilities) {
+    simd_capabilities_ = capabilities;
     simd_ = SimdFunctions(capabilities);
   }
+  void SetParallelSegments(int num_segments);
   void SetOutputWidth(int width) { output_width_ = width; }
   void SetOutputHeight(int height) { output_height_ = height; }
   void SetOutputChromaFormat(xvc_dec_chroma_format chroma_format) {
@@ -77,6 +98,16 @@ public:
   }
   void SetOutputBitdepth(int bitdepth) { output_bitdepth_ = bitdepth; }
   void SetDecoderTicks(int ticks) { decoder_ticks_ = ticks; }
+  void SetRealTimeMode(bool real_time) { real_time_ = real_time; }
+  // Time source in seconds used by real-time mode, steady clock by default
+  void SetRealTimeClock(std::function<double()> clock) {
+    real_time_clock_ = clock;
+  }
+  void SetLowDelay(bool low_delay) { low_delay_ = low_delay; }
+  void SetOutputCallback(xvc_dec_output_callback callback, void *opaque) {
+    output_callback_ = callback;
+    output_callback_opaque_ = opaque;
+  }
   State GetState() { return state_; }
   xvc_dec_chroma_format getChromaFormatApiStyle() {
     return xvc_dec_chroma_format(curr_segment_header_->chroma_format);
@@ -85,15 +116,28 @@ public:
 private:
   using NalUnitPtr = std::unique_ptr<std::vector<uint8_t>>;
   using PicDecList = std::vector<std::shared_ptr<const PictureDecoder>>;
+  bool DecodeNalUnit(const uint8_t *nal_unit, size_t nal_unit_size,
+                     int64_t user_data);
+  bool GetNextOutputPicture(xvc_decoded_picture *dec_pic);
+  void FlushAllNalUnits();
   void DecodeAllBufferedNals();
   bool DecodeSegmentHeaderNal(BitReader *bit_reader);
   void DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data);
   std::shared_ptr<PictureDecoder>
     GetFreePictureDecoder(const SegmentHeader &segment_header);
+  std::shared_ptr<PictureDecoder>
+    WaitForFreePictureDecoder(const SegmentHeader &segment_header);
+  void AddZeroTidReference(std::shared_ptr<PictureDecoder> pic_dec,
+                           const SegmentHeader &segment_header);
   void OnPictureDecoded(std::shared_ptr<PictureDecoder> pic_dec, bool success,
                         const PicDecList &inter_deps);
   void SetOutputStats(std::shared_ptr<PictureDecoder> pic_dec,
                       xvc_decoded_picture *output_pic);
+  bool IsLowDelayOutputReady(const PictureDecoder &pic_dec);
+  bool IsPocSkipped(PicNum poc) const;
+  void DeliverOutputPictures();
+  std::unique_ptr<Decoder> CreateSegmentDecoder() const;
+  int UpdateRealTimeMaxTid(int tid, int framerate_max_tid);
 
   PicNum sub_gop_end_poc_ = 0;
   PicNum sub_gop_start_poc_ = 0;
@@ -114,16 +158,37 @@ private:
   int output_bitdepth_ = 0;
   int decoder_ticks_ = 0;
   int max_tid_ = 0;
+  // Real-time mode state, time is measured in seconds
+  bool real_time_ = false;
+  int real_time_max_tid_ = constants::kMaxTid;
+  std::function<double()> real_time_clock_ = [] {
+    return std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  };
+  // Time spent decoding since the last picture nal unit
+  double real_time_decode_time_ = 0;
+  double real_time_lateness_ = 0;
+  double real_time_busy_ = 0;
+  double real_time_period_ = 0;
   bool enforce_sliding_window_ = true;
+  bool low_delay_ = false;
+  bool no_reordering_ = false;
+  PicNum next_output_poc_ = 0;
+  xvc_dec_output_callback output_callback_ = nullptr;
+  void *output_callback_opaque_ = nullptr;
   State state_ = State::kNoSegmentHeader;
+  std::set<CpuCapability> simd_capabilities_;
   SimdFunctions simd_;
   std::vector<uint8_t> output_pic_bytes_;
+  std::shared_ptr<CuStoragePool> cu_storage_pool_ =
+    std::make_shared<CuStoragePool>();
   std::vector<std::shared_ptr<PictureDecoder>> pic_decoders_;
   std::list<std::shared_ptr<PictureDecoder>> zero_tid_pic_dec_;
   std::deque<std::pair<NalUnitPtr, int64_t>> nal_buffer_;
   std::unique_ptr<ThreadDecoder> thread_decoder_;
+  std::unique_ptr<SegmentParallelDecoder> segment_decoder_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_DECODER_H_
@@ -0,0 +1,112 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_dec_lib/decoder_thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+xvc_decoder_thread_pool::xvc_decoder_thread_pool(int num_threads) {
+  if (num_threads < 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  // Need at least one thread to work
+  num_threads = std::max(1, num_threads);
+  while (num_threads > static_cast<int>(worker_threads_.size())) {
+    worker_threads_.emplace_back([this] {
+      WorkerMain();
+    });
+  }
+}
+
+xvc_decoder_thread_pool::~xvc_decoder_thread_pool() {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  running_ = false;
+  wait_work_cond_.notify_all();  // wakeup all
+  lock.unlock();
+  for (auto &thread : worker_threads_) {
+    thread.join();
+  }
+  worker_threads_.clear();
+}
+
+void xvc_decoder_thread_pool::Attach(const void *client,
+                                     JobProvider job_provider, int priority) {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  // New clients are served first among clients of the same priority
+  clients_.push_back({ client, std::move(job_provider), priority, 0 });
+}
+
+void xvc_decoder_thread_pool::Detach(const void *client) {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                [client](const ClientEntry &entry) {
+    return entry.client == client;
+  }), clients_.end());
+}
+
+void xvc_decoder_thread_pool::NotifyWorkAvailable() {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  wait_work_cond_.notify_all();
+}
+
+xvc_decoder_thread_pool::Job xvc_decoder_thread_pool::TakeWork() {
+  // Highest priority first, then the client that waited longest since it
+  // was last served so that clients of equal priority share the workers
+  std::vector<ClientEntry*> order;
+  order.reserve(clients_.size());
+  for (auto &entry : clients_) {
+    order.push_back(&entry);
+  }
+  std::sort(order.begin(), order.end(),
+            [](const ClientEntry *a, const ClientEntry *b) {
+    if (a->priority != b->priority) {
+      return a->priority > b->priority;
+    }
+    return a->last_served < b->last_served;
+  });
+  for (ClientEntry *entry : order) {
+    Job job = entry->job_provider();
+    if (job) {
+      entry->last_served = ++num_served_;
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void xvc_decoder_thread_pool::WorkerMain() {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  while (true) {
+    Job job;
+    wait_work_cond_.wait(lock, [this, &job] {
+      if (!running_) {
+        return true;
+      }
+      job = TakeWork();
+      return static_cast<bool>(job);
+    });
+    if (!running_) {
+      break;
+    }
+    lock.unlock();
+    job();
+    job = nullptr;
+    lock.lock();
+  }
+}
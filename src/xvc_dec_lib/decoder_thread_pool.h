@@ -0,0 +1,72 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_DEC_LIB_DECODER_THREAD_POOL_H_
+#define XVC_DEC_LIB_DECODER_THREAD_POOL_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <functional>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_dec_lib/xvcdec.h"
+
+// Worker threads shared by any number of decoder instances. The pool does
+// not depend on the sample type and is therefore declared outside of the
+// xvc namespace so that it can be shared with the 8bit decoder variant.
+struct xvc_decoder_thread_pool {
+public:
+  using Job = std::function<void()>;
+  // Returns a job that is ready to run or an empty function otherwise
+  using JobProvider = std::function<Job()>;
+
+  explicit xvc_decoder_thread_pool(int num_threads);
+  ~xvc_decoder_thread_pool();
+  void Attach(const void *client, JobProvider job_provider, int priority);
+  void Detach(const void *client);
+  // Must not be called while holding a lock used by any job provider
+  void NotifyWorkAvailable();
+
+private:
+  struct ClientEntry {
+    const void *client;
+    JobProvider job_provider;
+    int priority;
+    uint64_t last_served;
+  };
+  Job TakeWork();
+  void WorkerMain();
+
+  std::vector<std::thread> worker_threads_;
+  std::mutex global_mutex_;
+  std::condition_variable wait_work_cond_;
+  std::vector<ClientEntry> clients_;
+  uint64_t num_served_ = 0;
+  bool running_ = true;
+};
+
+namespace XVC_NAMESPACE {
+
+using DecoderThreadPool = xvc_decoder_thread_pool;
+
+}   // namespace XVC_NAMESPACE
+
+#endif  // XVC_DEC_LIB_DECODER_THREAD_POOL_H_
@@ -20,7 +20,7 @@
 
 #include "xvc_common_lib/cabac.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 EntropyDecoder::EntropyDecoder(BitReader *bit_reader)
   : bit_reader_(bit_reader) {
@@ -145,4 +145,4 @@ void EntropyDecoder::Finish() {
   bit_reader_->SkipBits();
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -22,7 +22,7 @@
 #include "xvc_common_lib/context_model.h"
 #include "xvc_dec_lib/bit_reader.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class EntropyDecoder {
 public:
@@ -43,6 +43,6 @@ private:
   BitReader *bit_reader_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_ENTROPY_DECODER_H_
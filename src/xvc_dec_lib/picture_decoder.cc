@@ -31,14 +31,15 @@
 #include "xvc_dec_lib/cu_decoder.h"
 #include "xvc_dec_lib/entropy_decoder.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 PictureDecoder::PictureDecoder(const SimdFunctions &simd,
                                ChromaFormat chroma_format, int width,
-                               int height, int bitdepth)
+                               int height, int bitdepth,
+                               std::shared_ptr<CuStoragePool> cu_pool)
   : simd_(simd),
   pic_data_(std::make_shared<PictureData>(chroma_format, width, height,
-                                          bitdepth)),
+                                          bitdepth, std::move(cu_pool))),
   rec_pic_(std::make_shared<YuvPicture>(chroma_format, width, height,
                                         bitdepth, true)) {
 }
@@ -122,6 +123,7 @@ void PictureDecoder::Init(const SegmentHeader &segment,
   pic_qp_ = header.pic_qp;
   user_data_ = user_data;
   output_status_ = OutputStatus::kProcessing;
+  output_prepared_ = false;
   ref_count = 0;
   pic_data_->SetNalType(header.nal_unit_type);
   pic_data_->SetSoc(header.soc);
@@ -134,6 +136,7 @@ void PictureDecoder::Init(const SegmentHeader &segment,
   pic_data_->SetBetaOffset(segment.beta_offset);
   pic_data_->SetTcOffset(segment.tc_offset);
   *pic_data_->GetRefPicLists() = std::move(ref_pic_list);
+  alt_rec_pic_.reset();
 }
 
 bool PictureDecoder::Decode(const SegmentHeader &segment,
@@ -162,6 +165,9 @@ bool PictureDecoder::Decode(const SegmentHeader &segment,
                                pic_data_->GetTcOffset());
     deblocker.DeblockPicture();
   }
+  // Only the motion field is needed after this point
+  cu_decoder.reset();
+  pic_data_->ReleaseCodingUnits();
   if (!entropy_decoder.DecodeBinTrm()) {
     assert(0);
     success = false;
@@ -176,6 +182,45 @@ bool PictureDecoder::Decode(const SegmentHeader &segment,
   return success;
 }
 
+void PictureDecoder::CopyDecodedPicture(const SegmentHeader &segment,
+                                        const uint8_t *pic_bytes) {
+  assert(output_status_ == OutputStatus::kProcessing);
+  assert(pic_data_->IsIntraPic());
+  double lambda = 0;
+  Qp qp(pic_qp_, pic_data_->GetChromaFormat(), pic_data_->GetBitdepth(),
+        lambda);
+  // Without any coding units the motion field is all intra
+  pic_data_->Init(segment, qp, true);
+  pic_data_->ReleaseCodingUnits();
+  rec_pic_->CopyFromWithPadding(pic_bytes, rec_pic_->GetBitdepth());
+  pic_data_->GetRefPicLists()->ZeroOutReferences();
+}
+
+void PictureDecoder::SetOutputFormat(int width, int height,
+                                     ChromaFormat chroma_format,
+                                     ColorMatrix color_matrix, int bitdepth) {
+  output_width_ = width;
+  output_height_ = height;
+  output_chroma_format_ = chroma_format;
+  output_color_matrix_ = color_matrix;
+  output_bitdepth_ = bitdepth;
+}
+
+void PictureDecoder::PrepareOutputPicture() {
+  // Note! Might be invoked on a worker thread as soon as decoding has finished
+  rec_pic_->CopyTo(&output_bytes_, output_width_, output_height_,
+                   output_chroma_format_, output_bitdepth_,
+                   output_color_matrix_);
+  output_prepared_ = true;
+}
+
+void PictureDecoder::SwapOutputBytes(std::vector<uint8_t> *out_bytes) {
+  assert(output_prepared_);
+  // Previous output buffer is kept for reuse by next picture
+  out_bytes->swap(output_bytes_);
+  output_prepared_ = false;
+}
+
 std::shared_ptr<YuvPicture>
 PictureDecoder::GetAlternativeRecPic(ChromaFormat chroma_format, int width,
                                      int height, int bitdepth) const {
@@ -226,4 +271,4 @@ bool PictureDecoder::ValidateChecksum(BitReader *bit_reader,
   return checksum_.GetHash() == checksum_bytes;
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
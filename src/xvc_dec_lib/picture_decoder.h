@@ -33,7 +33,7 @@
 #include "xvc_dec_lib/syntax_reader.h"
 #include "xvc_dec_lib/xvcdec.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class PictureDecoder {
 public:
@@ -48,10 +48,14 @@ public:
   };
 
   PictureDecoder(const SimdFunctions &simd, ChromaFormat chroma_format,
-                 int width, int height, int bitdepth);
+                 int width, int height, int bitdepth,
+                 std::shared_ptr<CuStoragePool> cu_pool = nullptr);
   void Init(const SegmentHeader &segment, const PicNalHeader &header,
             ReferencePictureLists &&ref_pic_list, int64_t user_data);
   bool Decode(const SegmentHeader &segment, BitReader *bit_reader);
+  // Intra picture with samples from another decoder instead of decoding
+  void CopyDecodedPicture(const SegmentHeader &segment,
+                          const uint8_t *pic_bytes);
   std::shared_ptr<const PictureData> GetPicData() const { return pic_data_; }
   std::shared_ptr<PictureData> GetPicData() { return pic_data_; }
   std::shared_ptr<const YuvPicture> GetRecPic() const { return rec_pic_; }
@@ -65,6 +69,11 @@ public:
   void AddReferenceCount(int val) const { ref_count += val; }
   void RemoveReferenceCount(int val) const { ref_count -= val; }
   std::vector<uint8_t> GetLastChecksum() const { return checksum_.GetHash(); }
+  void SetOutputFormat(int width, int height, ChromaFormat chroma_format,
+                       ColorMatrix color_matrix, int bitdepth);
+  void PrepareOutputPicture();
+  bool HasOutputPicture() const { return output_prepared_; }
+  void SwapOutputBytes(std::vector<uint8_t> *out_bytes);
   std::shared_ptr<YuvPicture> GetAlternativeRecPic(
     ChromaFormat chroma_format, int width, int height, int bitdepth) const;
   static PicNalHeader
@@ -81,6 +90,13 @@ private:
   std::shared_ptr<YuvPicture> rec_pic_;
   std::shared_ptr<YuvPicture> alt_rec_pic_;
   Checksum checksum_;
+  std::vector<uint8_t> output_bytes_;
+  int output_width_ = 0;
+  int output_height_ = 0;
+  ChromaFormat output_chroma_format_ = ChromaFormat::kUndefinedChromaFormat;
+  ColorMatrix output_color_matrix_ = ColorMatrix::kUndefinedColorMatrix;
+  int output_bitdepth_ = 0;
+  bool output_prepared_ = false;
   bool conforming_ = false;
   int pic_qp_ = -1;
   int64_t user_data_ = 0;
@@ -91,6 +107,6 @@ private:
   mutable int ref_count = 0;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_PICTURE_DECODER_H_
@@ -20,7 +20,7 @@
 
 #include "xvc_common_lib/restrictions.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 Decoder::State SegmentHeaderReader::Read(SegmentHeader* segment_header,
                                          BitReader *bit_reader,
@@ -295,4 +295,4 @@ Decoder::State SegmentHeaderReader::Read(SegmentHeader* segment_header,
   return Decoder::State::kSegmentHeaderDecoded;
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -24,7 +24,7 @@
 #include "xvc_dec_lib/decoder.h"
 #include "xvc_dec_lib/bit_reader.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class SegmentHeaderReader {
 public:
@@ -33,6 +33,6 @@ public:
                              SegmentNum segment_counter);
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_SEGMENT_HEADER_READER_H_
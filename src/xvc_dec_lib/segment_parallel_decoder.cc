@@ -0,0 +1,245 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_dec_lib/segment_parallel_decoder.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "xvc_dec_lib/decoder.h"
+
+namespace XVC_NAMESPACE {
+
+SegmentParallelDecoder::SegmentParallelDecoder(int num_threads,
+                                               DecoderFactory decoder_factory)
+  : decoder_factory_(decoder_factory) {
+  if (num_threads < 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  // Need at least one thread to work
+  num_threads = std::max(1, num_threads);
+  // One chunk for each worker and one being delivered
+  max_chunks_ = num_threads + 1;
+  while (num_threads > static_cast<int>(worker_threads_.size())) {
+    worker_threads_.emplace_back([this] {
+      WorkerMain();
+    });
+  }
+}
+
+SegmentParallelDecoder::~SegmentParallelDecoder() {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  running_ = false;
+  wait_work_cond_.notify_all();  // wakeup all
+  output_taken_cond_.notify_all();
+  lock.unlock();
+  for (auto &thread : worker_threads_) {
+    thread.join();
+  }
+  worker_threads_.clear();
+}
+
+void SegmentParallelDecoder::AddSegmentHeaderNal(const uint8_t *nal_unit,
+                                                 size_t nal_unit_size,
+                                                 bool independent_segment) {
+  if (independent_segment && curr_chunk_) {
+    DispatchChunk();
+  }
+  AddNal(nal_unit, nal_unit_size, 0);
+  curr_chunk_->num_segments++;
+  // Only tail pictures of the last segment in a chunk are of interest
+  curr_chunk_->num_tail_pics = 0;
+}
+
+void SegmentParallelDecoder::AddPictureNal(const uint8_t *nal_unit,
+                                           size_t nal_unit_size,
+                                           int64_t user_data,
+                                           bool tail_picture) {
+  AddNal(nal_unit, nal_unit_size, user_data);
+  curr_chunk_->num_pics++;
+  if (tail_picture) {
+    curr_chunk_->num_tail_pics++;
+  }
+}
+
+void SegmentParallelDecoder::AddNal(const uint8_t *nal_unit,
+                                    size_t nal_unit_size, int64_t user_data) {
+  if (!curr_chunk_) {
+    curr_chunk_.reset(new Chunk());
+    curr_chunk_->base_poc = next_base_poc_;
+    curr_chunk_->prev_num_tail_pics = prev_num_tail_pics_;
+    curr_chunk_->base_soc = next_base_soc_;
+    flushing_ = false;
+  }
+  NalUnitPtr nal(new std::vector<uint8_t>(nal_unit, nal_unit + nal_unit_size));
+  curr_chunk_->nals.push_back({ std::move(nal), user_data });
+}
+
+void SegmentParallelDecoder::Flush() {
+  if (curr_chunk_) {
+    DispatchChunk();
+  }
+  // Allow output to wait for all remaining chunks
+  flushing_ = true;
+}
+
+bool SegmentParallelDecoder::GetDecodedPicture(xvc_decoded_picture *out_pic) {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  while (!chunks_.empty()) {
+    Chunk *chunk = chunks_.front().get();
+    if (chunk->output.empty() && !chunk->finished) {
+      if (!flushing_) {
+        break;
+      }
+      work_done_cond_.wait(lock, [chunk] {
+        return !chunk->output.empty() || chunk->finished;
+      });
+    }
+    if (chunk->output.empty()) {
+      chunks_.pop_front();
+      continue;
+    }
+    // Keep bytes alive until next call to this function
+    output_pic_ = std::move(chunk->output.front());
+    chunk->output.pop_front();
+    output_taken_cond_.notify_all();
+    *out_pic = output_pic_.pic;
+    out_pic->bytes = output_pic_.bytes.empty() ? nullptr :
+      reinterpret_cast<char *>(&output_pic_.bytes[0]);
+    for (int c = 0; c < constants::kMaxYuvComponents; c++) {
+      out_pic->planes[c] = out_pic->bytes + output_pic_.plane_offset[c];
+    }
+    return true;
+  }
+  out_pic->size = 0;
+  out_pic->bytes = nullptr;
+  for (int c = 0; c < constants::kMaxYuvComponents; c++) {
+    out_pic->planes[c] = nullptr;
+    out_pic->stride[c] = 0;
+  }
+  return false;
+}
+
+void SegmentParallelDecoder::DispatchChunk() {
+  // Decoder is created on calling thread using the current decoder settings
+  curr_chunk_->decoder = decoder_factory_();
+  next_base_poc_ += curr_chunk_->num_pics;
+  prev_num_tail_pics_ = curr_chunk_->num_tail_pics;
+  next_base_soc_ += curr_chunk_->num_segments;
+
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  // Back-pressure, the caller must still be able to take the output of the
+  // oldest chunk, otherwise its worker could wait for that forever
+  work_done_cond_.wait(lock, [this] {
+    return static_cast<int>(chunks_.size()) < max_chunks_ ||
+      !chunks_.front()->output.empty() || chunks_.front()->finished;
+  });
+  pending_chunks_.push_back(curr_chunk_.get());
+  chunks_.push_back(std::move(curr_chunk_));
+  wait_work_cond_.notify_one();
+}
+
+void SegmentParallelDecoder::WorkerMain() {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  while (true) {
+    wait_work_cond_.wait(lock, [this] {
+      return !running_ || !pending_chunks_.empty();
+    });
+    if (!running_) {
+      break;
+    }
+    Chunk *chunk = pending_chunks_.front();
+    pending_chunks_.pop_front();
+    lock.unlock();
+
+    DecodeChunk(chunk);
+
+    lock.lock();
+    chunk->finished = true;
+    work_done_cond_.notify_all();
+  }
+}
+
+void SegmentParallelDecoder::DecodeChunk(Chunk *chunk) {
+  Decoder *decoder = chunk->decoder.get();
+  xvc_decoded_picture dec_pic;
+  bool running = true;
+  for (auto &nal : chunk->nals) {
+    decoder->DecodeNal(&(*nal.first)[0], nal.first->size(), nal.second);
+    if (decoder->GetDecodedPicture(&dec_pic)) {
+      running = StoreOutputPicture(dec_pic, chunk);
+    }
+    if (!running) {
+      break;
+    }
+  }
+  if (running) {
+    decoder->FlushBufferedNalUnits();
+    while (running && decoder->GetDecodedPicture(&dec_pic)) {
+      running = StoreOutputPicture(dec_pic, chunk);
+    }
+  }
+  // Release memory as soon as possible, output is kept until delivered
+  chunk->nals.clear();
+  chunk->decoder.reset();
+}
+
+bool SegmentParallelDecoder::StoreOutputPicture(
+  const xvc_decoded_picture &dec_pic, Chunk *chunk) {
+  OutputPicture out;
+  out.bytes.assign(dec_pic.bytes, dec_pic.bytes + dec_pic.size);
+  out.pic = dec_pic;
+  for (int c = 0; c < constants::kMaxYuvComponents; c++) {
+    out.plane_offset[c] = dec_pic.planes[c] - dec_pic.bytes;
+  }
+  // Translate picture counters from chunk local to bitstream global values
+  xvc_dec_pic_stats &stats = out.pic.stats;
+  stats.poc += static_cast<uint32_t>(chunk->base_poc);
+  if (stats.doc == 0) {
+    // Intra access picture is decoded before tail pictures of previous chunk
+    stats.doc =
+      static_cast<uint32_t>(chunk->base_poc - chunk->prev_num_tail_pics);
+  } else {
+    stats.doc += static_cast<uint32_t>(chunk->base_poc);
+  }
+  stats.soc = static_cast<SegmentNum>(stats.soc + chunk->base_soc);
+  int length = sizeof(stats.l0) / sizeof(stats.l0[0]);
+  for (int i = 0; i < length; i++) {
+    if (stats.l0[i] >= 0) {
+      stats.l0[i] += static_cast<int32_t>(chunk->base_poc);
+    }
+    if (stats.l1[i] >= 0) {
+      stats.l1[i] += static_cast<int32_t>(chunk->base_poc);
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  // Do not decode further ahead than the caller takes output
+  output_taken_cond_.wait(lock, [this, chunk] {
+    return !running_ ||
+      static_cast<int>(chunk->output.size()) < kMaxOutputPicsPerChunk;
+  });
+  if (!running_) {
+    return false;
+  }
+  chunk->output.push_back(std::move(out));
+  work_done_cond_.notify_all();
+  return true;
+}
+
+}   // namespace XVC_NAMESPACE
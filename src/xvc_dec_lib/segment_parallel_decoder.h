@@ -0,0 +1,111 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_DEC_LIB_SEGMENT_PARALLEL_DECODER_H_
+#define XVC_DEC_LIB_SEGMENT_PARALLEL_DECODER_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <utility>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_dec_lib/xvcdec.h"
+
+namespace XVC_NAMESPACE {
+
+class Decoder;
+
+// Decodes chunks of independently decodable segments concurrently, each
+// chunk on its own Decoder instance. A chunk starts at a segment header
+// that follows a closed gop segment, i.e. when the tail pictures of the
+// previous segment do not reference the new intra access picture.
+// Decoded pictures are delivered chunk by chunk in poc order, the oldest
+// chunk delivers its pictures as soon as they are decoded. Each chunk keeps
+// only a few decoded pictures, a worker waits for its output to be taken
+// before decoding more. The number of chunks not yet delivered is limited,
+// adding a chunk blocks until the oldest chunk has output available or
+// has been decoded when the limit is reached.
+class SegmentParallelDecoder {
+public:
+  using DecoderFactory = std::function<std::unique_ptr<Decoder>()>;
+
+  SegmentParallelDecoder(int num_threads, DecoderFactory decoder_factory);
+  ~SegmentParallelDecoder();
+  void AddSegmentHeaderNal(const uint8_t *nal_unit, size_t nal_unit_size,
+                           bool independent_segment);
+  void AddPictureNal(const uint8_t *nal_unit, size_t nal_unit_size,
+                     int64_t user_data, bool tail_picture);
+  void Flush();
+  bool GetDecodedPicture(xvc_decoded_picture *output_pic);
+
+private:
+  using NalUnitPtr = std::unique_ptr<std::vector<uint8_t>>;
+  struct OutputPicture {
+    std::vector<uint8_t> bytes;
+    size_t plane_offset[constants::kMaxYuvComponents];
+    xvc_decoded_picture pic;
+  };
+  struct Chunk {
+    std::unique_ptr<Decoder> decoder;
+    std::vector<std::pair<NalUnitPtr, int64_t>> nals;
+    std::deque<OutputPicture> output;
+    PicNum base_poc = 0;
+    PicNum num_pics = 0;
+    PicNum num_tail_pics = 0;
+    PicNum prev_num_tail_pics = 0;
+    SegmentNum base_soc = 0;
+    SegmentNum num_segments = 0;
+    bool finished = false;
+  };
+  void AddNal(const uint8_t *nal_unit, size_t nal_unit_size,
+              int64_t user_data);
+  void DispatchChunk();
+  void WorkerMain();
+  void DecodeChunk(Chunk *chunk);
+  bool StoreOutputPicture(const xvc_decoded_picture &dec_pic, Chunk *chunk);
+
+  static const int kMaxOutputPicsPerChunk = 4;
+
+  DecoderFactory decoder_factory_;
+  int max_chunks_;
+  std::unique_ptr<Chunk> curr_chunk_;
+  PicNum next_base_poc_ = 0;
+  PicNum prev_num_tail_pics_ = 0;
+  SegmentNum next_base_soc_ = 0;
+  bool flushing_ = false;
+  OutputPicture output_pic_;
+  std::vector<std::thread> worker_threads_;
+  std::mutex global_mutex_;
+  std::condition_variable wait_work_cond_;
+  std::condition_variable work_done_cond_;
+  std::condition_variable output_taken_cond_;
+  // Chunks are kept in bitstream order, pending points to chunks not started
+  std::deque<std::unique_ptr<Chunk>> chunks_;
+  std::deque<Chunk*> pending_chunks_;
+  bool running_ = true;
+};
+
+}   // namespace XVC_NAMESPACE
+
+#endif  // XVC_DEC_LIB_SEGMENT_PARALLEL_DECODER_H_
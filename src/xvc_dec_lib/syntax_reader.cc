@@ -19,6 +19,7 @@
 #include "xvc_dec_lib/syntax_reader.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <utility>
 #include <vector>
@@ -27,7 +28,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 SyntaxReader::SyntaxReader(const Qp &qp, PicturePredictionType pic_type,
                            EntropyDecoder *entropydec)
@@ -48,18 +49,23 @@ int SyntaxReader::ReadQp() {
 }
 
 void SyntaxReader::ReadCoefficients(const CodingUnit &cu, YuvComponent comp,
-                                    Coeff *dst_coeff, ptrdiff_t dst_stride) {
+                                    Coeff *dst_coeff, ptrdiff_t dst_stride,
+                                    int *extent_width, int *extent_height) {
   if (cu.GetWidth(comp) == 2 || cu.GetHeight(comp) == 2) {
-    ReadCoeffSubblock<1>(cu, comp, dst_coeff, dst_stride);
+    ReadCoeffSubblock<1>(cu, comp, dst_coeff, dst_stride,
+                         extent_width, extent_height);
   } else {
     ReadCoeffSubblock<constants::kSubblockShift>(cu, comp,
-                                                 dst_coeff, dst_stride);
+                                                 dst_coeff, dst_stride,
+                                                 extent_width, extent_height);
   }
 }
 
 template<int SubBlockShift>
 void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
-                                     Coeff *dst_coeff, ptrdiff_t dst_stride) {
+                                     Coeff *dst_coeff, ptrdiff_t dst_stride,
+                                     int *extent_width, int *extent_height) {
+  const Restrictions &restrictions = Restrictions::Get();
   const int width = cu.GetWidth(comp);
   const int height = cu.GetHeight(comp);
   const int width_log2 = util::SizeToLog2(width);
@@ -68,12 +74,16 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
   constexpr int subblock_shift = SubBlockShift;
   constexpr int subblock_mask = (1 << subblock_shift) - 1;
   constexpr int subblock_size = 1 << (subblock_shift * 2);
+  constexpr int max_num_subblocks =
+    (constants::kMaxBlockSize >> subblock_shift) *
+    (constants::kMaxBlockSize >> subblock_shift);
 
   int subblock_width = width >> subblock_shift;
   int subblock_height = height >> subblock_shift;
   int nbr_subblocks = subblock_width * subblock_height;
-  std::vector<uint8_t> subblock_csbf(nbr_subblocks);
-  std::vector<uint16_t> scan_subblock_table(nbr_subblocks);
+  std::array<uint8_t, max_num_subblocks> subblock_csbf;
+  std::array<uint16_t, max_num_subblocks> scan_subblock_table;
+  std::fill(subblock_csbf.begin(), subblock_csbf.begin() + nbr_subblocks, 0);
   ScanOrder scan_order = TransformHelper::DetermineScanOrder(cu, comp);
   TransformHelper::DeriveSubblockScan(scan_order, subblock_width,
                                       subblock_height, &scan_subblock_table[0]);
@@ -87,48 +97,43 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
   int coeff_num_non_zero = 0;
   std::array<Coeff, subblock_size> subblock_coeff;
   std::array<uint16_t, subblock_size> subblock_nz_coeff_pos;
+  std::array<ContextModel*, subblock_size> sig_ctx;
 
   int last_nonzero_pos = -1;
   int first_nonzero_pos = subblock_size;
-  if (!Restrictions::Get().disable_transform_last_position) {
+  int max_nonzero_x = -1;
+  int max_nonzero_y = -1;
+  if (!restrictions.disable_transform_last_position) {
     uint32_t pos_last_x, pos_last_y;
     ReadCoeffLastPos(width, height, comp, scan_order, &pos_last_x, &pos_last_y);
     int pos_last = (pos_last_y << log2size) + pos_last_x;
 
-    // determine last subblock
-    int pos_last_index = -1;
-    for (int subblock_index = 0; subblock_index < nbr_subblocks;
-         subblock_index++) {
-      int subblock_scan = scan_subblock_table[subblock_index];
-      int subblock_scan_y = subblock_scan / subblock_width;
-      int subblock_scan_x = subblock_scan - (subblock_scan_y * subblock_width);
-      int subblock_pos_x = subblock_scan_x << subblock_shift;
-      int subblock_pos_y = subblock_scan_y << subblock_shift;
-      for (int coeff_index = 0; coeff_index < subblock_size; coeff_index++) {
-        int scan_offset = scan_table[coeff_index];
-        int coeff_scan_x = subblock_pos_x + (scan_offset & subblock_mask);
-        int coeff_scan_y = subblock_pos_y + (scan_offset >> subblock_shift);
-        int coeff_scan = (coeff_scan_y << log2size) + coeff_scan_x;
-        if (coeff_scan == pos_last) {
-          pos_last_index =
-            (subblock_index << (subblock_shift * 2)) + coeff_index;
-          break;
-        }
-      }
-      if (pos_last_index >= 0) {
-        break;
-      }
+    // determine last subblock and its scan position directly from position
+    int last_subblock_scan =
+      (pos_last_y >> subblock_shift) * subblock_width +
+      (pos_last_x >> subblock_shift);
+    int last_scan_offset =
+      ((pos_last_y & subblock_mask) << subblock_shift) +
+      (pos_last_x & subblock_mask);
+    subblock_last_index = 0;
+    while (scan_subblock_table[subblock_last_index] != last_subblock_scan) {
+      subblock_last_index++;
+      assert(subblock_last_index < nbr_subblocks);
     }
-
-    subblock_last_index =
-      pos_last_index >> (subblock_shift + subblock_shift);
+    int last_coeff_index = 0;
+    while (scan_table[last_coeff_index] != last_scan_offset) {
+      last_coeff_index++;
+      assert(last_coeff_index < subblock_size);
+    }
+    int pos_last_index =
+      (subblock_last_index << (subblock_shift * 2)) + last_coeff_index;
 
     // Special handling of last sig coeff (implicitly signaled)
     subblock_last_coeff_offset =
       ((subblock_last_index + 1) << (subblock_shift + subblock_shift)) -
       pos_last_index + 1;
-    if (Restrictions::Get().disable_transform_cbf &&
-        Restrictions::Get().disable_transform_subblock_csbf &&
+    if (restrictions.disable_transform_cbf &&
+        restrictions.disable_transform_subblock_csbf &&
         pos_last_x == 0 && pos_last_y == 0) {
       subblock_last_coeff_offset--;
     } else {
@@ -136,11 +141,13 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
       coeff_num_non_zero = 1;
     }
     subblock_nz_coeff_pos[0] = static_cast<uint16_t>(pos_last);
-    int subblock_last_offset = subblock_last_index << (subblock_shift * 2);
-    last_nonzero_pos = pos_last_index - subblock_last_offset;
-    first_nonzero_pos = pos_last_index - subblock_last_offset;
+    last_nonzero_pos = last_coeff_index;
+    first_nonzero_pos = last_coeff_index;
   }
 
+  const int max_num_c1_flags =
+    restrictions.disable_transform_residual_greater_than_flags ?
+    0 : constants::kMaxNumC1Flags;
   int c1 = 1;
 
   // foreach subblock
@@ -154,12 +161,12 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
 
     int pattern_sig_ctx = 0;
     bool is_last_subblock = subblock_index == subblock_last_index &&
-      !Restrictions::Get().disable_transform_last_position &&
-      !Restrictions::Get().disable_transform_cbf;
+      !restrictions.disable_transform_last_position &&
+      !restrictions.disable_transform_cbf;
     bool is_first_subblock = subblock_index == 0 &&
-      !Restrictions::Get().disable_transform_cbf;
+      !restrictions.disable_transform_cbf;
     if (is_last_subblock || is_first_subblock ||
-        Restrictions::Get().disable_transform_subblock_csbf) {
+        restrictions.disable_transform_subblock_csbf) {
       subblock_csbf[subblock_scan] = 1;
       // derive pattern_sig_ctx
       ctx_.GetSubblockCsbfCtx(comp, &subblock_csbf[0], subblock_scan_x,
@@ -177,34 +184,50 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
       continue;
     }
 
+    // contexts for sig flags of whole subblock
+    if (SubBlockShift == constants::kSubblockShift) {
+      ctx_.GetCoeffSigCtxSubblock(comp, pattern_sig_ctx, scan_order,
+                                  subblock_pos_x, subblock_pos_y, width_log2,
+                                  height_log2, scan_table, &sig_ctx[0]);
+    } else {
+      for (int coeff_index = 0; coeff_index < subblock_size; coeff_index++) {
+        int scan_offset = scan_table[coeff_index];
+        sig_ctx[coeff_index] =
+          &ctx_.GetCoeffSigCtx(comp, pattern_sig_ctx, scan_order,
+                               subblock_pos_x + (scan_offset & subblock_mask),
+                               subblock_pos_y + (scan_offset >> subblock_shift),
+                               width_log2, height_log2);
+      }
+    }
+
     // sig flags
+    Coeff *dst_subblock =
+      dst_coeff + subblock_pos_y * dst_stride + subblock_pos_x;
+    const int subblock_offset = (subblock_pos_y << log2size) + subblock_pos_x;
+    const bool not_first_subblock = subblock_index > 0 &&
+      !restrictions.disable_transform_subblock_csbf;
     for (int coeff_index = subblock_size - subblock_last_coeff_offset;
          coeff_index >= 0; coeff_index--) {
       int scan_offset = scan_table[coeff_index];
-      int coeff_scan_x = subblock_pos_x + (scan_offset & subblock_mask);
-      int coeff_scan_y = subblock_pos_y + (scan_offset >> subblock_shift);
+      int offset_x = scan_offset & subblock_mask;
+      int offset_y = scan_offset >> subblock_shift;
       bool sig_coeff;
-      bool not_first_subblock = subblock_index > 0 &&
-        !Restrictions::Get().disable_transform_subblock_csbf;
       if (coeff_index == 0 && not_first_subblock && coeff_num_non_zero == 0) {
         sig_coeff = true;
       } else {
-        ContextModel &ctx =
-          ctx_.GetCoeffSigCtx(comp, pattern_sig_ctx, scan_order, coeff_scan_x,
-                              coeff_scan_y, width_log2, height_log2);
-        sig_coeff = entropydec_->DecodeBin(&ctx) != 0;
+        sig_coeff = entropydec_->DecodeBin(sig_ctx[coeff_index]) != 0;
       }
       if (sig_coeff) {
         subblock_coeff[coeff_num_non_zero] = 1;
         subblock_nz_coeff_pos[coeff_num_non_zero] = static_cast<uint16_t>(
-          (coeff_scan_y << log2size) + coeff_scan_x);
+          subblock_offset + (offset_y << log2size) + offset_x);
         coeff_num_non_zero++;
         if (last_nonzero_pos == -1) {
           last_nonzero_pos = coeff_index;
         }
         first_nonzero_pos = coeff_index;
       } else {
-        dst_coeff[coeff_scan_y * dst_stride + coeff_scan_x] = 0;
+        dst_subblock[offset_y * dst_stride + offset_x] = 0;
       }
     }
     subblock_last_coeff_offset = 1;
@@ -220,20 +243,14 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
     int first_c2_idx = -1;
 
     // greater than 1 flag
-    int max_num_c1_flags = constants::kMaxNumC1Flags;
-    if (Restrictions::Get().disable_transform_residual_greater_than_flags) {
-      max_num_c1_flags = 0;
-    }
-    for (int i = 0; i < coeff_num_non_zero; i++) {
-      if (i == max_num_c1_flags) {
-        break;
-      }
+    const int num_c1_flags = std::min(coeff_num_non_zero, max_num_c1_flags);
+    for (int i = 0; i < num_c1_flags; i++) {
       ContextModel &ctx = ctx_.GetCoeffGreaterThan1Ctx(comp, ctx_set, c1);
       uint32_t greater_than_1 = entropydec_->DecodeBin(&ctx);
       if (greater_than_1) {
         c1 = 0;
         if (first_c2_idx == -1 &&
-            !Restrictions::Get().disable_transform_residual_greater2) {
+            !restrictions.disable_transform_residual_greater2) {
           first_c2_idx = i;
         }
         subblock_coeff[i] = 2;
@@ -251,7 +268,7 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
 
     // sign hiding
     bool sign_hidden = false;
-    if (!Restrictions::Get().disable_transform_sign_hiding &&
+    if (!restrictions.disable_transform_sign_hiding &&
         last_nonzero_pos - first_nonzero_pos > constants::SignHidingThreshold) {
       sign_hidden = true;
     }
@@ -271,7 +288,7 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
     // abs level remaining
     if (c1 == 0 || coeff_num_non_zero > max_num_c1_flags) {
       int first_coeff_greater2 =
-        Restrictions::Get().disable_transform_residual_greater2 ? 0 : 1;
+        restrictions.disable_transform_residual_greater2 ? 0 : 1;
       uint32_t golomb_rice_k = 0;
       for (int i = 0; i < coeff_num_non_zero; i++) {
         Coeff base_level = static_cast<Coeff>(
@@ -280,7 +297,7 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
           subblock_coeff[i] +=
             static_cast<Coeff>(ReadCoeffRemainExpGolomb(golomb_rice_k));
           if (subblock_coeff[i] > 3 * (1 << golomb_rice_k) &&
-              !Restrictions::Get().disable_transform_adaptive_exp_golomb) {
+              !restrictions.disable_transform_adaptive_exp_golomb) {
             golomb_rice_k = std::min(golomb_rice_k + 1, (uint32_t)4);
           }
         }
@@ -295,6 +312,8 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
       int coeff_scan = subblock_nz_coeff_pos[i];
       int y = coeff_scan >> log2size;
       int x = coeff_scan - (y << log2size);
+      max_nonzero_x = std::max(max_nonzero_x, x);
+      max_nonzero_y = std::max(max_nonzero_y, y);
 
       Coeff coeff = subblock_coeff[i];
       abs_sum += coeff;
@@ -311,6 +330,8 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
 
     coeff_num_non_zero = 0;
   }
+  *extent_width = max_nonzero_x + 1;
+  *extent_height = max_nonzero_y + 1;
 }
 
 bool SyntaxReader::ReadEndOfSlice() {
@@ -632,4 +653,4 @@ uint32_t SyntaxReader::ReadUnaryMaxSymbol(uint32_t max_val,
   return symbol;
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -27,7 +27,7 @@
 #include "xvc_common_lib/transform.h"
 #include "xvc_dec_lib/entropy_decoder.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class SyntaxReader {
 public:
@@ -35,8 +35,10 @@ public:
                EntropyDecoder *entropydec);
   bool ReadCbf(const CodingUnit &cu, YuvComponent comp);
   int ReadQp();
+  // Also returns the size of the region holding all non-zero coefficients
   void ReadCoefficients(const CodingUnit &cu, YuvComponent comp,
-                        Coeff *dst_coeff, ptrdiff_t dst_coeff_stride);
+                        Coeff *dst_coeff, ptrdiff_t dst_coeff_stride,
+                        int *extent_width, int *extent_height);
   bool ReadEndOfSlice();
   IntraMode ReadIntraMode(const IntraPredictorLuma &mpm);
   InterDir ReadInterDir(const CodingUnit &cu);
@@ -57,7 +59,8 @@ public:
 private:
   template<int SubBlockShift>
   void ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
-                         Coeff *dst_coeff, ptrdiff_t dst_coeff_stride);
+                         Coeff *dst_coeff, ptrdiff_t dst_coeff_stride,
+                         int *extent_width, int *extent_height);
   void ReadCoeffLastPos(int width, int height, YuvComponent comp,
                         ScanOrder scan_order, uint32_t *pos_last_x,
                         uint32_t *pos_last_y);
@@ -70,6 +73,6 @@ private:
   EntropyDecoder *entropydec_;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_SYNTAX_READER_H_
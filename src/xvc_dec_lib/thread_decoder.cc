@@ -18,21 +18,17 @@
 
 #include "xvc_dec_lib/thread_decoder.h"
 
-#include <algorithm>
+namespace XVC_NAMESPACE {
 
-namespace xvc {
+ThreadDecoder::ThreadDecoder(int num_threads)
+  : own_thread_pool_(new DecoderThreadPool(num_threads)),
+  thread_pool_(own_thread_pool_.get()) {
+  thread_pool_->Attach(this, [this]() { return TakeWork(); }, 0);
+}
 
-ThreadDecoder::ThreadDecoder(int num_threads) {
-  if (num_threads < 0) {
-    num_threads = std::thread::hardware_concurrency();
-  }
-  // Need at least one thread to work
-  num_threads = std::max(1, num_threads);
-  while (num_threads > static_cast<int>(worker_threads_.size())) {
-    worker_threads_.emplace_back([this] {
-      WorkerMain();
-    });
-  }
+ThreadDecoder::ThreadDecoder(DecoderThreadPool *thread_pool, int priority)
+  : thread_pool_(thread_pool) {
+  thread_pool_->Attach(this, [this]() { return TakeWork(); }, priority);
 }
 
 ThreadDecoder::~ThreadDecoder() {
@@ -42,12 +38,11 @@ ThreadDecoder::~ThreadDecoder() {
 void ThreadDecoder::StopAll() {
   std::unique_lock<std::mutex> lock(global_mutex_);
   running_ = false;
-  wait_work_cond_.notify_all();  // wakeup all
+  // Pictures not yet started are dropped
+  work_done_cond_.wait(lock, [this] { return jobs_running_ == 0; });
   lock.unlock();
-  for (auto &thread : worker_threads_) {
-    thread.join();
-  }
-  worker_threads_.clear();
+  thread_pool_->Detach(this);
+  own_thread_pool_.reset();
 }
 
 void ThreadDecoder::DecodeAsync(
@@ -63,11 +58,12 @@ void ThreadDecoder::DecodeAsync(
   work.nal_offset = nal_offset;
   work.nal = std::move(nal);
 
-  // Signal one worker thread to begin processing
   std::unique_lock<std::mutex> lock(global_mutex_);
   pending_work_.push_back(std::move(work));
   jobs_in_flight_++;
-  wait_work_cond_.notify_one();
+  lock.unlock();
+  // Signal worker threads to begin processing
+  thread_pool_->NotifyWorkAvailable();
 }
 
 void ThreadDecoder::WaitForPicture(const std::shared_ptr<PictureDecoder> &pic,
@@ -87,6 +83,17 @@ void ThreadDecoder::WaitOne(PictureDecodedCallback callback) {
   callback(work.pic_dec, work.success, work.inter_dependencies);
 }
 
+void ThreadDecoder::PollFinished(PictureDecodedCallback callback) {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  while (!finished_work_.empty()) {
+    WorkItem work = std::move(finished_work_.front());
+    finished_work_.pop_front();
+    jobs_in_flight_--;
+    // Note! Callback invoked while lock is held
+    callback(work.pic_dec, work.success, work.inter_dependencies);
+  }
+}
+
 void ThreadDecoder::WaitAll(PictureDecodedCallback callback) {
   std::unique_lock<std::mutex> lock(global_mutex_);
   while (jobs_in_flight_ > 0) {
@@ -99,65 +106,64 @@ void ThreadDecoder::WaitAll(PictureDecodedCallback callback) {
   }
 }
 
-void ThreadDecoder::WorkerMain() {
+DecoderThreadPool::Job ThreadDecoder::TakeWork() {
   std::unique_lock<std::mutex> lock(global_mutex_);
-  while (true) {
-    ThreadDecoder::WorkItem work;
-    // Find one picture that can be decoded now
-    wait_work_cond_.wait(lock, [this, &work] {
-      if (!running_) {
-        return true;
-      }
-      if (pending_work_.empty()) {
-        return false;
-      }
-      // Verify all dependencies are satisfied before taking work
-      auto it = pending_work_.begin();
-      for (; it != pending_work_.end(); ++it) {
-        bool valid = true;
-        for (auto &dependency : it->inter_dependencies) {
-          if (dependency->GetOutputStatus() == OutputStatus::kProcessing) {
-            valid = false;
-            break;
-          }
-        }
-        if (!valid) {
-          continue;
-        }
-        work = std::move(*it);
-        pending_work_.erase(it);
-        return true;
+  if (!running_) {
+    return nullptr;
+  }
+  // Find one picture that can be decoded now by verifying that all
+  // dependencies are satisfied before taking work
+  for (auto it = pending_work_.begin(); it != pending_work_.end(); ++it) {
+    bool valid = true;
+    for (auto &dependency : it->inter_dependencies) {
+      if (dependency->GetOutputStatus() == OutputStatus::kProcessing) {
+        valid = false;
+        break;
       }
-      return false;
-    });
-    if (!running_) {
-      break;
     }
-    lock.unlock();
-
-    // Load restriction flags for current thread unles already done
-    thread_local SegmentNum restriction_soc = static_cast<SegmentNum>(-1);
-    if (restriction_soc != work.segment_header->soc) {
-      Restrictions::GetRW() = work.segment_header->restrictions;
-      restriction_soc = work.segment_header->soc;
+    if (!valid) {
+      continue;
     }
-
-    // Decode picture
-    BitReader bit_reader(&(*work.nal)[0] + work.nal_offset,
-                         work.nal->size() - work.nal_offset);
-    work.success = work.pic_dec->Decode(*work.segment_header, &bit_reader);
-
-    lock.lock();
-    // Mark the picture as fully processed, this unlocks dependencies for
-    // other work items without any roundtrip to main thread
-    work.pic_dec->SetOutputStatus(OutputStatus::kFinishedProcessing);
-    // Notify all workers that a dependency might be ready
-    wait_work_cond_.notify_all();
-    // Notify main thread picture is done
-    // TODO(PH) some fields are not needed anymore (like nal)
-    finished_work_.push_back(std::move(work));
-    work_done_cond_.notify_all();
+    std::shared_ptr<WorkItem> work = std::make_shared<WorkItem>();
+    *work = std::move(*it);
+    pending_work_.erase(it);
+    jobs_running_++;
+    return [this, work]() {
+      DecodeWork(work.get());
+    };
   }
+  return nullptr;
+}
+
+void ThreadDecoder::DecodeWork(WorkItem *work) {
+  // Restriction flags are thread local and the worker thread might be
+  // shared with decoders of other bitstreams
+  Restrictions::GetRW() = work->segment_header->restrictions;
+
+  // Decode picture
+  BitReader bit_reader(&(*work->nal)[0] + work->nal_offset,
+                       work->nal->size() - work->nal_offset);
+  work->success = work->pic_dec->Decode(*work->segment_header, &bit_reader);
+
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  // Mark the picture as fully processed, this unlocks dependencies for
+  // other work items without any roundtrip to main thread
+  work->pic_dec->SetOutputStatus(OutputStatus::kFinishedProcessing);
+  lock.unlock();
+  // Notify all workers that a dependency might be ready
+  thread_pool_->NotifyWorkAvailable();
+
+  // Convert to output format while dependent pictures are being decoded,
+  // the reconstructed picture is only read from here on
+  work->pic_dec->PrepareOutputPicture();
+
+  lock.lock();
+  // Notify main thread picture is done
+  // TODO(PH) some fields are not needed anymore (like nal)
+  finished_work_.push_back(std::move(*work));
+  jobs_running_--;
+  // Note! This object might be destroyed as soon as the lock is released
+  work_done_cond_.notify_all();
 }
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
@@ -26,13 +26,13 @@
 #include <list>
 #include <memory>
 #include <mutex>                // NOLINT
-#include <thread>               // NOLINT
 #include <vector>
 
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_dec_lib/decoder_thread_pool.h"
 #include "xvc_dec_lib/picture_decoder.h"
 
-namespace xvc {
+namespace XVC_NAMESPACE {
 
 class ThreadDecoder {
 public:
@@ -42,6 +42,8 @@ public:
                        const PicDecList &)>;
 
   explicit ThreadDecoder(int num_threads);
+  // Decode using the workers of a pool shared with other decoders
+  ThreadDecoder(DecoderThreadPool *thread_pool, int priority);
   ~ThreadDecoder();
   void StopAll();
   void DecodeAsync(std::shared_ptr<SegmentHeader> &&segment_header,
@@ -52,6 +54,7 @@ public:
   void WaitForPicture(const std::shared_ptr<PictureDecoder> &pic,
                       PictureDecodedCallback callback);
   void WaitOne(PictureDecodedCallback callback);
+  void PollFinished(PictureDecodedCallback callback);
   void WaitAll(PictureDecodedCallback callback);
 
 private:
@@ -60,21 +63,23 @@ private:
     std::vector<std::shared_ptr<const PictureDecoder>> inter_dependencies;
     std::shared_ptr<SegmentHeader> segment_header;
     std::unique_ptr<std::vector<uint8_t>> nal;
-    std::size_t nal_offset;
-    bool success;
+    std::size_t nal_offset = 0;
+    bool success = false;
   };
-  void WorkerMain();
+  DecoderThreadPool::Job TakeWork();
+  void DecodeWork(WorkItem *work);
 
-  std::vector<std::thread> worker_threads_;
+  std::unique_ptr<DecoderThreadPool> own_thread_pool_;
+  DecoderThreadPool *thread_pool_;
   std::mutex global_mutex_;
-  std::condition_variable wait_work_cond_;
   std::condition_variable work_done_cond_;
   std::list<WorkItem> pending_work_;
   std::deque<WorkItem> finished_work_;
   int jobs_in_flight_ = 0;
+  int jobs_running_ = 0;
   bool running_ = true;
 };
 
-}   // namespace xvc
+}   // namespace XVC_NAMESPACE
 
 #endif  // XVC_DEC_LIB_THREAD_DECODER_H_
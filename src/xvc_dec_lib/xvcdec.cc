@@ -21,6 +21,10 @@
 #include <cstring>
 
 #include "xvc_dec_lib/decoder.h"
+#include "xvc_dec_lib/decoder_thread_pool.h"
+#if XVC_8BIT_VARIANT || XVC_DEC_8BIT_DISPATCH
+#include "xvc_dec_lib/bitdepth_dispatcher.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,9 +54,16 @@ extern "C" {
     param->output_chroma_format = XVC_DEC_CHROMA_FORMAT_UNDEFINED;
     param->output_color_matrix = XVC_DEC_COLOR_MATRIX_UNDEFINED;
     param->output_bitdepth = 0;
-    param->max_framerate = xvc::constants::kTimeScale;
+    param->max_framerate = XVC_NAMESPACE::constants::kTimeScale;
     param->threads = -1;
     param->simd_mask = static_cast<uint32_t>(-1);
+    param->parallel_segments = 0;
+    param->real_time = 0;
+    param->low_delay = 0;
+    param->output_callback = nullptr;
+    param->output_callback_opaque = nullptr;
+    param->thread_pool = nullptr;
+    param->thread_priority = 0;
     return XVC_DEC_OK;
   }
 
@@ -89,11 +100,19 @@ extern "C" {
       (param->output_bitdepth > 16 || param->output_bitdepth < 8)) {
       return XVC_DEC_BITDEPTH_OUT_OF_RANGE;
     }
-    if (param->max_framerate < (1.0 * xvc::constants::kTimeScale /
-      (1 << xvc::constants::kFrameRateBitDepth)) ||
-        param->max_framerate > xvc::constants::kTimeScale) {
+    if (param->max_framerate < (1.0 * XVC_NAMESPACE::constants::kTimeScale /
+      (1 << XVC_NAMESPACE::constants::kFrameRateBitDepth)) ||
+        param->max_framerate > XVC_NAMESPACE::constants::kTimeScale) {
       return XVC_DEC_FRAMERATE_OUT_OF_RANGE;
     }
+    // Segment parallel decoding uses its own threads and decoder instances
+    // and only supports buffered output through decoder_get_picture
+    if (param->parallel_segments != 0 &&
+        (param->thread_pool || param->thread_priority != 0 ||
+         param->low_delay != 0 || param->real_time != 0 ||
+         param->output_callback)) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
     return XVC_DEC_OK;
   }
 
@@ -111,21 +130,38 @@ extern "C" {
     if (xvc_dec_parameters_check(param) != XVC_DEC_OK) {
       return nullptr;
     }
-    xvc::Decoder *decoder = new xvc::Decoder(param->threads);
-    decoder->SetCpuCapabilities(xvc::SimdCpu::GetMaskedCaps(param->simd_mask));
+    XVC_NAMESPACE::Decoder *decoder;
+    if (param->parallel_segments != 0) {
+      // Parallelism comes from segments instead of pictures in parallel mode
+      decoder = new XVC_NAMESPACE::Decoder(0);
+    } else if (param->thread_pool) {
+      decoder = new XVC_NAMESPACE::Decoder(param->thread_pool,
+                                           param->thread_priority);
+    } else {
+      decoder = new XVC_NAMESPACE::Decoder(param->threads);
+    }
+    decoder->SetCpuCapabilities(
+      XVC_NAMESPACE::SimdCpu::GetMaskedCaps(param->simd_mask));
     decoder->SetOutputWidth(param->output_width);
     decoder->SetOutputHeight(param->output_height);
     decoder->SetOutputChromaFormat(param->output_chroma_format);
     decoder->SetOutputColorMatrix(param->output_color_matrix);
     decoder->SetOutputBitdepth(param->output_bitdepth);
-    decoder->SetDecoderTicks(static_cast<int>(xvc::constants::kTimeScale
-                                              / param->max_framerate + 0.5));
+    decoder->SetDecoderTicks(
+      static_cast<int>(XVC_NAMESPACE::constants::kTimeScale
+                       / param->max_framerate + 0.5));
+    decoder->SetParallelSegments(param->parallel_segments);
+    decoder->SetRealTimeMode(param->real_time != 0);
+    decoder->SetLowDelay(param->low_delay != 0);
+    decoder->SetOutputCallback(param->output_callback,
+                               param->output_callback_opaque);
     return decoder;
   }
 
   static xvc_dec_return_code xvc_dec_decoder_destroy(xvc_decoder *decoder) {
     if (decoder) {
-      xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+      XVC_NAMESPACE::Decoder *lib_decoder =
+        reinterpret_cast<XVC_NAMESPACE::Decoder*>(decoder);
       delete lib_decoder;
     }
     return XVC_DEC_OK;
@@ -137,12 +173,15 @@ extern "C" {
     if (xvc_dec_parameters_check(param) != XVC_DEC_OK) {
       return XVC_DEC_INVALID_ARGUMENT;
     }
-    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    XVC_NAMESPACE::Decoder *lib_decoder =
+      reinterpret_cast<XVC_NAMESPACE::Decoder*>(decoder);
 
-    // Framerate is the only parameter that is updated.
+    // Framerate and real-time mode are the only parameters that are updated.
     // Changes in other parameters will be ignored.
-    lib_decoder->SetDecoderTicks(static_cast<int>(xvc::constants::kTimeScale
-                                                  / param->max_framerate + .5));
+    lib_decoder->SetDecoderTicks(
+      static_cast<int>(XVC_NAMESPACE::constants::kTimeScale
+                       / param->max_framerate + .5));
+    lib_decoder->SetRealTimeMode(param->real_time != 0);
     return XVC_DEC_OK;
   }
 
@@ -152,17 +191,19 @@ extern "C" {
     if (!decoder || !nal_unit || nal_unit_size < 1) {
       return XVC_DEC_INVALID_ARGUMENT;
     }
-    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    XVC_NAMESPACE::Decoder *lib_decoder =
+      reinterpret_cast<XVC_NAMESPACE::Decoder*>(decoder);
     lib_decoder->DecodeNal(nal_unit, nal_unit_size, user_data);
 
-    xvc::Decoder::State dec_state = lib_decoder->GetState();
-    if (dec_state == xvc::Decoder::State::kDecoderVersionTooLow) {
+    XVC_NAMESPACE::Decoder::State dec_state = lib_decoder->GetState();
+    if (dec_state == XVC_NAMESPACE::Decoder::State::kDecoderVersionTooLow) {
       return XVC_DEC_BITSTREAM_VERSION_HIGHER_THAN_DECODER;
-    } else if (dec_state == xvc::Decoder::State::kBitstreamBitdepthTooHigh) {
+    } else if (dec_state ==
+               XVC_NAMESPACE::Decoder::State::kBitstreamBitdepthTooHigh) {
       return XVC_DEC_BITSTREAM_BITDEPTH_TOO_HIGH;
-    } else if (dec_state == xvc::Decoder::State::kNoSegmentHeader) {
+    } else if (dec_state == XVC_NAMESPACE::Decoder::State::kNoSegmentHeader) {
       return XVC_DEC_NO_SEGMENT_HEADER_DECODED;
-    } else if (dec_state == xvc::Decoder::State::kChecksumMismatch) {
+    } else if (dec_state == XVC_NAMESPACE::Decoder::State::kChecksumMismatch) {
       return XVC_DEC_NOT_CONFORMING;
     }
     return XVC_DEC_OK;
@@ -174,12 +215,13 @@ extern "C" {
     if (!decoder || !pic_bytes) {
       return XVC_DEC_INVALID_ARGUMENT;
     }
-    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    XVC_NAMESPACE::Decoder *lib_decoder =
+      reinterpret_cast<XVC_NAMESPACE::Decoder*>(decoder);
     if (lib_decoder->GetDecodedPicture(pic_bytes)) {
       return XVC_DEC_OK;
     }
-    xvc::Decoder::State dec_state = lib_decoder->GetState();
-    if (dec_state == xvc::Decoder::State::kNoSegmentHeader) {
+    XVC_NAMESPACE::Decoder::State dec_state = lib_decoder->GetState();
+    if (dec_state == XVC_NAMESPACE::Decoder::State::kNoSegmentHeader) {
       return XVC_DEC_NO_SEGMENT_HEADER_DECODED;
     }
     return XVC_DEC_NO_DECODED_PIC;
@@ -190,7 +232,8 @@ extern "C" {
     if (!decoder) {
       return XVC_DEC_INVALID_ARGUMENT;
     }
-    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    XVC_NAMESPACE::Decoder *lib_decoder =
+      reinterpret_cast<XVC_NAMESPACE::Decoder*>(decoder);
     lib_decoder->FlushBufferedNalUnits();
     return XVC_DEC_OK;
   }
@@ -201,7 +244,8 @@ extern "C" {
     if (!decoder) {
       return XVC_DEC_INVALID_ARGUMENT;
     }
-    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    XVC_NAMESPACE::Decoder *lib_decoder =
+      reinterpret_cast<XVC_NAMESPACE::Decoder*>(decoder);
     int num_corrupted =
       static_cast<uint32_t>(lib_decoder->GetNumCorruptedPics());
     if (out_num) {
@@ -245,6 +289,19 @@ extern "C" {
     }
   }
 
+  static xvc_decoder_thread_pool*
+    xvc_dec_thread_pool_create(int num_threads) {
+    return new XVC_NAMESPACE::DecoderThreadPool(num_threads);
+  }
+
+  static xvc_dec_return_code
+    xvc_dec_thread_pool_destroy(xvc_decoder_thread_pool *thread_pool) {
+    if (thread_pool) {
+      delete thread_pool;
+    }
+    return XVC_DEC_OK;
+  }
+
   static const xvc_decoder_api xvc_dec_api_internal = {
     &xvc_dec_parameters_create,
     &xvc_dec_parameters_destroy,
@@ -260,10 +317,39 @@ extern "C" {
     &xvc_dec_decoder_flush,
     &xvc_dec_decoder_check_conformance,
     &xvc_dec_get_error_text,
+    &xvc_dec_thread_pool_create,
+    &xvc_dec_thread_pool_destroy,
   };
 
+#if XVC_8BIT_VARIANT
+  const xvc_decoder_api* xvc_decoder_api_get_8bit() {
+#elif XVC_DEC_8BIT_DISPATCH
+  const xvc_decoder_api* xvc_decoder_api_get_16bit() {
+#else
   const xvc_decoder_api* xvc_decoder_api_get() {
+#endif
     return &xvc_dec_api_internal;
   }
 
+#if XVC_8BIT_VARIANT
+  xvc_dec_return_code
+    xvc_decoder_flush_tail_pictures_8bit(xvc_decoder *decoder,
+                                         const uint8_t *nal_unit,
+                                         size_t nal_unit_size,
+                                         int64_t user_data,
+                                         const uint8_t *pic_bytes) {
+    if (!decoder || !nal_unit || nal_unit_size < 1 || !pic_bytes) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    XVC_NAMESPACE::Decoder *lib_decoder =
+      reinterpret_cast<XVC_NAMESPACE::Decoder*>(decoder);
+    if (!lib_decoder->AddIntraAccessPicture(nal_unit, nal_unit_size,
+                                            user_data, pic_bytes)) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    lib_decoder->FlushTailPictures();
+    return XVC_DEC_OK;
+  }
+#endif
+
 }  // extern C
@@ -90,10 +90,19 @@ extern "C" {
     int64_t user_data;  //
   } xvc_decoded_picture;
 
+  // Application callback for delivery of decoded pictures
+  typedef void(*xvc_dec_output_callback)(void *opaque,
+                                         const xvc_decoded_picture *pic);
+
   // xvc decoder instance
   // Lifecycle managed by api->decoder_create & api->decoder_destroy
   typedef struct xvc_decoder xvc_decoder;
 
+  // Worker threads that can be shared by several decoder instances
+  // Lifecycle managed by api->thread_pool_create & api->thread_pool_destroy
+  // The pool must be destroyed after all decoders using it
+  typedef struct xvc_decoder_thread_pool xvc_decoder_thread_pool;
+
   // xvc decoder configuration
   // Lifecycle managed by api->parameters_create & api->parameters_destroy
   typedef struct xvc_decoder_parameters {
@@ -105,6 +114,27 @@ extern "C" {
     double max_framerate;
     int threads;
     uint32_t simd_mask;
+    // Number of closed gop segments to decode concurrently (0 = disabled)
+    // Can not be combined with real_time, low_delay, output_callback,
+    // thread_pool or thread_priority.
+    int parallel_segments;
+    // Drop temporal layers when decoding can not keep up with the
+    // presentation deadline of each picture (0 = disabled)
+    int real_time;
+    // Output each picture as soon as it is decoded and all pictures with
+    // lower poc have been output (0 = disabled)
+    int low_delay;
+    // Optional callback invoked for each decoded picture in output order
+    // from within decoder_decode_nal and decoder_flush. The picture is only
+    // valid during the callback. Leave as NULL to use decoder_get_picture.
+    xvc_dec_output_callback output_callback;
+    void *output_callback_opaque;
+    // Optional thread pool shared with other decoders, replaces the threads
+    // of the decoder instance. Not used together with parallel_segments.
+    xvc_decoder_thread_pool *thread_pool;
+    // Pictures of decoders with higher priority are decoded first when
+    // sharing a thread pool, equal priorities are served in turn
+    int thread_priority;
   } xvc_decoder_parameters;
 
   // xvc decoder api
@@ -140,6 +170,10 @@ extern "C" {
                                                     int *num);
     // Misc
     const char*(*xvc_dec_get_error_text)(xvc_dec_return_code error_code);
+    // Thread pool (num_threads < 0 = use all cpu cores)
+    xvc_decoder_thread_pool* (*thread_pool_create)(int num_threads);
+    xvc_dec_return_code(*thread_pool_destroy)(
+      xvc_decoder_thread_pool *thread_pool);
   } xvc_decoder_api;
 
   // Starting point for using the xvc decoder api
@@ -31,10 +31,23 @@ void BitWriter::WriteBit(uint32_t bit_val) {
 }
 
 void BitWriter::WriteBits(uint32_t bits, int num_bits) {
-  uint32_t mask = 1 << (num_bits - 1);
-  while (mask) {
-    WriteBit((bits & (mask)) ? 1 : 0);
-    mask >>= 1;
+  assert(num_bits >= 0 && num_bits <= 32);
+  // Fill up the partially written byte first
+  if (shift_ && num_bits > 0) {
+    int n = num_bits < shift_ ? num_bits : shift_;
+    num_bits -= n;
+    shift_ -= n;
+    uint32_t val = (bits >> num_bits) & ((1u << n) - 1);
+    buffer_.back() |= static_cast<uint8_t>(val << shift_);
+  }
+  // Then output whole bytes, most significant first
+  while (num_bits >= 8) {
+    num_bits -= 8;
+    buffer_.push_back(static_cast<uint8_t>(bits >> num_bits));
+  }
+  if (num_bits > 0) {
+    shift_ = 8 - num_bits;
+    buffer_.push_back(static_cast<uint8_t>(bits << shift_));
   }
 }
 
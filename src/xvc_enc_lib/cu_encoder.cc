@@ -25,12 +25,17 @@
 #include <limits>
 #include <utility>
 
+#include "xvc_common_lib/inter_prediction.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 #include "xvc_enc_lib/sample_metric.h"
 
 namespace xvc {
 
+// Samples next to the refresh boundary that are read by the luma deblocking
+// filter decision of the edge, chroma filtering reaches less far
+static const int kIntraRefreshDeblockMargin = 4;
+
 struct CuEncoder::RdoCost {
   RdoCost() = default;
   explicit RdoCost(Cost c) : cost(c), dist(0) {}
@@ -43,7 +48,9 @@ struct CuEncoder::RdoCost {
 CuEncoder::CuEncoder(const SimdFunctions &simd,
                      const YuvPicture &orig_pic, YuvPicture *rec_pic,
                      PictureData *pic_data,
-                     const EncoderSettings &encoder_settings)
+                     const EncoderSettings &encoder_settings,
+                     const std::vector<std::shared_ptr<SubpelPlanes>>
+                     &ref_subpel_planes)
   : TransformEncoder(rec_pic->GetBitdepth(), pic_data->GetMaxNumComponents(),
                      orig_pic, encoder_settings),
   orig_pic_(orig_pic),
@@ -51,7 +58,8 @@ CuEncoder::CuEncoder(const SimdFunctions &simd,
   rec_pic_(*rec_pic),
   pic_data_(*pic_data),
   inter_search_(simd, rec_pic->GetBitdepth(), pic_data->GetMaxNumComponents(),
-                orig_pic, *pic_data->GetRefPicLists(), encoder_settings),
+                orig_pic, *pic_data->GetRefPicLists(), encoder_settings,
+                ref_subpel_planes),
   intra_search_(rec_pic->GetBitdepth(), *pic_data, orig_pic, encoder_settings),
   cu_writer_(pic_data_, &intra_search_),
   cu_cache_(pic_data) {
@@ -63,6 +71,13 @@ CuEncoder::CuEncoder(const SimdFunctions &simd,
         pic_data_.CreateCu(cu_tree, depth, -1, -1, 0, 0);
     }
   }
+  if (encoder_settings_.intra_refresh_period > 0 && !pic_data_.IsIntraPic()) {
+    GetIntraRefreshColumn(pic_data_.GetDoc(), &intra_refresh_start_x_,
+                          &intra_refresh_end_x_);
+    // Intra prediction in the refreshed area must not read above right
+    // samples from the area that is not yet refreshed
+    intra_search_.SetAboveRightLimit(intra_refresh_end_x_);
+  }
 }
 
 CuEncoder::~CuEncoder() {
@@ -165,7 +180,6 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
     Bits full_bits = best_writer.GetNumWrittenBits() - start_bits;
     best_cost.cost =
       best_cost.dist + static_cast<Cost>(full_bits * qp.GetLambda() + 0.5);
-    cu->SaveStateTo(best_state, rec_pic_);
   }
 
   // Encoder split speed-up
@@ -174,6 +188,13 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
     *writer = best_writer;
     return best_cost.dist;
   }
+  if (do_full) {
+    cu->SaveStateTo(best_state, rec_pic_);
+  }
+  // Samples and coefficients of a losing split are left in place until
+  // another split has overwritten them or the best state must be final,
+  // since every split alternative reconstructs the full cu area
+  bool restore_best_state = false;
 
   bool best_binary_depth_greater_than_one = false;
   Cost hor_cost = 0;
@@ -199,10 +220,10 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
       }
       best_cost = split_cost;
       best_writer = splitcu_writer;
+      restore_best_state = false;
       cu->SaveStateTo(best_state, rec_pic_);
     } else {
-      // Restore (previous) best state
-      cu->LoadStateFrom(*best_state, &rec_pic_);
+      restore_best_state = true;
       pic_data_.MarkUsedInPic(cu);
     }
   }
@@ -231,10 +252,10 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
       }
       best_cost = split_cost;
       best_writer = splitcu_writer;
+      restore_best_state = false;
       cu->SaveStateTo(best_state, rec_pic_);
     } else {
-      // Restore (previous) best state
-      cu->LoadStateFrom(*best_state, &rec_pic_);
+      restore_best_state = true;
       pic_data_.MarkUsedInPic(cu);
     }
   }
@@ -248,6 +269,9 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
 
   // Encoder quad split speed-up
   if (can_skip_quad_split) {
+    if (restore_best_state) {
+      cu->LoadStateFrom(*best_state, &rec_pic_);
+    }
     *writer = best_writer;
     return best_cost.dist;
   }
@@ -268,6 +292,8 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
       cu->LoadStateFrom(*best_state, &rec_pic_);
       pic_data_.MarkUsedInPic(cu);
     }
+  } else if (restore_best_state) {
+    cu->LoadStateFrom(*best_state, &rec_pic_);
   }
 
   *writer = best_writer;
@@ -380,15 +406,21 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
   const int cu_tree = static_cast<int>(cu->GetCuTree());
   CuCache::Result cache_result = cu_cache_.Lookup(*cu);
 
+  // Ctus in the intra refresh column are always intra coded
+  const int cu_pos_x = cu->GetPosX(YuvComponent::kY);
+  const bool intra_refresh_cu = cu_pos_x >= intra_refresh_start_x_ &&
+    cu_pos_x < intra_refresh_end_x_;
+
   RdoCost best_cost(std::numeric_limits<Cost>::max());
   if (encoder_settings_.skip_mode_decision_for_identical_cu &&
-      cache_result.cu && cu->IsFirstCuInQuad(cu->GetDepth() - 1)) {
+      cache_result.cu && cu->IsFirstCuInQuad(cu->GetDepth() - 1) &&
+      !intra_refresh_cu) {
     // Use cached CU
     cu->CopyPredictionDataFrom(*cache_result.cu);
     best_cost.cost = 0;
     best_cost.dist = CompressFast(cu, qp, *writer);
-  } else if (pic_data_.IsIntraPic()) {
-    // Intra pic
+  } else if (pic_data_.IsIntraPic() || intra_refresh_cu) {
+    // Intra pic or intra refresh column
     best_cost = CompressIntra(cu, qp, *writer);
   } else {
     // Inter pic
@@ -406,11 +438,14 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
       cache_result.any_inter;
 
     RdoCost cost;
+    // Reconstruction of the last evaluated candidate is kept in picture
+    bool best_in_rec_pic = false;
     if (!Restrictions::Get().disable_inter_merge_mode) {
       const bool fast_merge_skip =
         encoder_settings_.fast_merge_eval && cache_result.any_skip;
       cost = CompressMerge(temp_cu, qp, *writer, fast_merge_skip);
-      if (cost < best_cost) {
+      best_in_rec_pic = cost < best_cost && IsIntraRefreshSafe(*temp_cu);
+      if (best_in_rec_pic) {
         best_cost = cost;
         temp_cu->SaveStateTo(best_state, rec_pic_);
         std::swap(cu, temp_cu);
@@ -419,19 +454,23 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
 
     if (!fast_skip_inter) {
       cost = CompressInter(temp_cu, qp, *writer);
-      if (cost < best_cost) {
+      best_in_rec_pic = cost < best_cost && IsIntraRefreshSafe(*temp_cu);
+      if (best_in_rec_pic) {
         best_cost = cost;
         temp_cu->SaveStateTo(best_state, rec_pic_);
         std::swap(cu, temp_cu);
       }
     }
 
+    // Intra is the fallback when no inter prediction is intra refresh safe
     if ((!fast_skip_intra && cu->GetHasAnyCbf()) ||
-        encoder_settings_.always_evaluate_intra_in_inter) {
+        encoder_settings_.always_evaluate_intra_in_inter ||
+        best_cost.cost == std::numeric_limits<Cost>::max()) {
       cost = CompressIntra(temp_cu, qp, *writer);
-      if (cost < best_cost) {
+      best_in_rec_pic = cost < best_cost;
+      if (best_in_rec_pic) {
+        // Last candidate, state is only needed if a previous one was better
         best_cost = cost;
-        temp_cu->SaveStateTo(best_state, rec_pic_);
         std::swap(cu, temp_cu);
       }
     }
@@ -439,7 +478,9 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
     assert(best_cost.cost < std::numeric_limits<Cost>::max());
     *best_cu = cu;
     rdo_temp_cu_[cu_tree][rdo_depth + 1] = temp_cu;
-    cu->LoadStateFrom(*best_state, &rec_pic_);
+    if (!best_in_rec_pic) {
+      cu->LoadStateFrom(*best_state, &rec_pic_);
+    }
   }
   cu->SetRootCbf(cu->GetHasAnyCbf());
   pic_data_.MarkUsedInPic(cu);
@@ -461,6 +502,89 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
   return best_cost.dist;
 }
 
+void CuEncoder::GetIntraRefreshColumn(PicNum doc, int *start_x,
+                                      int *end_x) const {
+  // Doc 0 is the intra access picture, the refresh cycle starts after it
+  const int period = encoder_settings_.intra_refresh_period;
+  const int width = pic_data_.GetPictureWidth(YuvComponent::kY);
+  const int width_in_ctu = (width + constants::kCtuSize - 1) /
+    constants::kCtuSize;
+  const int ctu_per_pic = (width_in_ctu + period - 1) / period;
+  const int pos = static_cast<int>((doc - 1) % period);
+  *start_x = std::min(width, pos * ctu_per_pic * constants::kCtuSize);
+  *end_x = std::min(width, (pos + 1) * ctu_per_pic * constants::kCtuSize);
+}
+
+PicNum CuEncoder::GetIntraRefreshCycle(PicNum doc) const {
+  // The intra access picture at doc 0 belongs to the first cycle
+  return doc == 0 ? 0 : (doc - 1) / encoder_settings_.intra_refresh_period;
+}
+
+int CuEncoder::GetIntraRefreshCleanWidth(RefPicList ref_list, int ref_idx,
+                                         bool refreshed_cu) const {
+  // A decoder starting at the first picture of a refresh cycle only has the
+  // area refreshed so far in that cycle. Refreshed cus can only depend on
+  // that area, other cus only on what is correct after the previous cycle.
+  const ReferencePictureLists &ref_lists = *pic_data_.GetRefPicLists();
+  const PicNum ref_doc = ref_lists.GetRefPicDoc(ref_list, ref_idx);
+  const PicNum ref_cycle = GetIntraRefreshCycle(ref_doc);
+  const PicNum cycle = GetIntraRefreshCycle(pic_data_.GetDoc());
+  const int pic_width = pic_data_.GetPictureWidth(YuvComponent::kY);
+  if (ref_cycle + (refreshed_cu ? 0 : 1) < cycle) {
+    return 0;
+  }
+  if ((!refreshed_cu && ref_cycle == cycle) ||
+      ref_lists.GetRefPicType(ref_list, ref_idx) ==
+      PicturePredictionType::kIntra) {
+    return pic_width;
+  }
+  int start_x, end_x;
+  GetIntraRefreshColumn(ref_doc, &start_x, &end_x);
+  return end_x;
+}
+
+bool CuEncoder::IsIntraRefreshSafe(const CodingUnit &cu) const {
+  if (encoder_settings_.intra_refresh_period == 0 || cu.IsIntra()) {
+    return true;
+  }
+  // Cus left of the refresh column belong to the refreshed area, the
+  // refresh column itself is always intra coded
+  const int cu_end_x = cu.GetPosX(YuvComponent::kY) +
+    cu.GetWidth(YuvComponent::kY);
+  const bool refreshed_cu = cu_end_x <= intra_refresh_start_x_;
+  const int pic_width = pic_data_.GetPictureWidth(YuvComponent::kY);
+  // Samples right of the block read by the luma and chroma interpolation
+  const int interpolation_margin =
+    std::max(InterPrediction::kNumTapsLuma / 2,
+             (InterPrediction::kNumTapsChroma / 2) <<
+             pic_data_.GetChromaShiftX());
+  // Chroma has twice the motion vector precision for subsampled formats
+  const int frac_mask = (1 << (constants::kMvPrecisionShift + 1)) - 1;
+  for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+    const RefPicList ref_list = static_cast<RefPicList>(i);
+    if (!cu.HasMv(ref_list)) {
+      continue;
+    }
+    const int clean_width =
+      GetIntraRefreshCleanWidth(ref_list, cu.GetRefIdx(ref_list),
+                                refreshed_cu);
+    if (clean_width >= pic_width) {
+      continue;
+    }
+    // Only the horizontal reach matters since the clean area spans the full
+    // picture height and padding repeats samples of the same column
+    const MotionVector &mv = cu.GetMv(ref_list);
+    int ref_end_x = cu_end_x + (mv.x >> constants::kMvPrecisionShift);
+    if ((mv.x & frac_mask) != 0) {
+      ref_end_x += interpolation_margin;
+    }
+    if (ref_end_x > clean_width - kIntraRefreshDeblockMargin) {
+      return false;
+    }
+  }
+  return true;
+}
+
 Distortion CuEncoder::CompressFast(CodingUnit *cu, const Qp &qp,
                                    const SyntaxWriter &writer) {
   assert(cu->GetSplit() == SplitType::kNone);
@@ -535,6 +659,7 @@ CuEncoder::CompressMerge(CodingUnit *cu, const Qp &qp,
   RdoCost best_cost(std::numeric_limits<Cost>::max());
   CodingUnit::TransformState &best_transform_state = rd_transform_state_;
   int best_merge_idx = -1;
+  bool best_in_rec_pic = false;
   const int skip_eval_init = fast_merge_skip ? 1 : 0;
   for (int skip_eval_idx = skip_eval_init; skip_eval_idx < 2; skip_eval_idx++) {
     bool force_skip = skip_eval_idx != 0;
@@ -550,7 +675,8 @@ CuEncoder::CompressMerge(CodingUnit *cu, const Qp &qp,
       if (!cu->GetHasAnyCbf()) {
         skip_evaluated[merge_idx] = true;
       }
-      if (cost.cost < best_cost.cost) {
+      best_in_rec_pic = cost.cost < best_cost.cost;
+      if (best_in_rec_pic) {
         best_cost = cost;
         best_merge_idx = merge_idx;
         cu->SaveStateTo(&best_transform_state, rec_pic_);
@@ -563,7 +689,11 @@ CuEncoder::CompressMerge(CodingUnit *cu, const Qp &qp,
   }
   cu->SetMergeIdx(best_merge_idx);
   inter_search_.ApplyMerge(cu, merge_list[best_merge_idx]);
-  cu->LoadStateFrom(best_transform_state, &rec_pic_);
+  if (best_in_rec_pic) {
+    cu->SetRootCbf(cu->GetHasAnyCbf());
+  } else {
+    cu->LoadStateFrom(best_transform_state, &rec_pic_);
+  }
   cu->SetSkipFlag(!cu->GetRootCbf());
   return best_cost;
 }
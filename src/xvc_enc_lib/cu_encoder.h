@@ -40,7 +40,9 @@ class CuEncoder : public TransformEncoder {
 public:
   CuEncoder(const SimdFunctions &simd, const YuvPicture &orig_pic,
             YuvPicture *rec_pic, PictureData *pic_data,
-            const EncoderSettings &encoder_settings);
+            const EncoderSettings &encoder_settings,
+            const std::vector<std::shared_ptr<SubpelPlanes>>
+            &ref_subpel_planes);
   ~CuEncoder();
   void EncodeCtu(int rsaddr, SyntaxWriter *writer);
 
@@ -69,6 +71,11 @@ private:
   RdoCost GetCuCostWithoutSplit(const CodingUnit &cu, const Qp &qp,
                                 const SyntaxWriter &bitstream_writer,
                                 Distortion ssd);
+  void GetIntraRefreshColumn(PicNum doc, int *start_x, int *end_x) const;
+  PicNum GetIntraRefreshCycle(PicNum doc) const;
+  int GetIntraRefreshCleanWidth(RefPicList ref_list, int ref_idx,
+                                bool refreshed_cu) const;
+  bool IsIntraRefreshSafe(const CodingUnit &cu) const;
   int CalcDeltaQpFromVariance(const CodingUnit *cu);
   void WriteCtu(int rsaddr, SyntaxWriter *writer);
   void SetQpForAllCusInCtu(CodingUnit *ctu, int qp);
@@ -87,6 +94,9 @@ private:
   CuWriter cu_writer_;
   CuCache cu_cache_;
   uint32_t last_ctu_frac_bits_ = 0;
+  // Luma columns of the forced intra ctus when using intra refresh
+  int intra_refresh_start_x_ = 0;
+  int intra_refresh_end_x_ = 0;
   // +2 for allow access to one depth lower than smallest CU in RDO
   std::array<CodingUnit::ReconstructionState,
     constants::kMaxBlockDepth + 2> temp_cu_state_;
@@ -27,6 +27,7 @@
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_enc_lib/segment_header_writer.h"
+#include "xvc_enc_lib/segment_parallel_encoder.h"
 
 namespace xvc {
 
@@ -39,8 +40,15 @@ Encoder::Encoder()
   segment_header_->minor_version = constants::kXvcMinorVersion;
 }
 
+Encoder::~Encoder() {
+  segment_encoder_.reset();
+}
+
 int Encoder::Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
                     bool output_rec, xvc_enc_pic_buffer *rec_pic) {
+  if (segment_encoder_) {
+    return segment_encoder_->Encode(pic_bytes, nal_units, output_rec, rec_pic);
+  }
   nal_units_.clear();
 
   // Set picture parameters and get bytes for original picture
@@ -65,6 +73,16 @@ int Encoder::Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
   pic_data->SetDoc(doc);
   pic_data->SetTid(tid);
   pic_data->SetHighestLayer(tid == max_tid);
+  if (encoder_settings_.intra_refresh_period > 0 && doc > 0 &&
+      doc % encoder_settings_.intra_refresh_period == 0 &&
+      pic_data->GetNalType() != NalUnitType::kIntraPicture) {
+    // Last picture of an intra refresh cycle, decoding that started at the
+    // first picture of the cycle is correct from here on
+    pic_data->SetNalType(
+      pic_data->GetNalType() == NalUnitType::kPredictedPicture ?
+      NalUnitType::kPredictedAccessPicture :
+      NalUnitType::kBipredictedAccessPicture);
+  }
   pic_data->SetAdaptiveQp(segment_header_->adaptive_qp > 0);
   pic_data->SetDeblock(segment_header_->deblock > 0);
   pic_data->SetBetaOffset(segment_header_->beta_offset);
@@ -161,6 +179,9 @@ int Encoder::Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
 
 int Encoder::Flush(xvc_enc_nal_unit **nal_units, bool output_rec,
                    xvc_enc_pic_buffer *rec_pic) {
+  if (segment_encoder_) {
+    return segment_encoder_->Flush(nal_units, rec_pic);
+  }
   nal_units_.clear();
   // Since poc is increased at the end of each call to Encode
   // it is reduced by one here to get the poc of the last picture.
@@ -216,9 +237,34 @@ void Encoder::SetEncoderSettings(const EncoderSettings &settings) {
   // Load restriction flags
   Restrictions restrictions = Restrictions();
   restrictions.EnableRestrictedMode(settings.restricted_mode);
+  if (settings.intra_refresh_period > 0) {
+    // Temporal mv candidates could bring in motion from the part of a
+    // picture that is not yet refreshed
+    restrictions.disable_inter_tmvp_mvp = true;
+    restrictions.disable_inter_tmvp_merge = true;
+  }
+  segment_header_->restrictions = restrictions;
   Restrictions::GetRW() = std::move(restrictions);
 }
 
+void Encoder::SetParallelSegments(int num_threads) {
+  assert(poc_ == 0);
+  if (num_threads == 0) {
+    segment_encoder_.reset();
+    return;
+  }
+  size_t input_picture_size =
+    util::GetTotalNumSamples(segment_header_->GetOutputWidth(),
+                             segment_header_->GetOutputHeight(),
+                             segment_header_->chroma_format) *
+    (input_bitdepth_ == 8 ? 1 : 2);
+  segment_encoder_.reset(
+    new SegmentParallelEncoder(num_threads, closed_gop_interval_,
+                               input_picture_size, [this]() {
+    return CreateSegmentEncoder();
+  }));
+}
+
 void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic,
                                PicNum sub_gop_length) {
   // Check if current picture is a tail picture.
@@ -232,10 +278,12 @@ void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic,
 
   ReferenceListSorter<PictureEncoder>
     ref_list_sorter(segment_header, prev_segment_open_gop_);
-  ref_list_sorter.Prepare(pic->GetPicData()->GetPoc(),
-                          pic->GetPicData()->GetTid(),
-                          pic->GetPicData()->IsIntraPic(),
-                          pic_encoders_, pic->GetPicData()->GetRefPicLists());
+  auto ref_pics =
+    ref_list_sorter.Prepare(pic->GetPicData()->GetPoc(),
+                            pic->GetPicData()->GetTid(),
+                            pic->GetPicData()->IsIntraPic(),
+                            pic_encoders_, pic->GetPicData()->GetRefPicLists());
+  pic->SetReferencePictures(ref_pics);
 
   // Bitstream reference valid until next picture is coded
   std::vector<uint8_t> *pic_bytes =
@@ -291,7 +339,8 @@ std::shared_ptr<PictureEncoder> Encoder::GetNewPictureEncoder() {
                                        segment_header_->chroma_format,
                                        segment_header_->GetInternalWidth(),
                                        segment_header_->GetInternalHeight(),
-                                       segment_header_->internal_bitdepth);
+                                       segment_header_->internal_bitdepth,
+                                       cu_storage_pool_);
     pic_encoders_.push_back(pic);
     return pic;
   }
@@ -317,6 +366,21 @@ std::shared_ptr<PictureEncoder> Encoder::GetNewPictureEncoder() {
   return pic_enc;
 }
 
+std::unique_ptr<Encoder> Encoder::CreateSegmentEncoder() const {
+  std::unique_ptr<Encoder> encoder(new Encoder());
+  *encoder->segment_header_ = *segment_header_;
+  encoder->input_bitdepth_ = input_bitdepth_;
+  encoder->framerate_ = framerate_;
+  encoder->pic_buffering_num_ = pic_buffering_num_;
+  encoder->segment_length_ = segment_length_;
+  encoder->closed_gop_interval_ = closed_gop_interval_;
+  encoder->segment_qp_ = segment_qp_;
+  encoder->flat_lambda_ = flat_lambda_;
+  encoder->simd_ = simd_;
+  encoder->encoder_settings_ = encoder_settings_;
+  return encoder;
+}
+
 void Encoder::SetNalStats(const PictureData &pic_data, xvc_enc_nal_unit *nal) {
   nal->stats.nal_unit_type =
     static_cast<uint32_t>(pic_data.GetNalType());
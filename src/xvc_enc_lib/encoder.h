@@ -38,9 +38,12 @@ struct xvc_encoder {};
 
 namespace xvc {
 
+class SegmentParallelEncoder;
+
 class Encoder : public xvc_encoder {
 public:
   Encoder();
+  ~Encoder();
   int Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
              bool output_rec, xvc_enc_pic_buffer *rec_pic);
   int Flush(xvc_enc_nal_unit **nal_units, bool output_rec,
@@ -102,6 +105,9 @@ public:
 
   const EncoderSettings& GetEncoderSettings() { return encoder_settings_; }
   void SetEncoderSettings(const EncoderSettings &settings);
+  // Encode chunks of closed gop segments on separate encoder instances,
+  // must be called after all other settings have been applied
+  void SetParallelSegments(int num_threads);
 
 private:
   void EncodeOnePicture(std::shared_ptr<PictureEncoder> pic,
@@ -109,6 +115,7 @@ private:
   void ReconstructOnePicture(bool output_rec,
                              xvc_enc_pic_buffer *rec_pic);
   std::shared_ptr<PictureEncoder> GetNewPictureEncoder();
+  std::unique_ptr<Encoder> CreateSegmentEncoder() const;
 
   void SetNalStats(const PictureData &pic_data, xvc_enc_nal_unit *nal);
 
@@ -131,10 +138,13 @@ private:
   bool flat_lambda_ = false;
   SimdFunctions simd_;
   EncoderSettings encoder_settings_;
+  std::shared_ptr<CuStoragePool> cu_storage_pool_ =
+    std::make_shared<CuStoragePool>();
   std::vector<std::shared_ptr<PictureEncoder>> pic_encoders_;
   std::vector<uint8_t> output_pic_bytes_;
   BitWriter bit_writer_;
   std::vector<xvc_enc_nal_unit> nal_units_;
+  std::unique_ptr<SegmentParallelEncoder> segment_encoder_;
 };
 
 }   // namespace xvc
@@ -155,6 +155,9 @@ struct EncoderSettings {
   int chroma_qp_offset_table = 1;
   int chroma_qp_offset_u = 0;
   int chroma_qp_offset_v = 0;
+  int intra_refresh_period = 0;
+  // Memory for speed trade-off of sub-pel motion search
+  int subpel_planes = 0;
   RestrictedMode restricted_mode = RestrictedMode::kUnrestricted;
 };
 
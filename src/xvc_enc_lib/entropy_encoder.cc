@@ -36,11 +36,8 @@ EntropyEncoder::EntropyEncoder(BitWriter *bit_writer, uint32_t written_bits,
 
 void EntropyEncoder::EncodeBin(uint32_t binval, ContextModel *ctx) {
   uint32_t ctxmps = ctx->GetMps();
-  uint32_t ctxstate = ctx->GetState();
-  uint32_t qrange = (range_ >> 6) & 3;
-  uint8_t lps = Cabac::RangeTable(ctxstate, qrange);
-
   if (!bit_writer_) {
+    // Bit estimation only, no interval arithmetic is needed
     frac_bits_ += ctx->GetEntropyBits(binval);
     if (binval != ctxmps) {
       ctx->UpdateLPS();
@@ -49,6 +46,9 @@ void EntropyEncoder::EncodeBin(uint32_t binval, ContextModel *ctx) {
     }
     return;
   }
+  uint32_t ctxstate = ctx->GetState();
+  uint32_t qrange = (range_ >> 6) & 3;
+  uint8_t lps = Cabac::RangeTable(ctxstate, qrange);
   if (EncoderSettings::kEncoderCountActualWrittenBits) {
     frac_bits_ += ctx->GetEntropyBits(binval);
   }
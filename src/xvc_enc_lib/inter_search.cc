@@ -41,8 +41,11 @@ static const std::array<std::array<int8_t, 2>, 9> kSquareXYQpel = { {
 InterSearch::InterSearch(const SimdFunctions &simd, int bitdepth,
                          int max_components, const YuvPicture &orig_pic,
                          const ReferencePictureLists &ref_pic_list,
-                         const EncoderSettings &encoder_settings)
+                         const EncoderSettings &encoder_settings,
+                         const std::vector<std::shared_ptr<SubpelPlanes>>
+                         &ref_subpel_planes)
   : InterPrediction(simd.inter_prediction, bitdepth),
+  simd_(simd),
   bitdepth_(bitdepth),
   max_components_(max_components),
   orig_pic_(orig_pic),
@@ -54,6 +57,19 @@ InterSearch::InterSearch(const SimdFunctions &simd, int bitdepth,
   assert(l1_mapping.size() <= same_poc_in_l0_mapping_.size());
   std::copy(l1_mapping.begin(), l1_mapping.end(),
             same_poc_in_l0_mapping_.begin());
+  for (int list_idx = 0; list_idx < 2; list_idx++) {
+    const RefPicList ref_list = static_cast<RefPicList>(list_idx);
+    subpel_planes_[list_idx].fill(nullptr);
+    for (int ref_idx = 0; ref_idx < ref_pic_list.GetNumRefPics(ref_list);
+         ref_idx++) {
+      const YuvPicture *ref_pic = ref_pic_list.GetRefPic(ref_list, ref_idx);
+      for (auto &planes : ref_subpel_planes) {
+        if (&planes->GetRefPic() == ref_pic) {
+          subpel_planes_[list_idx][ref_idx] = planes.get();
+        }
+      }
+    }
+  }
 }
 
 Distortion
@@ -446,7 +462,7 @@ InterSearch::MotionEstimation(const CodingUnit &cu, const Qp &qp,
     mv_fullpel = FullSearch(cu, qp, mvp, *ref_pic, clip_min, clip_max);
   } else if (search_method == SearchMethod::TzSearch) {
     MetricType metric_type = GetFullpelMetric(cu);
-    TzSearch tz_search(bitdepth_, orig_pic_, *this, encoder_settings_,
+    TzSearch tz_search(simd_, bitdepth_, orig_pic_, *this, encoder_settings_,
                        kSearchRangeUni);
     mv_fullpel =
       tz_search.Search(cu, qp, metric_type, mvp, *ref_pic, clip_min, clip_max,
@@ -455,8 +471,9 @@ InterSearch::MotionEstimation(const CodingUnit &cu, const Qp &qp,
   } else {
     assert(0);
   }
+  SubpelPlanes *planes = subpel_planes_[static_cast<int>(ref_list)][ref_idx];
   MotionVector mv_subpel =
-    SubpelSearch(cu, qp, *ref_pic, mvp, mv_fullpel, orig_buffer, pred,
+    SubpelSearch(cu, qp, *ref_pic, planes, mvp, mv_fullpel, orig_buffer, pred,
                  pred_stride, out_dist);
   return mv_subpel;
 }
@@ -473,25 +490,36 @@ MotionVector InterSearch::FullSearch(const CodingUnit &cu, const Qp &qp,
   uint32_t lambda =
     static_cast<uint32_t>(std::floor(65536.0 * qp.GetLambdaSqrt()));
   MetricType fullpel_metric = GetFullpelMetric(cu);
-  SampleMetric metric(fullpel_metric, qp, bitdepth_);
+  SampleMetric metric(simd_, fullpel_metric, qp, bitdepth_);
   const Sample *ref_cu = ref_pic.GetSamplePtr(comp, cu.GetPosX(comp),
                                               cu.GetPosY(comp));
   intptr_t ref_stride = ref_pic.GetStride(comp);
   Distortion cost_best = std::numeric_limits<Distortion>::max();
   MotionVector mv_best;
+  // Each row of the search window is evaluated in batches of candidates
+  const int kNumCand = SimdFunctions::SadFunc::kNumCand;
+  std::array<const Sample*, kNumCand> ref_mv;
+  std::array<Distortion, kNumCand> dist;
   for (int mv_y = mv_min.y; mv_y <= mv_max.y; mv_y++) {
-    for (int mv_x = mv_min.x; mv_x <= mv_max.x; mv_x++) {
-      const Sample *ref_mv = ref_cu + mv_y * ref_stride + mv_x;
-      Distortion dist = metric.CompareSample(comp, width, height,
-                                             bipred_orig_buffer_.GetDataPtr(),
-                                             bipred_orig_buffer_.GetStride(),
-                                             ref_mv, ref_stride);
-      Bits bits = ((lambda * GetMvdBits(mvp, mv_x, mv_y, mv_precision)) >> 16);
-      Distortion cost = dist + bits;
-      if (cost < cost_best) {
-        cost_best = cost;
-        mv_best.x = mv_x;
-        mv_best.y = mv_y;
+    for (int mv_x0 = mv_min.x; mv_x0 <= mv_max.x; mv_x0 += kNumCand) {
+      const int num = std::min(kNumCand, mv_max.x - mv_x0 + 1);
+      for (int i = 0; i < num; i++) {
+        ref_mv[i] = ref_cu + mv_y * ref_stride + mv_x0 + i;
+      }
+      metric.CompareSampleMulti(comp, width, height,
+                                bipred_orig_buffer_.GetDataPtr(),
+                                bipred_orig_buffer_.GetStride(),
+                                &ref_mv[0], ref_stride, num, &dist[0]);
+      for (int i = 0; i < num; i++) {
+        const int mv_x = mv_x0 + i;
+        Bits bits =
+          ((lambda * GetMvdBits(mvp, mv_x, mv_y, mv_precision)) >> 16);
+        Distortion cost = dist[i] + bits;
+        if (cost < cost_best) {
+          cost_best = cost;
+          mv_best.x = mv_x;
+          mv_best.y = mv_y;
+        }
       }
     }
   }
@@ -501,7 +529,8 @@ MotionVector InterSearch::FullSearch(const CodingUnit &cu, const Qp &qp,
 template<typename TOrig>
 MotionVector
 InterSearch::SubpelSearch(const CodingUnit &cu, const Qp &qp,
-                          const YuvPicture &ref_pic, const MotionVector &mvp,
+                          const YuvPicture &ref_pic, SubpelPlanes *planes,
+                          const MotionVector &mvp,
                           const MotionVector &mv_fullpel,
                           const DataBuffer<TOrig> &orig_buffer,
                           Sample *buffer, ptrdiff_t buffer_stride,
@@ -518,8 +547,9 @@ InterSearch::SubpelSearch(const CodingUnit &cu, const Qp &qp,
   for (int i = 0; i < static_cast<int>(kSquareXYHalf.size()); i++) {
     int mv_x = mv_subpel.x + kSquareXYHalf[i][0] * 2;
     int mv_y = mv_subpel.y + kSquareXYHalf[i][1] * 2;
-    Distortion dist = GetSubpelDistortion(cu, ref_pic, &metric, mv_x, mv_y,
-                                          orig_buffer, buffer, buffer_stride);
+    Distortion dist = GetSubpelDistortion(cu, ref_pic, planes, &metric,
+                                          mv_x, mv_y, orig_buffer,
+                                          buffer, buffer_stride);
     Bits bits = ((lambda * GetMvdBits(mvp, mv_x, mv_y, 0))) >> 16;
     Distortion cost = dist + bits;
     if (cost < best_cost) {
@@ -538,8 +568,9 @@ InterSearch::SubpelSearch(const CodingUnit &cu, const Qp &qp,
   for (int i = 1; i < static_cast<int>(kSquareXYQpel.size()); i++) {
     int mv_x = mv_subpel.x + kSquareXYQpel[i][0];
     int mv_y = mv_subpel.y + kSquareXYQpel[i][1];
-    Distortion dist = GetSubpelDistortion(cu, ref_pic, &metric, mv_x, mv_y,
-                                          orig_buffer, buffer, buffer_stride);
+    Distortion dist = GetSubpelDistortion(cu, ref_pic, planes, &metric,
+                                          mv_x, mv_y, orig_buffer,
+                                          buffer, buffer_stride);
     Bits bits = ((lambda * GetMvdBits(mvp, mv_x, mv_y, 0))) >> 16;
     Distortion cost = dist + bits;
     if (cost < best_cost) {
@@ -559,12 +590,28 @@ template<typename TOrig>
 Distortion
 InterSearch::GetSubpelDistortion(const CodingUnit &cu,
                                  const YuvPicture &ref_pic,
+                                 SubpelPlanes *planes,
                                  SampleMetric *metric, int mv_x, int mv_y,
                                  const DataBuffer<TOrig> &orig_buffer,
                                  Sample *buf, ptrdiff_t buf_stride) {
   YuvComponent comp = YuvComponent::kY;
   int width = cu.GetWidth(comp);
   int height = cu.GetHeight(comp);
+  if (planes) {
+    const int mv_shift = constants::kMvPrecisionShift;
+    const int mv_mask = (1 << mv_shift) - 1;
+    ptrdiff_t stride;
+    const Sample *pred =
+      planes->GetBlock(cu.GetPosX(comp) + (mv_x >> mv_shift),
+                       cu.GetPosY(comp) + (mv_y >> mv_shift),
+                       mv_x & mv_mask, mv_y & mv_mask, width, height, this,
+                       &stride);
+    if (pred) {
+      return metric->CompareSample(comp, width, height,
+                                   orig_buffer.GetDataPtr(),
+                                   orig_buffer.GetStride(), pred, stride);
+    }
+  }
   MotionCompensationMv(cu, comp, ref_pic, mv_x, mv_y, buf, buf_stride);
   return metric->CompareSample(comp, width, height, orig_buffer.GetDataPtr(),
                                orig_buffer.GetStride(), &buf[0], buf_stride);
@@ -20,6 +20,8 @@
 #define XVC_ENC_LIB_INTER_SEARCH_H_
 
 #include <array>
+#include <memory>
+#include <vector>
 
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/inter_prediction.h"
@@ -30,6 +32,7 @@
 #include "xvc_common_lib/quantize.h"
 #include "xvc_enc_lib/encoder_settings.h"
 #include "xvc_enc_lib/sample_metric.h"
+#include "xvc_enc_lib/subpel_planes.h"
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/transform_encoder.h"
 
@@ -42,7 +45,9 @@ public:
   InterSearch(const SimdFunctions &simd, int bitdepth, int max_components,
               const YuvPicture &orig_pic,
               const ReferencePictureLists &ref_pic_list,
-              const EncoderSettings &encoder_settings);
+              const EncoderSettings &encoder_settings,
+              const std::vector<std::shared_ptr<SubpelPlanes>>
+              &ref_subpel_planes);
 
 
   Distortion CompressInter(CodingUnit *cu, const Qp &qp,
@@ -107,7 +112,8 @@ private:
                           const MotionVector &mv_max);
   template<typename TOrig>
   MotionVector SubpelSearch(const CodingUnit &cu, const Qp &qp,
-                            const YuvPicture &ref_pic, const MotionVector &mvp,
+                            const YuvPicture &ref_pic, SubpelPlanes *planes,
+                            const MotionVector &mvp,
                             const MotionVector &mv_fullpel,
                             const DataBuffer<TOrig> &orig_buffer,
                             Sample *pred_buffer, ptrdiff_t pred_buffer_stride,
@@ -115,6 +121,7 @@ private:
   template<typename TOrig>
   Distortion GetSubpelDistortion(const CodingUnit &cu,
                                  const YuvPicture &ref_pic,
+                                 SubpelPlanes *planes,
                                  SampleMetric *metric, int mv_x, int mv_y,
                                  const DataBuffer<TOrig> &orig_buffer,
                                  Sample *pred_buf, ptrdiff_t pred_buf_stride);
@@ -133,6 +140,7 @@ private:
                          int mv_scale);
   static Bits GetNumExpGolombBits(int mvd);
 
+  const SimdFunctions &simd_;
   const int bitdepth_;
   const int max_components_;
   const YuvPicture &orig_pic_;
@@ -151,6 +159,9 @@ private:
   // Best fullpel search mv per ref list, ref idx and picture
   std::array<std::array<MotionVector, constants::kMaxNumRefPics>,
     static_cast<int>(RefPicList::kTotalNumber)> previous_fullpel_;
+  // Interpolated reference planes per ref list and ref idx (if available)
+  std::array<std::array<SubpelPlanes*, constants::kMaxNumRefPics>,
+    static_cast<int>(RefPicList::kTotalNumber)> subpel_planes_;
   friend class TzSearch;
 };
 
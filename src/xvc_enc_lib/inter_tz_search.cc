@@ -18,6 +18,8 @@
 
 #include "xvc_enc_lib/inter_tz_search.h"
 
+#include <array>
+#include <cassert>
 #include <cmath>
 
 #include "xvc_common_lib/restrictions.h"
@@ -25,10 +27,26 @@
 
 namespace xvc {
 
+struct TzSearch::CandidateList {
+  static const int kMaxNum = 16;
+  void Add(int mv_x, int mv_y, int pos, int search_range) {
+    assert(num < kMaxNum);
+    mv[num] = MotionVector(mv_x, mv_y);
+    position[num] = pos;
+    range[num] = search_range;
+    num++;
+  }
+  std::array<MotionVector, kMaxNum> mv;
+  std::array<int, kMaxNum> position;
+  std::array<int, kMaxNum> range;
+  int num = 0;
+};
+
 template<typename TOrig>
 class TzSearch::DistortionWrapper {
 public:
-  DistortionWrapper(MetricType metric, YuvComponent comp, const CodingUnit &cu,
+  DistortionWrapper(const SimdFunctions &simd, MetricType metric,
+                    YuvComponent comp, const CodingUnit &cu,
                     const Qp &qp, int bitdepth,
                     const DataBuffer<const TOrig> &src1, const YuvPicture &src2)
     : comp_(comp),
@@ -38,7 +56,7 @@ public:
     stride1_(src1.GetStride()),
     src2_(src2.GetSamplePtr(comp, cu.GetPosX(comp), cu.GetPosY(comp))),
     stride2_(src2.GetStride(comp)),
-    metric_(metric, qp, bitdepth) {
+    metric_(simd, metric, qp, bitdepth) {
   }
 
   Distortion GetDist(int mv_x, int mv_y) {
@@ -47,6 +65,16 @@ public:
                                  src2_ptr, stride2_);
   }
 
+  void GetDist(const CandidateList &cand_list, Distortion *dist) {
+    std::array<const Sample*, CandidateList::kMaxNum> src2_ptr;
+    for (int i = 0; i < cand_list.num; i++) {
+      const MotionVector &mv = cand_list.mv[i];
+      src2_ptr[i] = src2_ + mv.y * stride2_ + mv.x;
+    }
+    metric_.CompareSampleMulti(comp_, width_, height_, src1_, stride1_,
+                               &src2_ptr[0], stride2_, cand_list.num, dist);
+  }
+
 private:
   YuvComponent comp_;
   int width_;
@@ -85,7 +113,7 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
   const YuvComponent comp = YuvComponent::kY;
   auto orig_buffer =
     orig_pic_.GetSampleBuffer(comp, cu.GetPosX(comp), cu.GetPosY(comp));
-  DistortionWrapper<Sample> dist_wrap(metric, YuvComponent::kY, cu, qp,
+  DistortionWrapper<Sample> dist_wrap(simd_, metric, YuvComponent::kY, cu, qp,
                                       bitdepth_, orig_buffer, ref_pic);
   SearchState state(&dist_wrap, mvp, mv_min, mv_max);
   state.mv_precision = constants::kMvPrecisionShift;
@@ -143,12 +171,8 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
   // Full search in search window
   if (state.last_range_ > kFullSearchGranularity) {
     state.last_range_ = kFullSearchGranularity;
-    const int step_size = kFullSearchGranularity;
-    for (int y = fullsearch_min.y; y <= fullsearch_max.y; y += step_size) {
-      for (int x = fullsearch_min.x; x <= fullsearch_max.x; x += step_size) {
-        CheckCostBest(&state, x, y);
-      }
-    }
+    FullpelRasterSearch(&state, fullsearch_min, fullsearch_max,
+                        kFullSearchGranularity);
   }
 
   // Iterative refinement of start position
@@ -169,90 +193,120 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
 
 bool TzSearch::FullpelDiamondSearch(SearchState *state,
                                     const MotionVector &mv_base, int range) {
-  bool mod = false;
+  // All positions are evaluated together and then checked in order
+  CandidateList cands;
+  const int x = mv_base.x;
+  const int y = mv_base.y;
   if (range == 1) {
-    mod |= CheckCost1<Up>(state, mv_base.x, mv_base.y - range, range);
-    mod |= CheckCost1<Left>(state, mv_base.x - range, mv_base.y, range);
-    mod |= CheckCost1<Right>(state, mv_base.x + range, mv_base.y, range);
-    mod |= CheckCost1<Down>(state, mv_base.x, mv_base.y + range, range);
+    AddCandidate1<Up>(*state, x, y - range, range, &cands);
+    AddCandidate1<Left>(*state, x - range, y, range, &cands);
+    AddCandidate1<Right>(*state, x + range, y, range, &cands);
+    AddCandidate1<Down>(*state, x, y + range, range, &cands);
   } else if (range <= 8) {
     int r2 = range >> 1;
-    mod |= CheckCost1<Up>(state, mv_base.x, mv_base.y - range, range);
-    mod |= CheckCost2<Up, Left>(state, mv_base.x - r2, mv_base.y - r2, r2);
-    mod |= CheckCost2<Up, Right>(state, mv_base.x + r2, mv_base.y - r2, r2);
-    mod |= CheckCost1<Left>(state, mv_base.x - range, mv_base.y, range);
-    mod |= CheckCost1<Right>(state, mv_base.x + range, mv_base.y, range);
-    mod |= CheckCost2<Down, Left>(state, mv_base.x - r2, mv_base.y + r2, r2);
-    mod |= CheckCost2<Down, Right>(state, mv_base.x + r2, mv_base.y + r2, r2);
-    mod |= CheckCost1<Down>(state, mv_base.x, mv_base.y + range, range);
+    AddCandidate1<Up>(*state, x, y - range, range, &cands);
+    AddCandidate2<Up, Left>(*state, x - r2, y - r2, r2, &cands);
+    AddCandidate2<Up, Right>(*state, x + r2, y - r2, r2, &cands);
+    AddCandidate1<Left>(*state, x - range, y, range, &cands);
+    AddCandidate1<Right>(*state, x + range, y, range, &cands);
+    AddCandidate2<Down, Left>(*state, x - r2, y + r2, r2, &cands);
+    AddCandidate2<Down, Right>(*state, x + r2, y + r2, r2, &cands);
+    AddCandidate1<Down>(*state, x, y + range, range, &cands);
   } else {
-    mod |= CheckCost1<Up>(state, mv_base.x, mv_base.y - range, range);
-    mod |= CheckCost1<Left>(state, mv_base.x - range, mv_base.y, range);
-    mod |= CheckCost1<Right>(state, mv_base.x + range, mv_base.y, range);
-    mod |= CheckCost1<Down>(state, mv_base.x, mv_base.y + range, range);
+    AddCandidate1<Up>(*state, x, y - range, range, &cands);
+    AddCandidate1<Left>(*state, x - range, y, range, &cands);
+    AddCandidate1<Right>(*state, x + range, y, range, &cands);
+    AddCandidate1<Down>(*state, x, y + range, range, &cands);
     for (int i = 1; i < 4; i++) {
       int range14 = i * (range >> 2);
       int range34 = range - range14;
-      mod |= CheckCost2<Up, Left>(state, mv_base.x - range14,
-                                  mv_base.y - range34, range);
-      mod |= CheckCost2<Up, Right>(state, mv_base.x + range14,
-                                   mv_base.y - range34, range);
-      mod |= CheckCost2<Down, Left>(state, mv_base.x - range14,
-                                    mv_base.y + range34, range);
-      mod |= CheckCost2<Down, Right>(state, mv_base.x + range14,
-                                     mv_base.y + range34, range);
+      AddCandidate2<Up, Left>(*state, x - range14, y - range34, range,
+                              &cands);
+      AddCandidate2<Up, Right>(*state, x + range14, y - range34, range,
+                               &cands);
+      AddCandidate2<Down, Left>(*state, x - range14, y + range34, range,
+                                &cands);
+      AddCandidate2<Down, Right>(*state, x + range14, y + range34, range,
+                                 &cands);
     }
   }
-  return mod;
+  return CheckCandidates(state, cands);
 }
 
 void TzSearch::FullpelNeighborPointSearch(SearchState *state) {
   const int r = 1;
-  MotionVector mv_base = state->mv_best;
+  const int x = state->mv_best.x;
+  const int y = state->mv_best.y;
+  CandidateList cands;
   switch (state->last_position) {
     case Up::index + Left::index:
-      CheckCost1<Left>(state, mv_base.x - r, mv_base.y, r);
-      CheckCost1<Up>(state, mv_base.x, mv_base.y - r, r);
+      AddCandidate1<Left>(*state, x - r, y, r, &cands);
+      AddCandidate1<Up>(*state, x, y - r, r, &cands);
       break;
 
     case Up::index:
-      CheckCost2<Up, Left>(state, mv_base.x - r, mv_base.y - r, r);
-      CheckCost2<Up, Right>(state, mv_base.x + r, mv_base.y - r, r);
+      AddCandidate2<Up, Left>(*state, x - r, y - r, r, &cands);
+      AddCandidate2<Up, Right>(*state, x + r, y - r, r, &cands);
       break;
 
     case Up::index + Right::index:
-      CheckCost1<Up>(state, mv_base.x, mv_base.y - r, r);
-      CheckCost1<Right>(state, mv_base.x + r, mv_base.y, r);
+      AddCandidate1<Up>(*state, x, y - r, r, &cands);
+      AddCandidate1<Right>(*state, x + r, y, r, &cands);
       break;
 
     case Left::index:
-      CheckCost2<Down, Left>(state, mv_base.x - r, mv_base.y + r, r);
-      CheckCost2<Up, Left>(state, mv_base.x - r, mv_base.y - r, r);
+      AddCandidate2<Down, Left>(*state, x - r, y + r, r, &cands);
+      AddCandidate2<Up, Left>(*state, x - r, y - r, r, &cands);
       break;
 
     case Right::index:
-      CheckCost2<Up, Right>(state, mv_base.x + r, mv_base.y - r, r);
-      CheckCost2<Down, Right>(state, mv_base.x + r, mv_base.y + r, r);
+      AddCandidate2<Up, Right>(*state, x + r, y - r, r, &cands);
+      AddCandidate2<Down, Right>(*state, x + r, y + r, r, &cands);
       break;
 
     case Down::index + Left::index:
-      CheckCost1<Left>(state, mv_base.x - r, mv_base.y, r);
-      CheckCost1<Down>(state, mv_base.x, mv_base.y + r, r);
+      AddCandidate1<Left>(*state, x - r, y, r, &cands);
+      AddCandidate1<Down>(*state, x, y + r, r, &cands);
       break;
 
     case Down::index:
-      CheckCost2<Down, Left>(state, mv_base.x - r, mv_base.y + r, r);
-      CheckCost2<Down, Right>(state, mv_base.x + r, mv_base.y + r, r);
+      AddCandidate2<Down, Left>(*state, x - r, y + r, r, &cands);
+      AddCandidate2<Down, Right>(*state, x + r, y + r, r, &cands);
       break;
 
     case Down::index + Right::index:
-      CheckCost1<Right>(state, mv_base.x + r, mv_base.y, r);
-      CheckCost1<Down>(state, mv_base.x, mv_base.y + r, r);
+      AddCandidate1<Right>(*state, x + r, y, r, &cands);
+      AddCandidate1<Down>(*state, x, y + r, r, &cands);
       break;
 
     default:
       break;
   }
+  CheckCandidates(state, cands);
+}
+
+void TzSearch::FullpelRasterSearch(SearchState *state,
+                                   const MotionVector &mv_min,
+                                   const MotionVector &mv_max,
+                                   int step_size) {
+  CandidateList cands;
+  std::array<Distortion, CandidateList::kMaxNum> costs;
+  auto check_costs = [this, state, &cands, &costs]() {
+    GetCosts(state, cands, &costs[0]);
+    for (int i = 0; i < cands.num; i++) {
+      UpdateCostBest(state, cands.mv[i].x, cands.mv[i].y, costs[i]);
+    }
+    cands.num = 0;
+  };
+  for (int y = mv_min.y; y <= mv_max.y; y += step_size) {
+    for (int x = mv_min.x; x <= mv_max.x; x += step_size) {
+      cands.Add(x, y, 0, 0);
+      if (cands.num == CandidateList::kMaxNum) {
+        check_costs();
+      }
+    }
+  }
+  check_costs();
 }
 
 Distortion TzSearch::GetCost(SearchState *state, int mv_x, int mv_y) {
@@ -263,8 +317,26 @@ Distortion TzSearch::GetCost(SearchState *state, int mv_x, int mv_y) {
   return dist + bits;
 }
 
+void TzSearch::GetCosts(SearchState *state, const CandidateList &cand_list,
+                        Distortion *costs) {
+  if (cand_list.num == 0) {
+    return;
+  }
+  const int mv_scale = state->mv_precision;
+  state->dist->GetDist(cand_list, costs);
+  for (int i = 0; i < cand_list.num; i++) {
+    const MotionVector &mv = cand_list.mv[i];
+    Bits mvd = InterSearch::GetMvdBits(state->mvp, mv.x, mv.y, mv_scale);
+    costs[i] += ((state->lambda * mvd) >> 16);
+  }
+}
+
 bool TzSearch::CheckCostBest(SearchState *state, int mv_x, int mv_y) {
-  Distortion cost = GetCost(state, mv_x, mv_y);
+  return UpdateCostBest(state, mv_x, mv_y, GetCost(state, mv_x, mv_y));
+}
+
+bool TzSearch::UpdateCostBest(SearchState *state, int mv_x, int mv_y,
+                              Distortion cost) {
   if (cost < state->cost_best) {
     state->cost_best = cost;
     state->mv_best.x = mv_x;
@@ -274,6 +346,22 @@ bool TzSearch::CheckCostBest(SearchState *state, int mv_x, int mv_y) {
   return false;
 }
 
+bool TzSearch::CheckCandidates(SearchState *state,
+                               const CandidateList &cand_list) {
+  std::array<Distortion, CandidateList::kMaxNum> costs;
+  GetCosts(state, cand_list, &costs[0]);
+  bool mod = false;
+  for (int i = 0; i < cand_list.num; i++) {
+    const MotionVector &mv = cand_list.mv[i];
+    if (UpdateCostBest(state, mv.x, mv.y, costs[i])) {
+      state->last_position = cand_list.position[i];
+      state->last_range_ = cand_list.range[i];
+      mod = true;
+    }
+  }
+  return mod;
+}
+
 template<class Dir>
 bool
 TzSearch::IsInside(int mv_x, int mv_y, const_mv *mv_min, const_mv *mv_max) {
@@ -301,32 +389,20 @@ bool TzSearch::IsInside<TzSearch::Right>(int mv_x, int mv_y,
 }
 
 template<class Dir>
-bool TzSearch::CheckCost1(SearchState *state, int mv_x, int mv_y,
-                          int range) {
-  if (!IsInside<Dir>(mv_x, mv_y, &state->mv_min, &state->mv_max)) {
-    return false;
-  }
-  if (!CheckCostBest(state, mv_x, mv_y)) {
-    return false;
+void TzSearch::AddCandidate1(const SearchState &state, int mv_x, int mv_y,
+                             int range, CandidateList *cand_list) {
+  if (IsInside<Dir>(mv_x, mv_y, &state.mv_min, &state.mv_max)) {
+    cand_list->Add(mv_x, mv_y, Dir::index, range);
   }
-  state->last_position = Dir::index;
-  state->last_range_ = range;
-  return true;
 }
 
 template<class Dir1, class Dir2>
-bool TzSearch::CheckCost2(SearchState *state, int mv_x, int mv_y,
-                          int range) {
-  if (!IsInside<Dir1>(mv_x, mv_y, &state->mv_min, &state->mv_max) ||
-      !IsInside<Dir2>(mv_x, mv_y, &state->mv_min, &state->mv_max)) {
-    return false;
-  }
-  if (!CheckCostBest(state, mv_x, mv_y)) {
-    return false;
+void TzSearch::AddCandidate2(const SearchState &state, int mv_x, int mv_y,
+                             int range, CandidateList *cand_list) {
+  if (IsInside<Dir1>(mv_x, mv_y, &state.mv_min, &state.mv_max) &&
+      IsInside<Dir2>(mv_x, mv_y, &state.mv_min, &state.mv_max)) {
+    cand_list->Add(mv_x, mv_y, Dir1::index + Dir2::index, range);
   }
-  state->last_position = Dir1::index + Dir2::index;
-  state->last_range_ = range;
-  return true;
 }
 
 }   // namespace xvc
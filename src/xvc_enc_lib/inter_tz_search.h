@@ -23,6 +23,7 @@
 #include "xvc_common_lib/inter_prediction.h"
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/simd_functions.h"
 #include "xvc_enc_lib/sample_metric.h"
 #include "xvc_enc_lib/encoder_settings.h"
 
@@ -30,10 +31,11 @@ namespace xvc {
 
 class TzSearch {
 public:
-  TzSearch(int bitdepth, const YuvPicture &orig_pic,
+  TzSearch(const SimdFunctions &simd, int bitdepth, const YuvPicture &orig_pic,
            const InterPrediction &inter_pred,
            const EncoderSettings &encoder_settings, int search_range)
-    : orig_pic_(orig_pic),
+    : simd_(simd),
+    orig_pic_(orig_pic),
     inter_pred_(inter_pred),
     encoder_settings_(encoder_settings),
     bitdepth_(bitdepth),
@@ -51,20 +53,31 @@ private:
   struct Up { static const int index = -3; };
   struct Down { static const int index = 3; };
   struct SearchState;
+  struct CandidateList;
   template<typename TOrig> class DistortionWrapper;
 
   bool FullpelDiamondSearch(SearchState *state, const MotionVector &mv_base,
                             int range);
   void FullpelNeighborPointSearch(SearchState *state);
+  void FullpelRasterSearch(SearchState *state, const MotionVector &mv_min,
+                           const MotionVector &mv_max, int step_size);
   Distortion GetCost(SearchState *state, int mv_x, int mv_y);
+  void GetCosts(SearchState *state, const CandidateList &cand_list,
+                Distortion *costs);
   bool CheckCostBest(SearchState *state, int mv_x, int mv_y);
+  bool UpdateCostBest(SearchState *state, int mv_x, int mv_y,
+                      Distortion cost);
+  bool CheckCandidates(SearchState *state, const CandidateList &cand_list);
   template<class Dir>
-  bool CheckCost1(SearchState *state, int mv_x, int mv_y, int range);
+  void AddCandidate1(const SearchState &state, int mv_x, int mv_y, int range,
+                     CandidateList *cand_list);
   template<class Dir1, class Dir2>
-  bool CheckCost2(SearchState *state, int mv_x, int mv_y, int range);
+  void AddCandidate2(const SearchState &state, int mv_x, int mv_y, int range,
+                     CandidateList *cand_list);
   template<class Dir>
   bool IsInside(int mv_x, int mv_y, const_mv *mv_min, const_mv *mv_max);
 
+  const SimdFunctions &simd_;
   const YuvPicture &orig_pic_;
   const InterPrediction &inter_pred_;
   const EncoderSettings &encoder_settings_;
@@ -61,12 +61,18 @@ IntraSearch::SearchIntraLuma(CodingUnit *cu, YuvComponent comp, const Qp &qp,
   IntraPredictorLuma mpm = GetPredictorLuma(*cu);
   IntraPrediction::State intra_state =
     ComputeReferenceState(*cu, comp, reco, reco_stride);
+  const bool restrict_above_right = IsAboveRightRestricted(*cu);
 
   SampleBuffer &pred_buf = encoder->GetPredBuffer();
   SampleMetric metric(MetricType::kSatd, qp, rec_pic->GetBitdepth());
   std::array<std::pair<IntraMode, double>, IntraMode::kTotalNumber> modes_cost;
   for (int i = 0; i < IntraMode::kTotalNumber; i++) {
     IntraMode intra_mode = static_cast<IntraMode>(i);
+    if (restrict_above_right && UsesAboveRight(intra_mode)) {
+      modes_cost[i] =
+        std::make_pair(intra_mode, std::numeric_limits<double>::max());
+      continue;
+    }
     Predict(intra_mode, *cu, comp, intra_state,
             pred_buf.GetDataPtr(), pred_buf.GetStride());
 
@@ -113,6 +119,9 @@ IntraSearch::SearchIntraLuma(CodingUnit *cu, YuvComponent comp, const Qp &qp,
   Cost best_cost = std::numeric_limits<Cost>::max();
   for (int i = 0; i < num_modes_for_slow_rdo; i++) {
     IntraMode intra_mode = modes_cost[i].first;
+    if (restrict_above_right && UsesAboveRight(intra_mode)) {
+      continue;
+    }
     cu->SetIntraModeLuma(intra_mode);
 
     // Full reconstruction
@@ -145,9 +154,14 @@ IntraSearch::SearchIntraChroma(CodingUnit *cu, const Qp &qp,
   if (Restrictions::Get().disable_intra_chroma_predictor) {
     return best_mode;
   }
+  const bool restrict_above_right = IsAboveRightRestricted(*cu);
   for (int i = 0; i < static_cast<int>(chroma_modes.size()); i++) {
     IntraChromaMode chroma_mode = chroma_modes[i];
     cu->SetIntraModeChroma(chroma_mode);
+    if (restrict_above_right &&
+        UsesAboveRight(cu->GetIntraMode(YuvComponent::kU))) {
+      continue;
+    }
 
     // Full reconstruction
     Distortion ssd = 0;
@@ -186,4 +200,19 @@ Distortion IntraSearch::CompressIntra(CodingUnit *cu, YuvComponent comp,
                                           rec_pic);
 }
 
+bool IntraSearch::UsesAboveRight(IntraMode intra_mode) {
+  // Pure vertical and horizontal modes are never filtered and the dc
+  // predictor only reads the samples directly above. Modes pointing down
+  // left also filter the left samples only.
+  return intra_mode != IntraMode::kDc && intra_mode != IntraMode::kVertical &&
+    (intra_mode < 2 || intra_mode > IntraMode::kHorizontal);
+}
+
+bool IntraSearch::IsAboveRightRestricted(const CodingUnit &cu) const {
+  const int posx = cu.GetPosX(YuvComponent::kY);
+  return posx < above_right_limit_x_ &&
+    posx + cu.GetWidth(YuvComponent::kY) +
+    cu.GetCuSizeAboveRight(YuvComponent::kY) > above_right_limit_x_;
+}
+
 }   // namespace xvc
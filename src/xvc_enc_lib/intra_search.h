@@ -19,6 +19,8 @@
 #ifndef XVC_ENC_LIB_INTRA_SEARCH_H_
 #define XVC_ENC_LIB_INTRA_SEARCH_H_
 
+#include <limits>
+
 #include "xvc_common_lib/intra_prediction.h"
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_enc_lib/syntax_writer.h"
@@ -44,12 +46,19 @@ public:
   Distortion CompressIntra(CodingUnit *cu, YuvComponent comp, const Qp &qp,
                            const SyntaxWriter &writer,
                            TransformEncoder *encoder, YuvPicture *rec_pic);
+  // Cus left of luma position limit_x only use modes that do not read
+  // above right reference samples at or beyond that position
+  void SetAboveRightLimit(int limit_x) { above_right_limit_x_ = limit_x; }
 
 private:
+  static bool UsesAboveRight(IntraMode intra_mode);
+  bool IsAboveRightRestricted(const CodingUnit &cu) const;
+
   const PictureData &pic_data_;
   const YuvPicture &orig_pic_;
   const EncoderSettings &encoder_settings_;
   CuWriter cu_writer_;
+  int above_right_limit_x_ = std::numeric_limits<int>::max();
 };
 
 }   // namespace xvc
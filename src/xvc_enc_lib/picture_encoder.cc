@@ -34,16 +34,27 @@ namespace xvc {
 
 PictureEncoder::PictureEncoder(const SimdFunctions &simd,
                                ChromaFormat chroma_format, int width,
-                               int height, int bitdepth)
+                               int height, int bitdepth,
+                               std::shared_ptr<CuStoragePool> cu_pool)
   : simd_(simd),
   orig_pic_(std::make_shared<YuvPicture>(chroma_format, width, height,
                                          bitdepth, false)),
   pic_data_(std::make_shared<PictureData>(chroma_format, width, height,
-                                          bitdepth)),
+                                          bitdepth, std::move(cu_pool))),
   rec_pic_(std::make_shared<YuvPicture>(chroma_format, width, height,
                                         bitdepth, true)) {
 }
 
+void PictureEncoder::SetReferencePictures(
+  const std::vector<std::shared_ptr<const PictureEncoder>> &ref_pics) {
+  ref_subpel_planes_.clear();
+  for (auto &ref_pic : ref_pics) {
+    if (ref_pic->GetSubpelPlanes()) {
+      ref_subpel_planes_.push_back(ref_pic->GetSubpelPlanes());
+    }
+  }
+}
+
 std::vector<uint8_t>*
 PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
                        PicNum sub_gop_length, int buffer_flag,
@@ -65,6 +76,14 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
              encoder_settings.chroma_qp_offset_v);
 
   pic_data_->Init(segment, base_qp, encoder_settings.adaptive_qp > 0);
+  if (encoder_settings.subpel_planes) {
+    if (!subpel_planes_) {
+      subpel_planes_ = std::make_shared<SubpelPlanes>(*rec_pic_);
+    }
+    subpel_planes_->Invalidate();
+  } else {
+    subpel_planes_.reset();
+  }
 
   bit_writer_.Clear();
   if (encoder_settings.encapsulation_mode != 0) {
@@ -79,7 +98,7 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
                       &entropy_encoder);
   std::unique_ptr<CuEncoder>
     cu_encoder(new CuEncoder(simd_, *orig_pic_, rec_pic_.get(), pic_data_.get(),
-                             encoder_settings));
+                             encoder_settings, ref_subpel_planes_));
   int num_ctus = pic_data_->GetNumberOfCtu();
   for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
     cu_encoder->EncodeCtu(rsaddr, &writer);
@@ -90,6 +109,10 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
                                pic_data_->GetTcOffset());
     deblocker.DeblockPicture();
   }
+  // Only the motion field is needed after this point
+  cu_encoder.reset();
+  ref_subpel_planes_.clear();
+  pic_data_->ReleaseCodingUnits();
   entropy_encoder.EncodeBinTrm(1);
   entropy_encoder.Finish();
 
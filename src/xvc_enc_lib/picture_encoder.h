@@ -31,6 +31,7 @@
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_enc_lib/bit_writer.h"
 #include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/subpel_planes.h"
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/xvcenc.h"
 
@@ -39,7 +40,8 @@ namespace xvc {
 class PictureEncoder {
 public:
   PictureEncoder(const SimdFunctions &simd, ChromaFormat chroma_format,
-                 int width, int height, int bitdepth);
+                 int width, int height, int bitdepth,
+                 std::shared_ptr<CuStoragePool> cu_pool = nullptr);
   std::shared_ptr<YuvPicture> GetOrigPic() { return orig_pic_; }
   std::shared_ptr<const PictureData> GetPicData() const { return pic_data_; }
   std::shared_ptr<PictureData> GetPicData() { return pic_data_; }
@@ -47,6 +49,13 @@ public:
   std::shared_ptr<YuvPicture> GetRecPic() { return rec_pic_; }
   void SetOutputStatus(OutputStatus status) { output_status_ = status; }
   OutputStatus GetOutputStatus() const { return output_status_; }
+  // Interpolated planes of the reconstruction are filled in on demand by
+  // the pictures referencing this picture
+  std::shared_ptr<SubpelPlanes> GetSubpelPlanes() const {
+    return subpel_planes_;
+  }
+  void SetReferencePictures(
+    const std::vector<std::shared_ptr<const PictureEncoder>> &ref_pics);
 
   std::vector<uint8_t>* Encode(const SegmentHeader &segment, int segment_qp,
                                PicNum sub_gop_length, int buffer_flag,
@@ -68,6 +77,8 @@ private:
   std::shared_ptr<YuvPicture> orig_pic_;
   std::shared_ptr<PictureData> pic_data_;
   std::shared_ptr<YuvPicture> rec_pic_;
+  std::shared_ptr<SubpelPlanes> subpel_planes_;
+  std::vector<std::shared_ptr<SubpelPlanes>> ref_subpel_planes_;
   OutputStatus output_status_ = OutputStatus::kHasNotBeenOutput;
 };
 
@@ -20,7 +20,6 @@
 
 #include <algorithm>
 #include <cassert>
-#include <functional>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -216,6 +215,18 @@ int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
   }
 }
 
+bool RdoQuant::IsQuantizedToZero(YuvComponent comp, const Qp &qp, int width,
+                                 int height, int64_t max_abs_coeff) const {
+  // Rdo quant never selects a level above the rounded one and the rounding
+  // offset of fast quant is smaller
+  const FwdQuantizer fwd_quant = GetFwdQuantFunc(comp, qp, width, height);
+  if (max_abs_coeff > constants::kInt16Max) {
+    return false;
+  }
+  return (max_abs_coeff * fwd_quant.scale + fwd_quant.offset) >>
+    fwd_quant.shift == 0;
+}
+
 template<int SubBlockShift>
 int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
                        const Qp &qp, PicturePredictionType pic_type,
@@ -672,7 +683,7 @@ Coeff
 RdoQuant::QuantCoeffRdo(YuvComponent comp, Coeff orig_coeff, Coeff max_level,
                         const CoeffCodingState &code_state, Bits sig1_bits,
                         int64_t lambda, int cost_scale, CabacContexts *contexts,
-                        const std::function<Coeff(Coeff)> &inv_quant,
+                        const InvQuantizer &inv_quant,
                         int64_t *out_cost) const {
   int64_t best_cost = std::numeric_limits<int64_t>::max();
   Coeff best_level = max_level;
@@ -916,9 +927,9 @@ Bits RdoQuant::GetLastPosBits(int width, int height, YuvComponent comp,
   return bits;
 }
 
-std::function<Coeff(Coeff)>
+RdoQuant::FwdQuantizer
 RdoQuant::GetFwdQuantFunc(YuvComponent comp, const Qp &qp, int width,
-                          int height) {
+                          int height) const {
   const bool size_rounding_bias =
     (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
   const int transform_shift =
@@ -927,16 +938,12 @@ RdoQuant::GetFwdQuantFunc(YuvComponent comp, const Qp &qp, int width,
     transform_shift + (size_rounding_bias ? 7 : 0);
   const int scale = qp.GetFwdScale(comp) * (size_rounding_bias ? 181 : 1);
   const int64_t offset = 1ull << (shift - 1);
-  return [scale, offset, shift](const Coeff abs_coeff) {
-    int level = static_cast<int>(
-      ((static_cast<int64_t>(abs_coeff) * scale) + offset) >> shift);
-    return static_cast<Coeff>(level);
-  };
+  return FwdQuantizer{ scale, shift, offset };
 }
 
-std::function<Coeff(Coeff)>
+RdoQuant::InvQuantizer
 RdoQuant::GetInvQuantFunc(YuvComponent comp, const Qp &qp, int width,
-                          int height) {
+                          int height) const {
   const bool size_rounding_bias =
     (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
   const int transform_shift =
@@ -944,16 +951,8 @@ RdoQuant::GetInvQuantFunc(YuvComponent comp, const Qp &qp, int width,
   const int shift = Quantize::kIQuantShift - transform_shift +
     (size_rounding_bias ? 8 : 0);
   const int scale = qp.GetInvScale(comp) * (size_rounding_bias ? 181 : 1);
-  const int offset = (1 << (shift - 1));
-  return [scale, shift, offset](Coeff in) {
-    if (shift > 0) {
-      int coeff = ((in * scale) + offset) >> shift;
-      return util::Clip3(coeff, constants::kInt16Min, constants::kInt16Max);
-    } else {
-      int coeff = ((in * scale)) << -shift;
-      return util::Clip3(coeff, constants::kInt16Min, constants::kInt16Max);
-    }
-  };
+  const int offset = shift > 0 ? (1 << (shift - 1)) : 0;
+  return InvQuantizer{ scale, shift, offset };
 }
 
 }   // namespace xvc
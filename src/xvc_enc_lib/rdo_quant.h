@@ -19,8 +19,6 @@
 #ifndef XVC_ENC_LIB_RDO_QUANT_H_
 #define XVC_ENC_LIB_RDO_QUANT_H_
 
-#include <functional>
-
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/quantize.h"
 #include "xvc_enc_lib/syntax_writer.h"
@@ -38,12 +36,35 @@ public:
                PicturePredictionType pic_type, const SyntaxWriter &writer,
                const Coeff *in, ptrdiff_t in_stride,
                Coeff *out, ptrdiff_t out_stride);
+  // Returns true if all coefficients up to the given magnitude are quantized
+  // to zero by both QuantFast and QuantRdo
+  bool IsQuantizedToZero(YuvComponent comp, const Qp &qp, int width,
+                         int height, int64_t max_abs_coeff) const;
 
 private:
   static const int kStorageSize =
     constants::kMaxBlockSize * constants::kMaxBlockSize;
   static const int kLambdaPrecision = 16;
   struct CoeffCodingState;
+  struct FwdQuantizer {
+    Coeff operator()(Coeff abs_coeff) const {
+      return static_cast<Coeff>(
+        ((static_cast<int64_t>(abs_coeff) * scale) + offset) >> shift);
+    }
+    int scale;
+    int shift;
+    int64_t offset;
+  };
+  struct InvQuantizer {
+    Coeff operator()(Coeff in) const {
+      int coeff = shift > 0 ? ((in * scale) + offset) >> shift :
+        (in * scale) << -shift;
+      return util::Clip3(coeff, constants::kInt16Min, constants::kInt16Max);
+    }
+    int scale;
+    int shift;
+    int offset;
+  };
   template<int SubBlockShift>
   int QuantRdo(const CodingUnit &cu, YuvComponent comp, const Qp &qp,
                PicturePredictionType pic_type, const SyntaxWriter &writer,
@@ -61,7 +82,7 @@ private:
   Coeff QuantCoeffRdo(YuvComponent comp, Coeff orig_coeff, Coeff level,
                       const CoeffCodingState &code_state, Bits sig1_bits,
                       int64_t lambda, int cost_scale, CabacContexts *contexts,
-                      const std::function<Coeff(Coeff)> &inv_quant,
+                      const InvQuantizer &inv_quant,
                       int64_t *out_cost) const;
   bool EvalZeroSubblock(int subblock_index, int size, bool subblock_csbf,
                         const ContextModel &csbf_ctx, int last_pos_index,
@@ -84,10 +105,10 @@ private:
   Bits GetLastPosBits(int width, int height, YuvComponent comp,
                       ScanOrder scan_order, CabacContexts *contexts,
                       int last_pos_x, int last_pos_y) const;
-  std::function<Coeff(Coeff)> GetFwdQuantFunc(YuvComponent comp, const Qp &qp,
-                                              int width, int height);
-  std::function<Coeff(Coeff)> GetInvQuantFunc(YuvComponent comp, const Qp &qp,
-                                              int width, int height);
+  FwdQuantizer GetFwdQuantFunc(YuvComponent comp, const Qp &qp,
+                               int width, int height) const;
+  InvQuantizer GetInvQuantFunc(YuvComponent comp, const Qp &qp,
+                               int width, int height) const;
   int64_t BitCost(Bits bits, int64_t lambda) const {
     return (bits * lambda) >> kLambdaPrecision;
   }
@@ -20,6 +20,7 @@
 
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include <cstdlib>
 #include <limits>
 
@@ -95,6 +96,58 @@ Distortion SampleMetric::CompareShort(YuvComponent comp, int width, int height,
   return Compare(comp, width, height, src1, stride1, src2, stride2);
 }
 
+void
+SampleMetric::CompareSampleMulti(YuvComponent comp, int width, int height,
+                                 const Sample *src1, ptrdiff_t stride1,
+                                 const Sample *const *src2, ptrdiff_t stride2,
+                                 int num, Distortion *dist) {
+  CompareMulti(comp, width, height, src1, stride1, src2, stride2, num, dist,
+               sad_func_ ? sad_func_->sad_sample : nullptr);
+}
+
+void
+SampleMetric::CompareSampleMulti(YuvComponent comp, int width, int height,
+                                 const Residual *src1, ptrdiff_t stride1,
+                                 const Sample *const *src2, ptrdiff_t stride2,
+                                 int num, Distortion *dist) {
+  CompareMulti(comp, width, height, src1, stride1, src2, stride2, num, dist,
+               sad_func_ ? sad_func_->sad_short : nullptr);
+}
+
+template<typename SampleT1>
+void
+SampleMetric::CompareMulti(YuvComponent comp, int width, int height,
+                           const SampleT1 *src1, ptrdiff_t stride1,
+                           const Sample *const *src2, ptrdiff_t stride2,
+                           int num, Distortion *dist,
+                           SadFunc<SampleT1> sad_func) {
+  if (!sad_func ||
+      (type_ != MetricType::kSad && type_ != MetricType::kSadFast)) {
+    for (int i = 0; i < num; i++) {
+      dist[i] = Compare(comp, width, height, src1, stride1, src2[i], stride2);
+    }
+    return;
+  }
+  // Same result as ComputeSad and ComputeSadFast for each candidate
+  const int kNumCand = SimdFunctions::SadFunc::kNumCand;
+  const int row_step = type_ == MetricType::kSadFast ? 2 : 1;
+  const int sad_height = (height + row_step - 1) / row_step;
+  const double weight = qp_.GetDistortionWeight(comp);
+  for (int i = 0; i < num; i += kNumCand) {
+    const Sample *cand[kNumCand];
+    uint64_t sad[kNumCand];
+    for (int j = 0; j < kNumCand; j++) {
+      cand[j] = src2[std::min(i + j, num - 1)];
+    }
+    sad_func(width, sad_height, src1, stride1 * row_step, cand,
+             stride2 * row_step, sad);
+    for (int j = 0; j < kNumCand && i + j < num; j++) {
+      uint64_t sum = sad[j] * row_step;
+      dist[i + j] = static_cast<Distortion>((sum >> (bitdepth_ - 8)) * weight);
+    }
+  }
+}
+
 template<typename SampleT1, typename SampleT2>
 Distortion
 SampleMetric::Compare(YuvComponent comp, int width, int height,
@@ -24,6 +24,7 @@
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/sample_buffer.h"
+#include "xvc_common_lib/simd_functions.h"
 #include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/yuv_pic.h"
 
@@ -43,6 +44,10 @@ public:
   SampleMetric(MetricType type, const Qp &qp, int bitdepth)
     : type_(type), qp_(qp), bitdepth_(bitdepth) {
   }
+  SampleMetric(const SimdFunctions &simd, MetricType type, const Qp &qp,
+               int bitdepth)
+    : type_(type), qp_(qp), bitdepth_(bitdepth), sad_func_(&simd.sad) {
+  }
   // Sample vs Sample
   Distortion CompareSample(const CodingUnit &cu, YuvComponent comp,
                            const YuvPicture &src1, const YuvPicture &src2);
@@ -68,8 +73,28 @@ public:
   Distortion CompareShort(YuvComponent comp, int width, int height,
                           const Residual *src1, ptrdiff_t stride1,
                           const Residual *src2, ptrdiff_t stride2);
+  // Sample vs multiple candidate positions sharing the same stride
+  void CompareSampleMulti(YuvComponent comp, int width, int height,
+                          const Sample *src1, ptrdiff_t stride1,
+                          const Sample *const *src2, ptrdiff_t stride2,
+                          int num, Distortion *dist);
+  // Residual vs multiple candidate positions sharing the same stride
+  void CompareSampleMulti(YuvComponent comp, int width, int height,
+                          const Residual *src1, ptrdiff_t stride1,
+                          const Sample *const *src2, ptrdiff_t stride2,
+                          int num, Distortion *dist);
 
 private:
+  template<typename SampleT1>
+  using SadFunc = void(*)(int width, int height,
+                          const SampleT1 *src1, ptrdiff_t stride1,
+                          const Sample *const *src2, ptrdiff_t stride2,
+                          uint64_t *sad);
+  template<typename SampleT1>
+  void CompareMulti(YuvComponent comp, int width, int height,
+                    const SampleT1 *src1, ptrdiff_t stride1,
+                    const Sample *const *src2, ptrdiff_t stride2,
+                    int num, Distortion *dist, SadFunc<SampleT1> sad_func);
   template<typename SampleT1, typename SampleT2>
   Distortion Compare(YuvComponent comp, int width, int height,
                      const SampleT1 *src1, ptrdiff_t stride1,
@@ -107,6 +132,7 @@ private:
   MetricType type_;
   const Qp &qp_;
   int bitdepth_;
+  const SimdFunctions::SadFunc *sad_func_ = nullptr;
   std::vector<double> lambdas_;
 };
 
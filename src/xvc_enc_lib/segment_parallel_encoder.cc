@@ -0,0 +1,257 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/segment_parallel_encoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "xvc_common_lib/restrictions.h"
+#include "xvc_enc_lib/encoder.h"
+
+namespace xvc {
+
+SegmentParallelEncoder::SegmentParallelEncoder(int num_threads,
+                                               PicNum chunk_length,
+                                               size_t input_picture_size,
+                                               EncoderFactory encoder_factory)
+  : chunk_length_(chunk_length),
+  input_picture_size_(input_picture_size),
+  encoder_factory_(encoder_factory) {
+  assert(chunk_length_ > 0);
+  if (num_threads < 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  // Need at least one thread to work
+  num_threads = std::max(1, num_threads);
+  // One chunk for each worker and one being delivered
+  max_chunks_ = num_threads + 1;
+  while (num_threads > static_cast<int>(worker_threads_.size())) {
+    worker_threads_.emplace_back([this] {
+      WorkerMain();
+    });
+  }
+}
+
+SegmentParallelEncoder::~SegmentParallelEncoder() {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  running_ = false;
+  wait_work_cond_.notify_all();  // wakeup all
+  lock.unlock();
+  for (auto &thread : worker_threads_) {
+    thread.join();
+  }
+  worker_threads_.clear();
+}
+
+int SegmentParallelEncoder::Encode(const uint8_t *pic_bytes,
+                                   xvc_enc_nal_unit **nal_units,
+                                   bool output_rec,
+                                   xvc_enc_pic_buffer *rec_pic) {
+  std::shared_ptr<PictureBytes> pic =
+    std::make_shared<PictureBytes>(pic_bytes, pic_bytes + input_picture_size_);
+  if (curr_chunk_ && curr_chunk_->num_pics == chunk_length_) {
+    // First picture of next chunk is also encoded by current chunk
+    curr_chunk_->input_pics.push_back(pic);
+    curr_chunk_->has_next_chunk_pic = true;
+    DispatchChunk();
+  }
+  if (!curr_chunk_) {
+    curr_chunk_.reset(new Chunk());
+    curr_chunk_->output_rec = output_rec;
+  }
+  curr_chunk_->input_pics.push_back(std::move(pic));
+  curr_chunk_->num_pics++;
+  return DeliverOutput(false, nal_units, rec_pic);
+}
+
+int SegmentParallelEncoder::Flush(xvc_enc_nal_unit **nal_units,
+                                  xvc_enc_pic_buffer *rec_pic) {
+  if (curr_chunk_) {
+    DispatchChunk();
+  }
+  return DeliverOutput(true, nal_units, rec_pic);
+}
+
+void SegmentParallelEncoder::DispatchChunk() {
+  // Encoder is created on calling thread using the current encoder settings
+  curr_chunk_->encoder = encoder_factory_();
+  curr_chunk_->base_poc = next_base_poc_;
+  next_base_poc_ += curr_chunk_->num_pics;
+
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  // Back-pressure, a finished oldest chunk is delivered by the caller
+  work_done_cond_.wait(lock, [this] {
+    return static_cast<int>(chunks_.size()) < max_chunks_ ||
+      chunks_.front()->finished;
+  });
+  pending_chunks_.push_back(curr_chunk_.get());
+  chunks_.push_back(std::move(curr_chunk_));
+  wait_work_cond_.notify_one();
+}
+
+int SegmentParallelEncoder::DeliverOutput(bool wait_all,
+                                          xvc_enc_nal_unit **nal_units,
+                                          xvc_enc_pic_buffer *rec_pic) {
+  // Nal units from previous call are no longer referenced by the caller
+  output_nals_.clear();
+  output_chunks_.clear();
+
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  while (!chunks_.empty()) {
+    Chunk *chunk = chunks_.front().get();
+    if (!chunk->finished) {
+      if (!wait_all) {
+        break;
+      }
+      work_done_cond_.wait(lock, [chunk] { return chunk->finished; });
+    }
+    // Translate picture counters from chunk local to bitstream global values
+    SegmentNum num_segments = 0;
+    for (size_t i = 0; i < chunk->nal_units.size(); i++) {
+      xvc_enc_nal_unit nal = chunk->nal_units[i];
+      nal.bytes = &chunk->nal_bytes[i][0];
+      if (nal.stats.nal_unit_type ==
+          static_cast<uint32_t>(NalUnitType::kSegmentHeader)) {
+        num_segments++;
+        output_nals_.push_back(nal);
+        continue;
+      }
+      xvc_enc_nal_stats &stats = nal.stats;
+      stats.poc += static_cast<uint32_t>(chunk->base_poc);
+      if (stats.doc == 0) {
+        // Intra access picture is encoded before tail pictures of prev chunk
+        stats.doc =
+          static_cast<uint32_t>(chunk->base_poc - prev_num_tail_pics_);
+      } else {
+        stats.doc += static_cast<uint32_t>(chunk->base_poc);
+      }
+      stats.soc += static_cast<uint32_t>(base_soc_);
+      int length = sizeof(stats.l0) / sizeof(stats.l0[0]);
+      for (int j = 0; j < length; j++) {
+        if (stats.l0[j] >= 0) {
+          stats.l0[j] += static_cast<int32_t>(chunk->base_poc);
+        }
+        if (stats.l1[j] >= 0) {
+          stats.l1[j] += static_cast<int32_t>(chunk->base_poc);
+        }
+      }
+      output_nals_.push_back(nal);
+    }
+    base_soc_ += num_segments;
+    prev_num_tail_pics_ = chunk->num_tail_pics;
+    for (auto &rec : chunk->rec_pics) {
+      rec_pics_.push_back(std::move(rec));
+    }
+    // Keep bytes alive until next call to this function
+    output_chunks_.push_back(std::move(chunks_.front()));
+    chunks_.pop_front();
+  }
+  lock.unlock();
+
+  if (rec_pic) {
+    rec_pic->pic = nullptr;
+    rec_pic->size = 0;
+    if (!rec_pics_.empty()) {
+      output_rec_bytes_ = std::move(rec_pics_.front());
+      rec_pics_.pop_front();
+      rec_pic->pic = &output_rec_bytes_[0];
+      rec_pic->size = output_rec_bytes_.size();
+    }
+  }
+  if (output_nals_.size() > 0) {
+    *nal_units = &output_nals_[0];
+  }
+  return static_cast<int>(output_nals_.size());
+}
+
+void SegmentParallelEncoder::WorkerMain() {
+  std::unique_lock<std::mutex> lock(global_mutex_);
+  while (true) {
+    wait_work_cond_.wait(lock, [this] {
+      return !running_ || !pending_chunks_.empty();
+    });
+    if (!running_) {
+      break;
+    }
+    Chunk *chunk = pending_chunks_.front();
+    pending_chunks_.pop_front();
+    lock.unlock();
+
+    EncodeChunk(chunk);
+
+    lock.lock();
+    chunk->finished = true;
+    work_done_cond_.notify_all();
+  }
+}
+
+void SegmentParallelEncoder::EncodeChunk(Chunk *chunk) {
+  Encoder *encoder = chunk->encoder.get();
+  // Restriction flags are thread local
+  Restrictions::GetRW() = encoder->GetCurrentSegment()->restrictions;
+  xvc_enc_nal_unit *nal_units = nullptr;
+  xvc_enc_pic_buffer rec_pic = { nullptr, 0 };
+  for (size_t i = 0; i < chunk->input_pics.size(); i++) {
+    int num_nals = encoder->Encode(&(*chunk->input_pics[i])[0], &nal_units,
+                                   chunk->output_rec, &rec_pic);
+    bool next_chunk_pic =
+      chunk->has_next_chunk_pic && i + 1 == chunk->input_pics.size();
+    StoreNalUnits(nal_units, num_nals, next_chunk_pic, chunk);
+    StoreRecPicture(rec_pic, chunk);
+  }
+  chunk->input_pics.clear();
+  int num_nals;
+  do {
+    num_nals = encoder->Flush(&nal_units, chunk->output_rec, &rec_pic);
+    StoreNalUnits(nal_units, num_nals, false, chunk);
+    StoreRecPicture(rec_pic, chunk);
+  } while (num_nals > 0 || rec_pic.size > 0);
+  // Release memory as soon as possible, output is kept until delivered
+  chunk->encoder.reset();
+}
+
+void SegmentParallelEncoder::StoreNalUnits(const xvc_enc_nal_unit *nal_units,
+                                           int num, bool drop_next_chunk_pic,
+                                           Chunk *chunk) {
+  for (int i = 0; i < num; i++) {
+    const xvc_enc_nal_unit &nal = nal_units[i];
+    if (drop_next_chunk_pic) {
+      // Only the tail pictures of the last segment are kept, the segment
+      // header and intra access picture are encoded by next chunk
+      if (!nal.buffer_flag) {
+        continue;
+      }
+      chunk->num_tail_pics++;
+    }
+    chunk->nal_bytes.emplace_back(nal.bytes, nal.bytes + nal.size);
+    chunk->nal_units.push_back(nal);
+  }
+}
+
+void SegmentParallelEncoder::StoreRecPicture(const xvc_enc_pic_buffer &rec_pic,
+                                             Chunk *chunk) {
+  // Reconstruction of first picture in next chunk is not output
+  if (rec_pic.size > 0 &&
+      static_cast<PicNum>(chunk->rec_pics.size()) < chunk->num_pics) {
+    chunk->rec_pics.emplace_back(rec_pic.pic, rec_pic.pic + rec_pic.size);
+  }
+}
+
+}   // namespace xvc
@@ -0,0 +1,108 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_SEGMENT_PARALLEL_ENCODER_H_
+#define XVC_ENC_LIB_SEGMENT_PARALLEL_ENCODER_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_enc_lib/xvcenc.h"
+
+namespace xvc {
+
+class Encoder;
+
+// Encodes chunks of closed gop segments concurrently, each chunk on its own
+// Encoder instance. Every chunk except the last one also encodes the first
+// picture of the following chunk so that its tail pictures are coded exactly
+// as a single encoder would have done, the segment header and intra access
+// picture of that extra picture are then dropped when stitching the chunks.
+// Nal units are delivered chunk by chunk in bitstream order. The number of
+// chunks not yet delivered is limited, adding a chunk blocks until the
+// oldest chunk has been encoded when the limit is reached.
+class SegmentParallelEncoder {
+public:
+  using EncoderFactory = std::function<std::unique_ptr<Encoder>()>;
+
+  SegmentParallelEncoder(int num_threads, PicNum chunk_length,
+                         size_t input_picture_size,
+                         EncoderFactory encoder_factory);
+  ~SegmentParallelEncoder();
+  int Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
+             bool output_rec, xvc_enc_pic_buffer *rec_pic);
+  int Flush(xvc_enc_nal_unit **nal_units, xvc_enc_pic_buffer *rec_pic);
+
+private:
+  using PictureBytes = std::vector<uint8_t>;
+  struct Chunk {
+    std::unique_ptr<Encoder> encoder;
+    std::vector<std::shared_ptr<PictureBytes>> input_pics;
+    bool has_next_chunk_pic = false;
+    bool output_rec = false;
+    std::vector<PictureBytes> nal_bytes;
+    std::vector<xvc_enc_nal_unit> nal_units;
+    std::deque<PictureBytes> rec_pics;
+    PicNum base_poc = 0;
+    PicNum num_pics = 0;
+    PicNum num_tail_pics = 0;
+    bool finished = false;
+  };
+  void DispatchChunk();
+  int DeliverOutput(bool wait_all, xvc_enc_nal_unit **nal_units,
+                    xvc_enc_pic_buffer *rec_pic);
+  void WorkerMain();
+  static void EncodeChunk(Chunk *chunk);
+  static void StoreNalUnits(const xvc_enc_nal_unit *nal_units, int num,
+                            bool drop_next_chunk_pic, Chunk *chunk);
+  static void StoreRecPicture(const xvc_enc_pic_buffer &rec_pic,
+                              Chunk *chunk);
+
+  const PicNum chunk_length_;
+  const size_t input_picture_size_;
+  EncoderFactory encoder_factory_;
+  int max_chunks_;
+  std::unique_ptr<Chunk> curr_chunk_;
+  PicNum next_base_poc_ = 0;
+  // Counters of chunks that have been delivered
+  SegmentNum base_soc_ = 0;
+  PicNum prev_num_tail_pics_ = 0;
+  std::vector<xvc_enc_nal_unit> output_nals_;
+  std::vector<std::unique_ptr<Chunk>> output_chunks_;
+  std::deque<PictureBytes> rec_pics_;
+  PictureBytes output_rec_bytes_;
+  std::vector<std::thread> worker_threads_;
+  std::mutex global_mutex_;
+  std::condition_variable wait_work_cond_;
+  std::condition_variable work_done_cond_;
+  // Chunks are kept in bitstream order, pending points to chunks not started
+  std::deque<std::unique_ptr<Chunk>> chunks_;
+  std::deque<Chunk*> pending_chunks_;
+  bool running_ = true;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_SEGMENT_PARALLEL_ENCODER_H_
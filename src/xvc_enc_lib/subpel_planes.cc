@@ -0,0 +1,83 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/subpel_planes.h"
+
+#include <algorithm>
+
+namespace xvc {
+
+SubpelPlanes::SubpelPlanes(const YuvPicture &ref_pic)
+  : ref_pic_(ref_pic),
+  plane_width_(ref_pic.GetWidth(YuvComponent::kY) + 2 * kMargin),
+  plane_height_(ref_pic.GetHeight(YuvComponent::kY) + 2 * kMargin),
+  num_bands_((plane_height_ + kBandHeight - 1) / kBandHeight) {
+}
+
+void SubpelPlanes::Invalidate() {
+  for (auto &ready : band_ready_) {
+    std::fill(ready.begin(), ready.end(), static_cast<uint8_t>(0));
+  }
+}
+
+const Sample*
+SubpelPlanes::GetBlock(int pos_x, int pos_y, int frac_x, int frac_y,
+                       int width, int height, InterPrediction *inter_pred,
+                       ptrdiff_t *stride) {
+  const YuvComponent comp = YuvComponent::kY;
+  if (frac_x == 0 && frac_y == 0) {
+    *stride = ref_pic_.GetStride(comp);
+    return ref_pic_.GetSamplePtr(comp, pos_x, pos_y);
+  }
+  const int plane_x = pos_x + kMargin;
+  const int plane_y = pos_y + kMargin;
+  if (plane_x < 0 || plane_y < 0 || plane_x + width > plane_width_ ||
+      plane_y + height > plane_height_) {
+    return nullptr;
+  }
+  const int phase = (frac_y << constants::kMvPrecisionShift) + frac_x;
+  if (planes_[phase].empty()) {
+    planes_[phase].resize(plane_width_ * plane_height_);
+    band_ready_[phase].resize(num_bands_, 0);
+  }
+  const int last_band = (plane_y + height - 1) / kBandHeight;
+  for (int band = plane_y / kBandHeight; band <= last_band; band++) {
+    if (!band_ready_[phase][band]) {
+      InterpolateBand(frac_x, frac_y, band, inter_pred);
+      band_ready_[phase][band] = 1;
+    }
+  }
+  *stride = plane_width_;
+  return &planes_[phase][plane_y * plane_width_ + plane_x];
+}
+
+void SubpelPlanes::InterpolateBand(int frac_x, int frac_y, int band,
+                                   InterPrediction *inter_pred) {
+  const YuvComponent comp = YuvComponent::kY;
+  const int phase = (frac_y << constants::kMvPrecisionShift) + frac_x;
+  const int plane_y = band * kBandHeight;
+  const int height = std::min(kBandHeight, plane_height_ - plane_y);
+  const Sample *ref =
+    ref_pic_.GetSamplePtr(comp, -kMargin, plane_y - kMargin);
+  inter_pred->InterpolateLumaArea(plane_width_, height, frac_x, frac_y,
+                                  ref, ref_pic_.GetStride(comp),
+                                  &planes_[phase][plane_y * plane_width_],
+                                  plane_width_);
+}
+
+}   // namespace xvc
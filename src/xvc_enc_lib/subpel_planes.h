@@ -0,0 +1,67 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_SUBPEL_PLANES_H_
+#define XVC_ENC_LIB_SUBPEL_PLANES_H_
+
+#include <array>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/inter_prediction.h"
+#include "xvc_common_lib/yuv_pic.h"
+
+namespace xvc {
+
+// Luma sub-pel interpolations of a reference picture for motion search
+// Each fractional phase is stored as a full plane that is allocated when
+// first used and interpolated lazily one band of ctu rows at a time, so that
+// all pictures referencing the same picture can share the result
+class SubpelPlanes {
+public:
+  explicit SubpelPlanes(const YuvPicture &ref_pic);
+
+  const YuvPicture& GetRefPic() const { return ref_pic_; }
+  // Must be called when the samples of the reference picture have changed
+  void Invalidate();
+  // Returns interpolated samples of a luma block at fullpel position and
+  // fractional phase, or nullptr if the block is outside of the stored area
+  const Sample* GetBlock(int pos_x, int pos_y, int frac_x, int frac_y,
+                         int width, int height, InterPrediction *inter_pred,
+                         ptrdiff_t *stride);
+
+private:
+  // Covers the largest block displaced by a clipped motion vector
+  static const int kMargin = constants::kMaxBlockSize + 8;
+  static const int kBandHeight = constants::kMaxBlockSize;
+  static const int kNumPhases = 1 << (2 * constants::kMvPrecisionShift);
+
+  void InterpolateBand(int frac_x, int frac_y, int band,
+                       InterPrediction *inter_pred);
+
+  const YuvPicture &ref_pic_;
+  const int plane_width_;
+  const int plane_height_;
+  const int num_bands_;
+  std::array<std::vector<Sample>, kNumPhases> planes_;
+  std::array<std::vector<uint8_t>, kNumPhases> band_ready_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_SUBPEL_PLANES_H_
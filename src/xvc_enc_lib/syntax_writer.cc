@@ -636,6 +636,11 @@ void SyntaxWriter::WriteUnaryMaxSymbol(uint32_t symbol, uint32_t max_val,
   }
 }
 
+// Each context model is a single byte, so checkpointing the contexts of an
+// rdo branch by copying them costs less than tracking the modified ones
+static_assert(sizeof(CabacContexts) <= 4 * constants::kCacheLineSize,
+              "cabac contexts are copied for every rdo alternative");
+
 RdoSyntaxWriter::RdoSyntaxWriter(const SyntaxWriter &writer)
   : SyntaxWriter(writer.GetContexts(), &entropy_instance_),
   entropy_instance_(nullptr, writer.GetNumWrittenBits(),
@@ -81,6 +81,8 @@ protected:
   EntropyEncoder *entropyenc_;
 };
 
+// Syntax writer used for bit estimation in rdo, alternatives are evaluated
+// on a copy and the state of the best one is kept by assignment
 class RdoSyntaxWriter : public SyntaxWriter {
 public:
   explicit RdoSyntaxWriter(const SyntaxWriter &writer);
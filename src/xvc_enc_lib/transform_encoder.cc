@@ -55,25 +55,33 @@ TransformEncoder::TransformAndReconstruct(CodingUnit *cu, YuvComponent comp,
   auto orig_buffer = orig_pic.GetSampleBuffer(comp, cu_x, cu_y);
   temp_resi_orig_.Subtract(width, height, orig_buffer, temp_pred_);
 
-  // Transform
+  // Transform and quant is skipped if all coefficients are known to be zero
   const bool is_luma_intra = util::IsLuma(comp) && cu->IsIntra();
-  fwd_transform_.Transform(width, height, is_luma_intra,
-                           temp_resi_orig_.GetDataPtr(),
-                           temp_resi_orig_.GetStride(),
-                           temp_coeff_.GetDataPtr(), temp_coeff_.GetStride());
-
-  // Quant
-  int non_zero;
-  if (encoder_settings_.rdo_quant) {
-    non_zero =
-      fwd_quant_.QuantRdo(*cu, comp, qp, cu->GetPicType(), syntax_writer,
-                          temp_coeff_.GetDataPtr(), temp_coeff_.GetStride(),
-                          cu_coeff.GetDataPtr(), cu_coeff.GetStride());
+  const int64_t max_abs_coeff =
+    fwd_transform_.GetMaxCoeffBound(width, height,
+                                    temp_resi_orig_.SumAbs(width, height));
+  int non_zero = 0;
+  if (fwd_quant_.IsQuantizedToZero(comp, qp, width, height, max_abs_coeff)) {
+    cu_coeff.ZeroOut(width, height);
   } else {
-    non_zero =
-      fwd_quant_.QuantFast(*cu, comp, qp, cu->GetPicType(),
-                           temp_coeff_.GetDataPtr(), temp_coeff_.GetStride(),
-                           cu_coeff.GetDataPtr(), cu_coeff.GetStride());
+    // Transform
+    fwd_transform_.Transform(width, height, is_luma_intra,
+                             temp_resi_orig_.GetDataPtr(),
+                             temp_resi_orig_.GetStride(),
+                             temp_coeff_.GetDataPtr(), temp_coeff_.GetStride());
+
+    // Quant
+    if (encoder_settings_.rdo_quant) {
+      non_zero =
+        fwd_quant_.QuantRdo(*cu, comp, qp, cu->GetPicType(), syntax_writer,
+                            temp_coeff_.GetDataPtr(), temp_coeff_.GetStride(),
+                            cu_coeff.GetDataPtr(), cu_coeff.GetStride());
+    } else {
+      non_zero =
+        fwd_quant_.QuantFast(*cu, comp, qp, cu->GetPicType(),
+                             temp_coeff_.GetDataPtr(), temp_coeff_.GetStride(),
+                             cu_coeff.GetDataPtr(), cu_coeff.GetStride());
+    }
   }
   bool cbf = non_zero != 0;
   if (!cbf && Restrictions::Get().disable_transform_cbf) {
@@ -90,7 +98,12 @@ TransformEncoder::TransformAndReconstruct(CodingUnit *cu, YuvComponent comp,
                        temp_coeff_.GetDataPtr(), temp_coeff_.GetStride());
 
     // Inv transform
-    inv_transform_.Transform(width, height, is_luma_intra,
+    int extent_width, extent_height;
+    TransformHelper::DeriveCoeffExtent(width, height, cu_coeff.GetDataPtr(),
+                                       cu_coeff.GetStride(), &extent_width,
+                                       &extent_height);
+    inv_transform_.Transform(width, height, extent_width, extent_height,
+                             is_luma_intra,
                              temp_coeff_.GetDataPtr(), temp_coeff_.GetStride(),
                              temp_resi_.GetDataPtr(), temp_resi_.GetStride());
 
@@ -75,6 +75,9 @@ extern "C" {
     param->tune_mode = 0;
     param->simd_mask = static_cast<uint32_t>(-1);
     param->explicit_encoder_settings = nullptr;
+    param->parallel_segments = 0;
+    param->low_delay = 0;
+    param->intra_refresh_period = 0;
     return XVC_ENC_OK;
   }
 
@@ -158,6 +161,21 @@ extern "C" {
         param->tune_mode >= static_cast<int>(xvc::TuneMode::kTotalNumber)) {
       return XVC_ENC_INVALID_PARAMETER;
     }
+    if (param->parallel_segments != 0 &&
+        (param->closed_gop == 0 || param->max_keypic_distance == 0)) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
+    // Low delay can not be combined with anything that buffers input pictures
+    if (param->low_delay != 0 &&
+        (param->sub_gop_length > 1 || param->parallel_segments != 0)) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
+    // Intra refresh replaces the intra access pictures of closed gop chunks
+    if (param->intra_refresh_period < 0 ||
+        (param->intra_refresh_period > 0 &&
+        (param->num_ref_pics == 0 || param->parallel_segments != 0))) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
     return XVC_ENC_OK;
   }
 
@@ -225,10 +243,16 @@ extern "C" {
           stream >> encoder_settings.structural_ssd;
         } else if (setting == "encapsulation_mode") {
           stream >> encoder_settings.encapsulation_mode;
+        } else if (setting == "subpel_planes") {
+          stream >> encoder_settings.subpel_planes;
         }
       }
     }
 
+    if (param->intra_refresh_period > 0) {
+      encoder_settings.intra_refresh_period = param->intra_refresh_period;
+    }
+
     encoder->SetEncoderSettings(std::move(encoder_settings));
   }
 
@@ -295,11 +319,15 @@ extern "C" {
       static_cast<xvc::Checksum::Mode>(param->checksum_mode));
 
     int sub_gop_length = param->sub_gop_length;
-    if (sub_gop_length == 0) {
+    if (param->low_delay) {
+      // Only past pictures are referenced when there is no reordering
+      sub_gop_length = 1;
+    } else if (sub_gop_length == 0) {
       sub_gop_length = encoder->GetNumRefPics() > 0 ? 16 : 1;
     }
     encoder->SetSubGopLength(sub_gop_length);
     xvc_enc_set_segment_length(encoder, param, sub_gop_length);
+    encoder->SetParallelSegments(param->parallel_segments);
 
     return encoder;
   }
@@ -119,6 +119,15 @@ extern "C" {
     int checksum_mode;
     uint32_t simd_mask;
     char* explicit_encoder_settings;
+    // Number of closed gop segment chunks to encode concurrently (0 = off)
+    int parallel_segments;
+    // Encode without picture reordering so that each call to encoder_encode
+    // returns the nal unit of the same picture (0 = disabled)
+    int low_delay;
+    // Number of pictures for a column of intra coded ctus to sweep over the
+    // picture, combine with max_keypic_distance = 0 to replace periodic
+    // intra access pictures (0 = disabled)
+    int intra_refresh_period;
   } xvc_encoder_parameters;
 
   // xvc encoder api
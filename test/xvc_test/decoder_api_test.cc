@@ -16,12 +16,67 @@
 * The xvc License Agreement is available at https://xvc.io/license/.
 ******************************************************************************/
 
+#include <vector>
+
 #include "googletest/include/gtest/gtest.h"
 
+#include "xvc_dec_lib/decoder.h"
 #include "xvc_dec_lib/xvcdec.h"
+#include "xvc_enc_lib/xvcenc.h"
 
 namespace {
 
+std::vector<std::vector<uint8_t>> EncodeBitstream(int internal_bitdepth,
+                                                  int num_pics,
+                                                  int sub_gop_length = 1) {
+  const xvc_encoder_api *api = xvc_encoder_api_get();
+  xvc_encoder_parameters *params = api->parameters_create();
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->width = 16;
+  params->height = 16;
+  params->input_bitdepth = 8;
+  params->internal_bitdepth = internal_bitdepth;
+  if (sub_gop_length > 1) {
+    // Open gop segments of two sub gops
+    params->sub_gop_length = sub_gop_length;
+    params->max_keypic_distance = 2 * sub_gop_length;
+  } else {
+    params->low_delay = 1;
+  }
+  xvc_encoder *encoder = api->encoder_create(params);
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_destroy(params));
+  std::vector<std::vector<uint8_t>> nals;
+  if (!encoder) {
+    return nals;
+  }
+  std::vector<uint8_t> pic(16 * 16 * 3 / 2);
+  for (int poc = 0; poc < num_pics; poc++) {
+    for (size_t i = 0; i < pic.size(); i++) {
+      pic[i] = static_cast<uint8_t>(i * 7 + poc * 3);
+    }
+    xvc_enc_nal_unit *nal_units;
+    int num_nal_units;
+    EXPECT_EQ(XVC_ENC_OK, api->encoder_encode(encoder, &pic[0], &nal_units,
+                                              &num_nal_units, nullptr));
+    for (int i = 0; i < num_nal_units; i++) {
+      nals.emplace_back(nal_units[i].bytes,
+                        nal_units[i].bytes + nal_units[i].size);
+    }
+  }
+  xvc_enc_nal_unit *nal_units;
+  int num_nal_units;
+  do {
+    EXPECT_EQ(XVC_ENC_OK, api->encoder_flush(encoder, &nal_units,
+                                             &num_nal_units, nullptr));
+    for (int i = 0; i < num_nal_units; i++) {
+      nals.emplace_back(nal_units[i].bytes,
+                        nal_units[i].bytes + nal_units[i].size);
+    }
+  } while (num_nal_units > 0);
+  EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
+  return nals;
+}
+
 TEST(DecoderAPI, NullPtrCalls) {
   const xvc_decoder_api *api = xvc_decoder_api_get();
   EXPECT_EQ(XVC_DEC_OK, api->parameters_destroy(nullptr));
@@ -51,6 +106,29 @@ TEST(DecoderAPI, ParamCheck) {
   params->max_framerate = 92000;
   EXPECT_EQ(XVC_DEC_FRAMERATE_OUT_OF_RANGE, api->parameters_check(params));
 
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_set_default(params));
+  params->parallel_segments = 2;
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_check(params));
+  params->low_delay = 1;
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT, api->parameters_check(params));
+  params->low_delay = 0;
+  params->real_time = 1;
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT, api->parameters_check(params));
+  params->real_time = 0;
+  params->thread_priority = 1;
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT, api->parameters_check(params));
+  params->thread_priority = 0;
+  params->output_callback = [](void *opaque, const xvc_decoded_picture *pic) {
+  };
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT, api->parameters_check(params));
+  params->output_callback = nullptr;
+  xvc_decoder_thread_pool *thread_pool = api->thread_pool_create(1);
+  params->thread_pool = thread_pool;
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT, api->parameters_check(params));
+  EXPECT_EQ(nullptr, api->decoder_create(params));
+  params->thread_pool = nullptr;
+  EXPECT_EQ(XVC_DEC_OK, api->thread_pool_destroy(thread_pool));
+
   EXPECT_EQ(XVC_DEC_OK, api->parameters_set_default(params));
   EXPECT_EQ(XVC_DEC_OK, api->parameters_check(params));
   EXPECT_EQ(XVC_DEC_OK, api->parameters_destroy(params));
@@ -133,4 +211,169 @@ TEST(DecoderAPI, DecoderCheckConformance) {
   EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
 }
 
+TEST(DecoderAPI, DecodersSharingThreadPool) {
+  const int num_pics = 4;
+  const int num_decoders = 3;
+  std::vector<std::vector<uint8_t>> nals = EncodeBitstream(8, num_pics);
+  const xvc_decoder_api *api = xvc_decoder_api_get();
+  xvc_decoder_thread_pool *thread_pool = api->thread_pool_create(2);
+  ASSERT_NE(nullptr, thread_pool);
+  xvc_decoder_parameters *params = api->parameters_create();
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_set_default(params));
+  params->thread_pool = thread_pool;
+  std::vector<xvc_decoder*> decoders;
+  for (int i = 0; i < num_decoders; i++) {
+    params->thread_priority = i;
+    decoders.push_back(api->decoder_create(params));
+    ASSERT_NE(nullptr, decoders.back());
+  }
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_destroy(params));
+  for (auto &nal : nals) {
+    for (xvc_decoder *decoder : decoders) {
+      EXPECT_EQ(XVC_DEC_OK,
+                api->decoder_decode_nal(decoder, &nal[0], nal.size(), 0));
+    }
+  }
+  for (xvc_decoder *decoder : decoders) {
+    EXPECT_EQ(XVC_DEC_OK, api->decoder_flush(decoder));
+    xvc_decoded_picture decoded_pic;
+    int num_decoded_pics = 0;
+    while (api->decoder_get_picture(decoder, &decoded_pic) == XVC_DEC_OK) {
+      num_decoded_pics++;
+    }
+    EXPECT_EQ(num_pics, num_decoded_pics);
+    EXPECT_EQ(XVC_DEC_OK, api->decoder_check_conformance(decoder, nullptr));
+    EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
+  }
+  EXPECT_EQ(XVC_DEC_OK, api->thread_pool_destroy(thread_pool));
+}
+
+#if XVC_HIGH_BITDEPTH
+TEST(DecoderAPI, DecoderMixedBitdepthSegments) {
+  const int num_pics = 3;
+  std::vector<std::vector<uint8_t>> nals = EncodeBitstream(8, num_pics);
+  std::vector<std::vector<uint8_t>> nals_high = EncodeBitstream(10, num_pics);
+  nals.insert(nals.end(), nals_high.begin(), nals_high.end());
+
+  const xvc_decoder_api *api = xvc_decoder_api_get();
+  xvc_decoder_parameters *params = api->parameters_create();
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_set_default(params));
+  xvc_decoder *decoder = api->decoder_create(params);
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_destroy(params));
+  xvc_decoded_picture decoded_pic;
+  std::vector<int> bitdepths;
+  for (auto &nal : nals) {
+    EXPECT_EQ(XVC_DEC_OK,
+              api->decoder_decode_nal(decoder, &nal[0], nal.size(), 0));
+    while (api->decoder_get_picture(decoder, &decoded_pic) == XVC_DEC_OK) {
+      bitdepths.push_back(decoded_pic.stats.bitdepth);
+    }
+  }
+  EXPECT_EQ(XVC_DEC_OK, api->decoder_flush(decoder));
+  while (api->decoder_get_picture(decoder, &decoded_pic) == XVC_DEC_OK) {
+    bitdepths.push_back(decoded_pic.stats.bitdepth);
+  }
+  ASSERT_EQ(2 * num_pics, static_cast<int>(bitdepths.size()));
+  for (int i = 0; i < num_pics; i++) {
+    EXPECT_EQ(8, bitdepths[i]);
+    EXPECT_EQ(10, bitdepths[num_pics + i]);
+  }
+  EXPECT_EQ(XVC_DEC_OK, api->decoder_check_conformance(decoder, nullptr));
+  EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
+}
+
+TEST(DecoderAPI, DecoderMixedBitdepthOpenGopSegments) {
+  // Segments alternate between the two bitdepths, so that tail pictures of
+  // each segment reference an intra access picture of the other bitdepth
+  const int sub_gop_length = 4;
+  const int num_pics = sub_gop_length * 2 * 4 + 1;
+  std::vector<std::vector<uint8_t>> nals_bitdepth[2] = {
+    EncodeBitstream(8, num_pics, sub_gop_length),
+    EncodeBitstream(10, num_pics, sub_gop_length)
+  };
+  ASSERT_EQ(nals_bitdepth[0].size(), nals_bitdepth[1].size());
+  std::vector<std::vector<uint8_t>> nals;
+  int segment = -1;
+  for (size_t i = 0; i < nals_bitdepth[0].size(); i++) {
+    const int nal_unit_type = (nals_bitdepth[0][i][0] >> 1) & 31;
+    if (nal_unit_type ==
+        static_cast<int>(xvc::NalUnitType::kSegmentHeader)) {
+      segment++;
+    }
+    nals.push_back(nals_bitdepth[segment % 2][i]);
+  }
+  ASSERT_EQ(4, segment);
+
+  // Reference output of a single decoder with 16bit sample storage
+  std::vector<xvc_dec_pic_stats> expected_stats;
+  std::vector<std::vector<char>> expected_bytes;
+  xvc::Decoder ref_decoder(0);
+  ref_decoder.SetOutputBitdepth(10);
+  xvc_decoded_picture decoded_pic;
+  auto store_expected = [&]() {
+    while (ref_decoder.GetDecodedPicture(&decoded_pic)) {
+      expected_stats.push_back(decoded_pic.stats);
+      expected_bytes.emplace_back(decoded_pic.bytes,
+                                  decoded_pic.bytes + decoded_pic.size);
+    }
+  };
+  for (auto &nal : nals) {
+    ref_decoder.DecodeNal(&nal[0], nal.size());
+    store_expected();
+  }
+  ref_decoder.FlushBufferedNalUnits();
+  store_expected();
+  ASSERT_EQ(num_pics, static_cast<int>(expected_stats.size()));
+
+  // Without an output bitdepth each segment is output at its own bitdepth,
+  // which shows that 8bit segments are decoded with 8bit samples
+  const xvc_decoder_api *api = xvc_decoder_api_get();
+  for (int output_bitdepth : { 10, 0 }) {
+    for (int threads : { 0, 2 }) {
+      xvc_decoder_parameters *params = api->parameters_create();
+      EXPECT_EQ(XVC_DEC_OK, api->parameters_set_default(params));
+      params->output_bitdepth = output_bitdepth;
+      params->threads = threads;
+      xvc_decoder *decoder = api->decoder_create(params);
+      EXPECT_EQ(XVC_DEC_OK, api->parameters_destroy(params));
+      size_t num_decoded_pics = 0;
+      auto verify = [&]() {
+        while (api->decoder_get_picture(decoder, &decoded_pic) ==
+               XVC_DEC_OK) {
+          ASSERT_LT(num_decoded_pics, expected_stats.size());
+          const xvc_dec_pic_stats &expected = expected_stats[num_decoded_pics];
+          EXPECT_EQ(expected.poc, decoded_pic.stats.poc);
+          EXPECT_EQ(expected.doc, decoded_pic.stats.doc);
+          EXPECT_EQ(expected.soc, decoded_pic.stats.soc);
+          EXPECT_EQ(expected.tid, decoded_pic.stats.tid);
+          EXPECT_EQ(expected.bitstream_bitdepth,
+                    decoded_pic.stats.bitstream_bitdepth);
+          if (output_bitdepth == 0) {
+            EXPECT_EQ(decoded_pic.stats.bitstream_bitdepth,
+                      decoded_pic.stats.bitdepth);
+          }
+          if (decoded_pic.stats.bitdepth == 10) {
+            EXPECT_EQ(expected_bytes[num_decoded_pics],
+                      std::vector<char>(decoded_pic.bytes,
+                                        decoded_pic.bytes + decoded_pic.size))
+              << "Picture poc " << expected.poc;
+          }
+          num_decoded_pics++;
+        }
+      };
+      for (auto &nal : nals) {
+        EXPECT_EQ(XVC_DEC_OK,
+                  api->decoder_decode_nal(decoder, &nal[0], nal.size(), 0));
+        verify();
+      }
+      EXPECT_EQ(XVC_DEC_OK, api->decoder_flush(decoder));
+      verify();
+      EXPECT_EQ(expected_stats.size(), num_decoded_pics);
+      EXPECT_EQ(XVC_DEC_OK, api->decoder_check_conformance(decoder, nullptr));
+      EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
+    }
+  }
+}
+#endif
+
 }   // namespace
@@ -34,14 +34,18 @@ static const xvc::Sample kSample1 = 43;
 static const int kQp2 = 23;
 static const xvc::Sample kSample2 = 96;
 
-class DecoderResampleTest : public ::testing::TestWithParam<bool>,
+class DecoderResampleTest :
+  public ::testing::TestWithParam<::testing::tuple<bool, bool>>,
   public ::xvc_test::EncoderHelper, public ::xvc_test::DecoderHelper {
 protected:
   void SetUp() override {
     EncoderHelper::Init();
-    DecoderHelper::Init();
+    DecoderHelper::Init(UseThreads());
   }
 
+  bool ExplicitOutput() const { return ::testing::get<0>(GetParam()); }
+  bool UseThreads() const { return ::testing::get<1>(GetParam()); }
+
   void EncodeSegment(xvc::Sample orig_sample, int  qp, int resolution,
                      int bitdepth,
                      xvc::ChromaFormat chroma_fmt = xvc::ChromaFormat::k420) {
@@ -55,7 +59,7 @@ protected:
 
   void DecodeResolution(int size_dec) {
     ASSERT_EQ(4, encoded_nal_units_.size());
-    if (GetParam()) {
+    if (ExplicitOutput()) {
       decoder_->SetOutputWidth(size_dec);
       decoder_->SetOutputHeight(size_dec);
     }
@@ -77,7 +81,7 @@ protected:
 
   void DecodeChromaFormat(xvc_dec_chroma_format chroma_fmt_dec) {
     ASSERT_EQ(4, encoded_nal_units_.size());
-    if (GetParam()) {
+    if (ExplicitOutput()) {
       decoder_->SetOutputChromaFormat(chroma_fmt_dec);
     }
 
@@ -99,7 +103,7 @@ protected:
   void DecodeBitdepth(int size_dec, int bitdepth_enc1, int bitdepth_enc2,
                       int bitdepth_dec) {
     ASSERT_EQ(4, encoded_nal_units_.size());
-    if (GetParam()) {
+    if (ExplicitOutput()) {
       decoder_->SetOutputBitdepth(bitdepth_dec);
     }
 
@@ -218,6 +222,7 @@ TEST_P(DecoderResampleTest, BitdepthDownConversionHighToHigh) {
 #endif
 
 INSTANTIATE_TEST_CASE_P(ExplicitOutput, DecoderResampleTest,
-                        ::testing::Values(false, true));
+                        ::testing::Combine(::testing::Bool(),
+                                           ::testing::Bool()));
 
 }   // namespace
@@ -41,13 +41,15 @@ protected:
 
   std::vector<xvc_test::NalUnit> EncodeBitstream(int width, int height,
                                                  int internal_bitdepth,
-                                                 int frames) {
+                                                 int frames,
+                                                 double framerate = 30) {
     const int input_bitdepth = 8;
     encoded_nal_units_.clear();
     encoder_ = CreateEncoder(width, height, internal_bitdepth, qp);
     encoder_->SetSubGopLength(kSubGopLength);
     encoder_->SetSegmentLength(kSegmentLength);
     encoder_->SetClosedGopInterval(1000);   // force open gop
+    encoder_->SetFramerate(framerate);
     for (int i = 0; i < frames; i++) {
       auto orig_pic = xvc_test::TestYuvPic(width, height, input_bitdepth, i, i);
       EncodeOneFrame(orig_pic.GetBytes(), orig_pic.GetBitdepth());
@@ -55,22 +57,61 @@ protected:
     return encoded_nal_units_;
   }
 
-  int DecodeBitstream(int width, int height) {
+  // Decoding each picture takes decode_seconds of fake real-time, for the
+  // first slow_nals nal units if non-negative. The application spends
+  // app_seconds between nal units.
+  int DecodeBitstream(int width, int height, double decode_seconds = 0,
+                      int slow_nals = -1, double app_seconds = 0) {
     ResetBitstreamPosition();
     DecodeSegmentHeaderSuccess(GetNextNalToDecode());
     int decoded_pictures = 0;
+    int num_nals = 0;
+    fake_decode_seconds_ = decode_seconds;
     while (HasMoreNals()) {
+      if (slow_nals >= 0 && num_nals++ == slow_nals) {
+        fake_decode_seconds_ = 0;
+      }
       auto &nal = GetNextNalToDecode();
       EXPECT_TRUE(decoder_->DecodeNal(&nal[0], nal.size()));
       if (decoder_->GetDecodedPicture(&last_decoded_picture_)) {
         decoded_pictures++;
       }
+      fake_time_ += app_seconds;
     }
     while (DecoderFlushAndGet()) {
       decoded_pictures++;
     }
     return decoded_pictures;
   }
+
+  // Returns number of pictures output before flushing the decoder
+  int DecodeLowDelay(std::vector<xvc::PicNum> *output_pocs) {
+    decoder_->SetLowDelay(true);
+    int output_before_flush = 0;
+    for (auto &nal : encoded_nal_units_) {
+      EXPECT_TRUE(decoder_->DecodeNal(&nal[0], nal.size()));
+      while (decoder_->GetDecodedPicture(&last_decoded_picture_)) {
+        output_pocs->push_back(last_decoded_picture_.stats.poc);
+        output_before_flush++;
+      }
+    }
+    while (DecoderFlushAndGet()) {
+      output_pocs->push_back(last_decoded_picture_.stats.poc);
+    }
+    return output_before_flush;
+  }
+
+  void EnableRealTimeMode() {
+    fake_time_ = 0;
+    decoder_->SetRealTimeMode(true);
+    // The decoder reads the clock before and after decoding each picture
+    decoder_->SetRealTimeClock([this]() {
+      return fake_time_ += fake_decode_seconds_;
+    });
+  }
+
+  double fake_time_ = 0;
+  double fake_decode_seconds_ = 0;
 };
 
 TEST_F(DecoderScalabilityTest, ReferencePicDownscaling) {
@@ -97,4 +138,98 @@ TEST_F(DecoderScalabilityTest, ReferencePicDownscaling) {
   EXPECT_GT(decoder_->GetNumCorruptedPics(), 0);
 }
 
+TEST_F(DecoderScalabilityTest, RealTimeModeKeepsAllLayersWhenOnTime) {
+  const int frames = 1 + 2 * kSegmentLength;
+  const int framerate = 100;
+  EncodeBitstream(16, 16, 8, frames, framerate);
+  EnableRealTimeMode();
+  // Decoding takes half of the picture period
+  EXPECT_EQ(frames, DecodeBitstream(16, 16, 0.5 / framerate));
+  EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+}
+
+TEST_F(DecoderScalabilityTest, RealTimeModeIgnoresApplicationTime) {
+  const int frames = 1 + 2 * kSegmentLength;
+  const int framerate = 100;
+  EncodeBitstream(16, 16, 8, frames, framerate);
+  EnableRealTimeMode();
+  // Application paces its calls slower than the picture period
+  EXPECT_EQ(frames, DecodeBitstream(16, 16, 0, -1, 3.0 / framerate));
+  EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+}
+
+TEST_F(DecoderScalabilityTest, RealTimeModeDropsLayersWhenLate) {
+  const int frames = 1 + 2 * kSegmentLength;
+  const int framerate = 100;
+  EncodeBitstream(16, 16, 8, frames, framerate);
+  EnableRealTimeMode();
+  // Three times slower than real-time but fast enough for lowest layer
+  int decoded_pics = DecodeBitstream(16, 16, 1.5 / framerate);
+  EXPECT_EQ(13, decoded_pics);
+  EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+  EXPECT_LT(last_decoded_picture_.stats.framerate,
+            last_decoded_picture_.stats.bitstream_framerate);
+}
+
+TEST_F(DecoderScalabilityTest, RealTimeModeRestoresLayersWhenFast) {
+  const int frames = 1 + 4 * kSegmentLength;
+  const int framerate = 100;
+  EncodeBitstream(16, 16, 8, frames, framerate);
+  EnableRealTimeMode();
+  // Slow during the first segment, after that the application paces its
+  // calls to the picture period while decoding takes a fraction of it
+  int decoded_pics = DecodeBitstream(16, 16, 3.0 / framerate, kSegmentLength,
+                                     1.0 / framerate);
+  // Each layer is added back after a sub gop decoded at low load, so that
+  // pictures are only skipped in the first two segments
+  EXPECT_EQ(25, decoded_pics);
+  EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+}
+
+TEST_F(DecoderScalabilityTest, LowDelaySkipsDroppedTemporalLayers) {
+  const int frames = 1 + 3 * kSegmentLength;
+  const int framerate = 30;
+  EncodeBitstream(16, 16, 8, frames, framerate);
+  // Half of the bitstream framerate drops the highest temporal layer
+  decoder_->SetDecoderTicks(2 * xvc::constants::kTimeScale / framerate);
+  std::vector<xvc::PicNum> pocs;
+  EXPECT_EQ(1 + frames / 2, DecodeLowDelay(&pocs));
+  ASSERT_EQ(1 + frames / 2, static_cast<int>(pocs.size()));
+  for (int i = 0; i < static_cast<int>(pocs.size()); i++) {
+    EXPECT_EQ(2 * i, pocs[i]);
+  }
+  EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+}
+
+TEST_F(DecoderScalabilityTest, LowDelayRestartsAfterFlush) {
+  const int frames = 1 + 3 * kSegmentLength;
+  EncodeBitstream(16, 16, 8, frames);
+  std::vector<size_t> segment_headers;
+  for (size_t i = 0; i < encoded_nal_units_.size(); i++) {
+    if (((encoded_nal_units_[i][0] >> 1) & 31) ==
+        static_cast<int>(xvc::NalUnitType::kSegmentHeader)) {
+      segment_headers.push_back(i);
+    }
+  }
+  ASSERT_LE(3U, segment_headers.size());
+  // Decode the first segment, flush and continue with the third segment
+  // so that decoding restarts at a non-zero poc
+  std::vector<xvc_test::NalUnit> first_segment(
+    encoded_nal_units_.begin(), encoded_nal_units_.begin() + segment_headers[1]);
+  std::vector<xvc_test::NalUnit> third_segment(
+    encoded_nal_units_.begin() + segment_headers[2], encoded_nal_units_.end());
+  std::vector<xvc::PicNum> pocs;
+  encoded_nal_units_ = first_segment;
+  DecodeLowDelay(&pocs);
+  const int restart_poc = static_cast<int>(pocs.size());
+  encoded_nal_units_ = third_segment;
+  pocs.clear();
+  const int output_pics = DecodeLowDelay(&pocs);
+  ASSERT_LT(0, output_pics);
+  EXPECT_EQ(output_pics, static_cast<int>(pocs.size()));
+  for (int i = 0; i < static_cast<int>(pocs.size()); i++) {
+    EXPECT_EQ(restart_poc + i, pocs[i]);
+  }
+}
+
 }   // namespace
@@ -16,6 +16,8 @@
 * The xvc License Agreement is available at https://xvc.io/license/.
 ******************************************************************************/
 
+#include <algorithm>
+#include <iterator>
 #include <list>
 #include <vector>
 
@@ -79,6 +81,19 @@ protected:
     }
   }
 
+  void DecodeEachPictureDirectly(int frames) {
+    DecodeSegmentHeaderSuccess(GetNextNalToDecode());
+    encoded_pocs_.pop_front();
+    for (int i = 0; i < frames; i++) {
+      int64_t user_data = kPocOffset + encoded_pocs_.front();
+      encoded_pocs_.pop_front();
+      ASSERT_TRUE(DecodePictureSuccess(GetNextNalToDecode(), user_data));
+      EXPECT_EQ(i, last_decoded_picture_.stats.poc);
+      VerifyPicture(16, 16, last_decoded_picture_);
+    }
+    EXPECT_FALSE(DecoderFlushAndGet());
+  }
+
   void VerifyPicture(int width, int height,
                      const xvc_decoded_picture &decoded_picture) {
     int poc = decoded_picture.stats.poc;
@@ -100,9 +115,73 @@ protected:
     verified_[poc] = true;
   }
 
+  void DecodeParallelSegments(int parallel_segments, int num_frames,
+                              bool one_output_per_nal = false) {
+    std::vector<xvc_dec_pic_stats> expected_stats;
+    std::vector<std::vector<char>> expected_bytes;
+    for (auto &nal : encoded_nal_units_) {
+      decoder_->DecodeNal(&nal[0], nal.size());
+      while (decoder_->GetDecodedPicture(&last_decoded_picture_)) {
+        expected_stats.push_back(last_decoded_picture_.stats);
+        expected_bytes.push_back(std::vector<char>(
+          last_decoded_picture_.bytes,
+          last_decoded_picture_.bytes + last_decoded_picture_.size));
+      }
+    }
+    while (DecoderFlushAndGet()) {
+      expected_stats.push_back(last_decoded_picture_.stats);
+      expected_bytes.push_back(std::vector<char>(
+        last_decoded_picture_.bytes,
+        last_decoded_picture_.bytes + last_decoded_picture_.size));
+    }
+    ASSERT_EQ(num_frames, static_cast<int>(expected_stats.size()));
+
+    DecoderHelper::Init();
+    decoder_->SetParallelSegments(parallel_segments);
+    size_t num_pics = 0;
+    auto verify = [&]() {
+      ASSERT_LT(num_pics, expected_stats.size());
+      const xvc_dec_pic_stats &expected = expected_stats[num_pics];
+      const xvc_dec_pic_stats &actual = last_decoded_picture_.stats;
+      EXPECT_EQ(expected.poc, actual.poc);
+      EXPECT_EQ(expected.doc, actual.doc);
+      EXPECT_EQ(expected.soc, actual.soc);
+      EXPECT_EQ(expected.tid, actual.tid);
+      EXPECT_EQ(expected.l0[0], actual.l0[0]);
+      EXPECT_EQ(expected.l1[0], actual.l1[0]);
+      EXPECT_EQ(1, actual.conforming);
+      EXPECT_EQ(expected_bytes[num_pics],
+                std::vector<char>(last_decoded_picture_.bytes,
+                                  last_decoded_picture_.bytes +
+                                  last_decoded_picture_.size));
+      num_pics++;
+    };
+    for (auto &nal : encoded_nal_units_) {
+      decoder_->DecodeNal(&nal[0], nal.size());
+      while (decoder_->GetDecodedPicture(&last_decoded_picture_)) {
+        verify();
+        if (one_output_per_nal) {
+          break;
+        }
+      }
+    }
+    while (DecoderFlushAndGet()) {
+      verify();
+    }
+    EXPECT_EQ(expected_stats.size(), num_pics);
+    EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+  }
+
+  static void OnOutputPicture(void *opaque, const xvc_decoded_picture *pic) {
+    EncodeDecodeTest *test = reinterpret_cast<EncodeDecodeTest*>(opaque);
+    test->VerifyPicture(pic->stats.width, pic->stats.height, *pic);
+    test->output_pocs_.push_back(pic->stats.poc);
+  }
+
   std::vector<xvc_test::TestYuvPic> orig_pics_;
   std::vector<bool> verified_;
   std::list<int> encoded_pocs_;
+  std::vector<int> output_pocs_;
 };
 
 TEST_P(EncodeDecodeTest, TwoSubGopZeroResolution) {
@@ -121,6 +200,287 @@ TEST_P(EncodeDecodeTest, SingleSegment16x16) {
   Decode(16, 16, 1, true);
 }
 
+TEST_P(EncodeDecodeTest, ParallelSegmentsMatchSequentialDecode) {
+  const int segment_length = kFramesEncoded / 2;
+  encoder_->SetSubGopLength(kFramesEncoded / 4);
+  encoder_->SetSegmentLength(segment_length);
+  encoder_->SetClosedGopInterval(segment_length);
+  Encode(16, 16, segment_length * 4 + 1);
+  std::fill(verified_.begin(), verified_.end(), true);
+  DecodeParallelSegments(3, segment_length * 4 + 1);
+}
+
+TEST_P(EncodeDecodeTest, ParallelSegmentsMoreChunksThanInFlight) {
+  // Single worker allows two chunks in flight, decoding of nals is blocked
+  // until the oldest chunk has output available
+  const int segment_length = kFramesEncoded / 2;
+  encoder_->SetSubGopLength(kFramesEncoded / 4);
+  encoder_->SetSegmentLength(segment_length);
+  encoder_->SetClosedGopInterval(segment_length);
+  Encode(16, 16, segment_length * 8 + 1);
+  std::fill(verified_.begin(), verified_.end(), true);
+  DecodeParallelSegments(1, segment_length * 8 + 1);
+}
+
+TEST_P(EncodeDecodeTest, ParallelSegmentsStreamOutputOfLongChunks) {
+  // Chunks have more pictures than are kept as output per chunk, output is
+  // taken like a player does, one picture per decoded nal
+  const int segment_length = kFramesEncoded * 2;
+  encoder_->SetSubGopLength(kFramesEncoded / 4);
+  encoder_->SetSegmentLength(segment_length);
+  encoder_->SetClosedGopInterval(segment_length);
+  Encode(16, 16, segment_length * 4 + 1);
+  std::fill(verified_.begin(), verified_.end(), true);
+  DecodeParallelSegments(1, segment_length * 4 + 1, true);
+  DecoderHelper::Init();
+  DecodeParallelSegments(2, segment_length * 4 + 1, true);
+}
+
+TEST_P(EncodeDecodeTest, ParallelSegmentsMatchSequentialEncode) {
+  const int segment_length = kFramesEncoded / 2;
+  const int num_frames = segment_length * 4 + 1;
+  // Sequential, parallel and a single worker with more chunks than in flight
+  const int kParallelSegments[] = { 0, 3, 1 };
+  const int kNumRuns = sizeof(kParallelSegments) / sizeof(kParallelSegments[0]);
+  std::vector<xvc_enc_nal_stats> stats[kNumRuns];
+  std::vector<xvc_test::NalUnit> nals[kNumRuns];
+  std::vector<std::vector<uint8_t>> recs[kNumRuns];
+  for (int parallel = 0; parallel < kNumRuns; parallel++) {
+    auto encoder = CreateEncoder(16, 16, GetParam(), kQp);
+    encoder->SetSubGopLength(kFramesEncoded / 4);
+    encoder->SetSegmentLength(segment_length);
+    encoder->SetClosedGopInterval(segment_length);
+    encoder->SetInputBitdepth(GetParam());
+    encoder->SetParallelSegments(kParallelSegments[parallel]);
+    xvc_enc_nal_unit *nal_units = nullptr;
+    xvc_enc_pic_buffer rec = { nullptr, 0 };
+    auto store = [&](int num_nals) {
+      for (int i = 0; i < num_nals; i++) {
+        stats[parallel].push_back(nal_units[i].stats);
+        nals[parallel].push_back(
+          xvc_test::NalUnit(nal_units[i].bytes,
+                            nal_units[i].bytes + nal_units[i].size));
+      }
+      if (rec.size > 0) {
+        recs[parallel].push_back(
+          std::vector<uint8_t>(rec.pic, rec.pic + rec.size));
+      }
+    };
+    for (int i = 0; i < num_frames; i++) {
+      auto orig_pic = xvc_test::TestYuvPic(16, 16, GetParam(), i, i);
+      store(encoder->Encode(&orig_pic.GetBytes()[0], &nal_units, true, &rec));
+    }
+    int num_nals;
+    do {
+      num_nals = encoder->Flush(&nal_units, true, &rec);
+      store(num_nals);
+    } while (num_nals > 0 || rec.size > 0);
+  }
+  std::fill(verified_.begin(), verified_.end(), true);
+
+  for (int run = 1; run < kNumRuns; run++) {
+    ASSERT_EQ(nals[0].size(), nals[run].size());
+    for (size_t i = 0; i < nals[0].size(); i++) {
+      EXPECT_EQ(nals[0][i], nals[run][i]) << "Nal unit " << i;
+      const xvc_enc_nal_stats &expected = stats[0][i];
+      const xvc_enc_nal_stats &actual = stats[run][i];
+      EXPECT_EQ(expected.nal_unit_type, actual.nal_unit_type);
+      if (expected.nal_unit_type ==
+          static_cast<uint32_t>(xvc::NalUnitType::kSegmentHeader)) {
+        continue;
+      }
+      EXPECT_EQ(expected.poc, actual.poc);
+      EXPECT_EQ(expected.doc, actual.doc);
+      EXPECT_EQ(expected.soc, actual.soc);
+      EXPECT_EQ(expected.tid, actual.tid);
+      EXPECT_EQ(expected.l0[0], actual.l0[0]);
+      EXPECT_EQ(expected.l1[0], actual.l1[0]);
+    }
+    ASSERT_EQ(static_cast<size_t>(num_frames), recs[0].size());
+    EXPECT_EQ(recs[0], recs[run]);
+  }
+}
+
+TEST_P(EncodeDecodeTest, SubpelPlanesMatchDirectInterpolation) {
+  const int width = 72;
+  const int height = 40;
+  const int num_frames = kFramesEncoded + 1;
+  std::vector<xvc_test::NalUnit> nals[2];
+  for (int subpel_planes = 0; subpel_planes < 2; subpel_planes++) {
+    auto encoder = CreateEncoder(width, height, GetParam(), kQp);
+    xvc::EncoderSettings encoder_settings = encoder->GetEncoderSettings();
+    encoder_settings.subpel_planes = subpel_planes;
+    encoder->SetEncoderSettings(encoder_settings);
+    encoder->SetSubGopLength(kFramesEncoded);
+    encoder->SetInputBitdepth(GetParam());
+    xvc_enc_nal_unit *nal_units = nullptr;
+    auto store = [&](int num_nals) {
+      for (int i = 0; i < num_nals; i++) {
+        nals[subpel_planes].push_back(
+          xvc_test::NalUnit(nal_units[i].bytes,
+                            nal_units[i].bytes + nal_units[i].size));
+      }
+    };
+    for (int i = 0; i < num_frames; i++) {
+      auto orig_pic = xvc_test::TestYuvPic(width, height, GetParam(), i, 2 * i);
+      store(encoder->Encode(&orig_pic.GetBytes()[0], &nal_units, false,
+                            nullptr));
+    }
+    int num_nals;
+    do {
+      num_nals = encoder->Flush(&nal_units, false, nullptr);
+      store(num_nals);
+    } while (num_nals > 0);
+  }
+  ASSERT_EQ(nals[0].size(), nals[1].size());
+  for (size_t i = 0; i < nals[0].size(); i++) {
+    EXPECT_EQ(nals[0][i], nals[1][i]) << "Nal unit " << i;
+  }
+}
+
+TEST_P(EncodeDecodeTest, LowDelayOutputsPictureDirectly) {
+  encoder_->SetSubGopLength(1);
+  Encode(16, 16, kFramesEncoded);
+  decoder_->SetLowDelay(true);
+  DecodeEachPictureDirectly(kFramesEncoded);
+}
+
+TEST_P(EncodeDecodeTest, NoReorderingStreamOutputsPictureDirectly) {
+  // Low delay output is implied by a stream without picture reordering
+  encoder_->SetSubGopLength(1);
+  Encode(16, 16, kFramesEncoded);
+  DecodeEachPictureDirectly(kFramesEncoded);
+}
+
+TEST_P(EncodeDecodeTest, IntraRefreshWithoutIntraAccessPictures) {
+  // Refresh column sweeps over both ctu columns in a single segment
+  xvc::EncoderSettings encoder_settings = encoder_->GetEncoderSettings();
+  encoder_settings.intra_refresh_period = 2;
+  encoder_->SetEncoderSettings(encoder_settings);
+  encoder_->SetSegmentLength(kFramesEncoded * 4);
+  Encode(72, 16, kFramesEncoded * 2 + 1);
+  Decode(72, 16, kFramesEncoded * 2 + 1);
+}
+
+TEST_P(EncodeDecodeTest, IntraRefreshRecoversWhenStartedMidStream) {
+  // A decoder that starts at a refresh cycle only has garbage references,
+  // emulated by splicing the start of a stream with different content
+  const int width = 136;
+  const int height = 16;
+  const int refresh_period = 3;
+  const int num_frames = refresh_period * 4 + 1;
+  std::vector<xvc_test::NalUnit> nals[2];
+  std::vector<uint32_t> nal_types;
+  for (int run = 0; run < 2; run++) {
+    auto encoder = CreateEncoder(width, height, GetParam(), kQp);
+    xvc::EncoderSettings encoder_settings = encoder->GetEncoderSettings();
+    encoder_settings.intra_refresh_period = refresh_period;
+    encoder->SetEncoderSettings(encoder_settings);
+    encoder->SetSubGopLength(1);
+    encoder->SetSegmentLength(num_frames * 2);
+    encoder->SetInputBitdepth(GetParam());
+    xvc_enc_nal_unit *nal_units = nullptr;
+    auto store = [&](int num_nals) {
+      for (int i = 0; i < num_nals; i++) {
+        nals[run].push_back(
+          xvc_test::NalUnit(nal_units[i].bytes,
+                            nal_units[i].bytes + nal_units[i].size));
+        if (run == 0) {
+          nal_types.push_back(nal_units[i].stats.nal_unit_type);
+        }
+      }
+    };
+    for (int i = 0; i < num_frames; i++) {
+      auto orig_pic = run == 0 ?
+        xvc_test::TestYuvPic(width, height, GetParam(), i / 4, 1) :
+        xvc_test::TestYuvPic(width, height, GetParam(), 7, 11);
+      store(encoder->Encode(&orig_pic.GetBytes()[0], &nal_units, false,
+                            nullptr));
+    }
+    int num_nals;
+    do {
+      num_nals = encoder->Flush(&nal_units, false, nullptr);
+      store(num_nals);
+    } while (num_nals > 0);
+  }
+  ASSERT_EQ(nals[0].size(), nals[1].size());
+
+  // The second refresh cycle starts after the first access picture
+  auto is_access_picture = [](uint32_t nal_type) {
+    return nal_type ==
+      static_cast<uint32_t>(xvc::NalUnitType::kPredictedAccessPicture) ||
+      nal_type ==
+      static_cast<uint32_t>(xvc::NalUnitType::kBipredictedAccessPicture);
+  };
+  auto first_access = std::find_if(nal_types.begin(), nal_types.end(),
+                                   is_access_picture);
+  ASSERT_NE(nal_types.end(), first_access);
+  const size_t splice_idx = first_access - nal_types.begin() + 1;
+  auto next_access = std::find_if(first_access + 1, nal_types.end(),
+                                  is_access_picture);
+  ASSERT_NE(nal_types.end(), next_access);
+  // Nal index zero is the segment header, pictures follow in poc order
+  const int splice_poc = static_cast<int>(splice_idx) - 1;
+  const int recovered_poc =
+    static_cast<int>(next_access - nal_types.begin()) - 1;
+
+  std::vector<xvc_test::NalUnit> spliced(nals[1].begin(),
+                                         nals[1].begin() + splice_idx);
+  spliced.insert(spliced.end(), nals[0].begin() + splice_idx, nals[0].end());
+  std::vector<std::vector<char>> decoded[2];
+  std::vector<int> conforming[2];
+  const std::vector<xvc_test::NalUnit> *streams[2] = { &nals[0], &spliced };
+  for (int run = 0; run < 2; run++) {
+    DecoderHelper::Init();
+    auto store = [&]() {
+      decoded[run].push_back(std::vector<char>(
+        last_decoded_picture_.bytes,
+        last_decoded_picture_.bytes + last_decoded_picture_.size));
+      conforming[run].push_back(last_decoded_picture_.stats.conforming);
+    };
+    for (auto &nal : *streams[run]) {
+      decoder_->DecodeNal(&nal[0], nal.size());
+      while (decoder_->GetDecodedPicture(&last_decoded_picture_)) {
+        store();
+      }
+    }
+    while (DecoderFlushAndGet()) {
+      store();
+    }
+    ASSERT_EQ(num_frames, static_cast<int>(decoded[run].size()));
+  }
+  std::fill(verified_.begin(), verified_.end(), true);
+
+  // Garbage references must be visible before the refresh completes
+  bool any_diff = false;
+  for (int poc = splice_poc; poc < recovered_poc; poc++) {
+    any_diff |= decoded[0][poc] != decoded[1][poc];
+  }
+  EXPECT_TRUE(any_diff);
+  for (int poc = recovered_poc; poc < num_frames; poc++) {
+    EXPECT_EQ(decoded[0][poc], decoded[1][poc]) << "Picture poc " << poc;
+    EXPECT_EQ(1, conforming[1][poc]) << "Picture poc " << poc;
+  }
+}
+
+TEST_P(EncodeDecodeTest, OutputCallbackDeliversPicturesInPocOrder) {
+  Encode(16, 16, kFramesEncoded * 2 + 1);
+  DecoderHelper::Init(true);
+  decoder_->SetLowDelay(true);
+  decoder_->SetOutputCallback(&EncodeDecodeTest::OnOutputPicture, this);
+  for (size_t i = 0; i < encoded_pocs_.size(); i++) {
+    auto &nal = GetNextNalToDecode();
+    int64_t user_data = kPocOffset + *std::next(encoded_pocs_.begin(), i);
+    EXPECT_TRUE(decoder_->DecodeNal(&nal[0], nal.size(), user_data));
+  }
+  decoder_->FlushBufferedNalUnits();
+  ASSERT_EQ(kFramesEncoded * 2 + 1, output_pocs_.size());
+  for (int poc = 0; poc < static_cast<int>(output_pocs_.size()); poc++) {
+    EXPECT_EQ(poc, output_pocs_[poc]);
+  }
+  EXPECT_FALSE(decoder_->GetDecodedPicture(&last_decoded_picture_));
+}
+
 INSTANTIATE_TEST_CASE_P(NormalBitdepth, EncodeDecodeTest,
                         ::testing::Values(8));
 #if XVC_HIGH_BITDEPTH
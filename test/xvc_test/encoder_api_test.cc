@@ -16,6 +16,8 @@
 * The xvc License Agreement is available at https://xvc.io/license/.
 ******************************************************************************/
 
+#include <vector>
+
 #include "googletest/include/gtest/gtest.h"
 
 #include "xvc_common_lib/common.h"
@@ -162,6 +164,21 @@ TEST(EncoderAPI, ParamCheck) {
   params->checksum_mode = static_cast<int>(xvc::Checksum::Mode::kTotalNumber);
   EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
 
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->low_delay = 1;
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
+  params->sub_gop_length = 4;
+  EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
+
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->intra_refresh_period = 8;
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
+  params->num_ref_pics = 0;
+  EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
+  params->num_ref_pics = 2;
+  params->intra_refresh_period = -1;
+  EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
+
   EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
   EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
   EXPECT_EQ(XVC_ENC_OK, api->parameters_destroy(params));
@@ -216,6 +233,32 @@ TEST(EncoderAPI, EncoderEncode) {
   EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
 }
 
+TEST(EncoderAPI, EncoderLowDelay) {
+  const xvc_encoder_api *api = xvc_encoder_api_get();
+  xvc_encoder_parameters *params = api->parameters_create();
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->width = 16;
+  params->height = 16;
+  params->input_bitdepth = 8;
+  params->low_delay = 1;
+  xvc_encoder *encoder = api->encoder_create(params);
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_destroy(params));
+  ASSERT_NE(encoder, nullptr);
+  std::vector<uint8_t> pic(16 * 16 * 3 / 2, 128);
+  for (uint32_t poc = 0; poc < 4; poc++) {
+    xvc_enc_nal_unit *nal_units;
+    int num_nal_units;
+    xvc_enc_pic_buffer rec_pic = { 0 };
+    EXPECT_EQ(XVC_ENC_OK, api->encoder_encode(encoder, &pic[0], &nal_units,
+                                              &num_nal_units, &rec_pic));
+    // Each picture is output directly by the call that encodes it
+    ASSERT_GE(num_nal_units, 1);
+    EXPECT_EQ(poc, nal_units[num_nal_units - 1].stats.poc);
+    EXPECT_NE(nullptr, rec_pic.pic);
+  }
+  EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
+}
+
 TEST(EncoderAPI, EncoderFlush) {
   const xvc_encoder_api *api = xvc_encoder_api_get();
 
@@ -16,8 +16,10 @@
 * The xvc License Agreement is available at https://xvc.io/license/.
 ******************************************************************************/
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdlib>
 #include <memory>
 
 #include "googletest/include/gtest/gtest.h"
@@ -26,6 +28,7 @@
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/restrictions.h"
+#include "xvc_common_lib/transform.h"
 #include "xvc_dec_lib/syntax_reader.h"
 #include "xvc_enc_lib/bit_writer.h"
 #include "xvc_enc_lib/syntax_writer.h"
@@ -65,7 +68,8 @@ protected:
     xvc::SyntaxReader reader(*qp_.get(), pic_type, &entropydec);
     dec_coeff.fill(0);  // caller responsiblility
     entropydec.Start();
-    reader.ReadCoefficients(*cu, comp, &dec_coeff[0], coeff_stride);
+    reader.ReadCoefficients(*cu, comp, &dec_coeff[0], coeff_stride,
+                            &dec_extent_width, &dec_extent_height);
     ASSERT_EQ(1, entropydec.DecodeBinTrm());
     entropydec.Finish();
     pic_data.ReleaseCu(cu);
@@ -79,9 +83,15 @@ protected:
     Decode(bitstream);
     xvc::Coeff *enc = &enc_coeff[0];
     xvc::Coeff *dec = &dec_coeff[0];
+    int extent_width = 0;
+    int extent_height = 0;
     for (int y = 0; y < height_; y++) {
       for (int x = 0; x < width_; x++) {
         ASSERT_EQ(enc[x], dec[x]) << "at y=" << y << " x=" << x;
+        if (enc[x] != 0) {
+          extent_width = std::max(extent_width, x + 1);
+          extent_height = std::max(extent_height, y + 1);
+        }
       }
       for (int x = width_; x < coeff_stride; x++) {
         ASSERT_EQ(0, dec[x]) << "padding at y=" << y << " x=" << x;
@@ -89,6 +99,33 @@ protected:
       enc += coeff_stride;
       dec += coeff_stride;
     }
+    EXPECT_EQ(extent_width, dec_extent_width);
+    EXPECT_EQ(extent_height, dec_extent_height);
+    int derived_width, derived_height;
+    xvc::TransformHelper::DeriveCoeffExtent(width_, height_, &enc_coeff[0],
+                                            coeff_stride, &derived_width,
+                                            &derived_height);
+    EXPECT_EQ(extent_width, derived_width);
+    EXPECT_EQ(extent_height, derived_height);
+    VerifyInverseTransformExtent(extent_width, extent_height);
+  }
+
+  void VerifyInverseTransformExtent(int extent_width, int extent_height) {
+    std::array<xvc::Residual, coeff_stride * kMaxHeight> full_resi;
+    std::array<xvc::Residual, coeff_stride * kMaxHeight> sparse_resi;
+    xvc::InverseTransform inv_transform(bitdepth);
+    inv_transform.Transform(width_, height_, false, &enc_coeff[0],
+                            coeff_stride, &full_resi[0], coeff_stride);
+    inv_transform.Transform(width_, height_, extent_width, extent_height,
+                            false, &enc_coeff[0], coeff_stride,
+                            &sparse_resi[0], coeff_stride);
+    for (int y = 0; y < height_; y++) {
+      for (int x = 0; x < width_; x++) {
+        ASSERT_EQ(full_resi[y * coeff_stride + x],
+                  sparse_resi[y * coeff_stride + x])
+          << "at y=" << y << " x=" << x;
+      }
+    }
   }
 
   constexpr static int kMaxWidth = 16;
@@ -103,6 +140,8 @@ protected:
   std::array<xvc::Coeff, coeff_stride * kMaxHeight> enc_coeff;
   std::array<xvc::Coeff, coeff_stride * kMaxHeight> dec_coeff;
   std::unique_ptr<xvc::Qp> qp_;
+  int dec_extent_width = 0;
+  int dec_extent_height = 0;
   int width_ = kMaxWidth;
   int height_ = kMaxHeight;
 };
@@ -150,7 +189,51 @@ TEST_F(ResidualCoding, AllZero) {
   EncodeDecodeVerify();
 }
 
+TEST_F(ResidualCoding, ForwardTransformCoeffBound) {
+  const int kSize = 64;
+  std::array<xvc::Residual, kSize * kSize> resi;
+  std::array<xvc::Coeff, kSize * kSize> coeff;
+  xvc::ForwardTransform fwd_transform(bitdepth);
+  for (int width = 2; width <= kSize; width *= 2) {
+    for (int height = 2; height <= kSize; height *= 2) {
+      for (int pattern = 0; pattern < 4; pattern++) {
+        int64_t sum_abs = 0;
+        for (int y = 0; y < height; y++) {
+          for (int x = 0; x < width; x++) {
+            int val = 0;
+            if (pattern == 0) {
+              val = (x == 0 && y == 0) ? 1 : 0;
+            } else if (pattern == 1) {
+              val = (x == width - 1 && y == height / 2) ? -3 : 0;
+            } else if (pattern == 2) {
+              val = ((x + y) % 2) ? 2 : -2;
+            } else {
+              val = ((x * 7 + y * 13) % 5) - 2;
+            }
+            resi[y * kSize + x] = static_cast<xvc::Residual>(val);
+            sum_abs += std::abs(val);
+          }
+        }
+        const int64_t bound =
+          fwd_transform.GetMaxCoeffBound(width, height, sum_abs);
+        for (int intra = 0; intra < 2; intra++) {
+          coeff.fill(0);
+          fwd_transform.Transform(width, height, intra != 0, &resi[0], kSize,
+                                  &coeff[0], kSize);
+          for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+              ASSERT_LE(std::abs(coeff[y * kSize + x]), bound)
+                << width << "x" << height << " pattern=" << pattern
+                << " at y=" << y << " x=" << x;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(CoeffValues, ResidualCoding,
-                        ::testing::Values(1, 2, 3, 255));
+                        ::testing::Values(1, 2, 3, 255, 4095));
 
 }   // namespace
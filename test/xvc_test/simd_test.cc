@@ -118,6 +118,19 @@ TEST_P(SimdTest, VerifyDecodeWithWithout) {
   AssertPicturesEqual(dec_plain, dec_simd);
 }
 
+TEST_P(SimdTest, VerifyEncodeWithWithout) {
+  Encode(kWidth, kHeight, kSubGopLength + 1, false);
+  std::vector<xvc_test::NalUnit> nals_plain;
+  nals_plain.swap(encoded_nal_units_);
+  orig_pics_.clear();
+  verified_.clear();
+  Encode(kWidth, kHeight, kSubGopLength + 1, true);
+  ASSERT_EQ(nals_plain.size(), encoded_nal_units_.size());
+  for (int i = 0; i < static_cast<int>(nals_plain.size()); i++) {
+    ASSERT_TRUE(nals_plain[i] == encoded_nal_units_[i]) << "for nal " << i;
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(NormalBitdepth, SimdTest,
                         ::testing::Values(8));
 #if XVC_HIGH_BITDEPTH